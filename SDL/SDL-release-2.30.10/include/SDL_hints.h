@@ -421,6 +421,20 @@ extern "C" {
  */
 #define SDL_HINT_EVENT_LOGGING   "SDL_EVENT_LOGGING"
 
+/**
+ *  \brief  A variable controlling whether a lock-free ring is used for events pushed from another thread.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - All events go through the mutex-protected event queue (default)
+ *    "1"       - The first thread other than the one that initialized events to push an
+ *                event gets a fixed-size single producer, single consumer ring. Its events
+ *                skip the event queue lock until they are moved onto the queue by the
+ *                thread reading events. Other threads use the regular queue.
+ *
+ *  This hint must be set before the events subsystem is initialized.
+ */
+#define SDL_HINT_EVENT_QUEUE_SPSC   "SDL_EVENT_QUEUE_SPSC"
+
 /**
  *  \brief  A variable controlling whether raising the window should be done more forcefully
  *
@@ -1700,6 +1714,39 @@ extern "C" {
  */
 #define SDL_HINT_RENDER_VSYNC               "SDL_RENDER_VSYNC"
 
+/**
+ *  \brief  A variable controlling how many threads the software renderer rasterizes with.
+ *
+ *  This variable can be set to the following values:
+ *    "0" or "1" - Render on the calling thread only (default)
+ *    "N"        - Split the target into horizontal tiles and fill them on N threads,
+ *                 including the calling thread
+ *
+ *  Clears, rectangle fills and point draws are binned into tiles and run in parallel.
+ *  Other commands run on the calling thread in queue order, so the output is identical
+ *  to single-threaded rendering.
+ *
+ *  This hint must be set before the software renderer is created.
+ */
+#define SDL_HINT_RENDER_SW_THREADS          "SDL_RENDER_SW_THREADS"
+
+/**
+ *  \brief  A variable selecting the kernel SDL_FillRect() and SDL_FillRects() use on 32-bit surfaces.
+ *
+ *  This variable can be set to the following values:
+ *    "scalar"  - Plain C stores
+ *    "sse"     - SSE, non-temporal stores for every row of 64 bytes or more
+ *    "avx2"    - AVX2, non-temporal stores only for fills of 256 KiB or more
+ *    "avx512"  - AVX-512F, like AVX2 with masked stores for the row edges
+ *
+ *  By default the widest kernel the CPU supports is used. A kernel the CPU or the build
+ *  does not support falls back to the default. Meant for testing and benchmarking.
+ *
+ *  This hint is checked on every fill, it is a local addition to the vendored
+ *  SDL 2.30.10 and not part of upstream SDL.
+ */
+#define SDL_HINT_FILLRECT_KERNEL            "SDL_FILLRECT_KERNEL"
+
 /**
  *  \brief  A variable controlling whether the Metal render driver select low power device over default one
  *
@@ -1974,6 +2021,21 @@ extern "C" {
  */
 #define SDL_HINT_VIDEO_MINIMIZE_ON_FOCUS_LOSS   "SDL_VIDEO_MINIMIZE_ON_FOCUS_LOSS"
 
+/**
+ *  \brief  A variable controlling whether the offscreen video driver double buffers window framebuffers.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Frames are drawn into a single buffer (default)
+ *    "1"       - Each present swaps two buffers, so the presented frame can be read
+ *                with SDL_LockPresentedFrame() while the next one renders
+ *
+ *  With double buffering the window surface points at a different buffer after each
+ *  present, and its previous contents are not kept.
+ *
+ *  This hint is checked when a window framebuffer is created.
+ */
+#define SDL_HINT_VIDEO_OFFSCREEN_DOUBLE_BUFFER "SDL_VIDEO_OFFSCREEN_DOUBLE_BUFFER"
+
 /**
  *  \brief  A variable controlling whether the libdecor Wayland backend is allowed to be used.
  *
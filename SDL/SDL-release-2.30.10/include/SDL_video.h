@@ -1362,6 +1362,55 @@ extern DECLSPEC int SDLCALL SDL_UpdateWindowSurfaceRects(SDL_Window * window,
                                                          const SDL_Rect * rects,
                                                          int numrects);
 
+/**
+ * Map the pixels of the last frame presented to a window, read-only and
+ * without copying them.
+ *
+ * This is only supported by the offscreen video driver, for windows drawn
+ * through their window surface or the software renderer. The pixels stay
+ * valid until SDL_UnlockPresentedFrame() is called, and the window must
+ * not be resized or destroyed meanwhile. Only one lock can be held at a
+ * time.
+ *
+ * With `SDL_HINT_VIDEO_OFFSCREEN_DOUBLE_BUFFER` set, the next frame renders
+ * into a second buffer while this one is mapped. A frame presented while
+ * the lock is held is not published, the one after it replaces it. Without
+ * the hint there is a single buffer, which the next frame draws over.
+ *
+ * \param window the window to query
+ * \param pixels filled in with a pointer to the frame's pixels
+ * \param pitch filled in with the length of a row of pixels in bytes, may
+ *              be NULL
+ * \param format filled in with the SDL_PixelFormatEnum of the pixels, may
+ *               be NULL
+ * \param frame filled in with the number of frames presented up to this
+ *              one, may be NULL
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is a local addition to the vendored SDL 2.30.10,
+ *        it is not part of upstream SDL.
+ *
+ * \sa SDL_UnlockPresentedFrame
+ */
+extern DECLSPEC int SDLCALL SDL_LockPresentedFrame(SDL_Window * window,
+                                                   const void **pixels,
+                                                   int *pitch,
+                                                   Uint32 * format,
+                                                   Uint32 * frame);
+
+/**
+ * Release a frame mapped with SDL_LockPresentedFrame().
+ *
+ * \param window the window the frame was locked from
+ *
+ * \since This function is a local addition to the vendored SDL 2.30.10,
+ *        it is not part of upstream SDL.
+ *
+ * \sa SDL_LockPresentedFrame
+ */
+extern DECLSPEC void SDLCALL SDL_UnlockPresentedFrame(SDL_Window * window);
+
 /**
  * Destroy the surface associated with the window.
  *
@@ -898,3 +898,5 @@
 #define SDL_DestroyWindowSurface SDL_DestroyWindowSurface_REAL
 #define SDL_GDKGetDefaultUser SDL_GDKGetDefaultUser_REAL
 #define SDL_GameControllerGetSteamHandle SDL_GameControllerGetSteamHandle_REAL
+#define SDL_LockPresentedFrame SDL_LockPresentedFrame_REAL
+#define SDL_UnlockPresentedFrame SDL_UnlockPresentedFrame_REAL
@@ -985,3 +985,5 @@ SDL_DYNAPI_PROC(int,SDL_DestroyWindowSurface,(SDL_Window *a),(a),return)
 SDL_DYNAPI_PROC(int,SDL_GDKGetDefaultUser,(XUserHandle *a),(a),return)
 #endif
 SDL_DYNAPI_PROC(Uint64,SDL_GameControllerGetSteamHandle,(SDL_GameController *a),(a),return)
+SDL_DYNAPI_PROC(int,SDL_LockPresentedFrame,(SDL_Window *a, const void **b, int *c, Uint32 *d, Uint32 *e),(a,b,c,d,e),return)
+SDL_DYNAPI_PROC(void,SDL_UnlockPresentedFrame,(SDL_Window *a),(a),)
@@ -91,6 +91,21 @@ static struct
     SDL_SysWMEntry *wmmsg_free;
 } SDL_EventQ = { NULL, SDL_FALSE, { 0 }, 0, NULL, NULL, NULL, NULL, NULL };
 
+/* Optional lock-free ring for one producer thread, see SDL_HINT_EVENT_QUEUE_SPSC.
+   The producer only writes head, the thread holding SDL_EventQ.lock only writes tail,
+   so the producer never has to take the lock. */
+#define SDL_EVENT_RING_SIZE 4096 /* must be a power of 2 */
+
+static struct
+{
+    SDL_bool enabled;
+    SDL_threadID owner;     /* thread that started the event loop, it uses the regular queue */
+    void *producer;         /* thread ID of the thread that claimed the ring, or NULL */
+    SDL_atomic_t head;
+    SDL_atomic_t tail;
+    SDL_Event events[SDL_EVENT_RING_SIZE];
+} SDL_EventRing;
+
 #ifndef SDL_JOYSTICK_DISABLED
 
 static SDL_bool SDL_update_joysticks = SDL_TRUE;
@@ -582,6 +597,10 @@ void SDL_StopEventLoop(void)
     SDL_EventQ.wmmsg_free = NULL;
     SDL_AtomicSet(&SDL_sentinel_pending, 0);
 
+    SDL_EventRing.enabled = SDL_FALSE;
+    SDL_AtomicSetPtr(&SDL_EventRing.producer, NULL);
+    SDL_AtomicSet(&SDL_EventRing.tail, SDL_AtomicGet(&SDL_EventRing.head));
+
     /* Clear disabled event state */
     for (i = 0; i < SDL_arraysize(SDL_disabled_events); ++i) {
         SDL_free(SDL_disabled_events[i]);
@@ -644,6 +663,9 @@ int SDL_StartEventLoop(void)
     (void)SDL_EventState(SDL_DROPTEXT, SDL_DISABLE);
 #endif
 
+    SDL_EventRing.enabled = SDL_GetHintBoolean(SDL_HINT_EVENT_QUEUE_SPSC, SDL_FALSE);
+    SDL_EventRing.owner = SDL_ThreadID();
+
     SDL_EventQ.active = SDL_TRUE;
     SDL_UnlockMutex(SDL_EventQ.lock);
     return 0;
@@ -733,6 +755,75 @@ static void SDL_CutEvent(SDL_EventEntry *entry)
     SDL_AtomicAdd(&SDL_EventQ.count, -1);
 }
 
+/* Claim the ring for the calling thread if it is still free.
+   Returns SDL_TRUE if the calling thread may push onto the ring. */
+static SDL_bool SDL_IsEventRingProducer(void)
+{
+    const SDL_threadID self = SDL_ThreadID();
+    void *producer;
+
+    if (!SDL_EventRing.enabled || self == SDL_EventRing.owner) {
+        return SDL_FALSE;
+    }
+    producer = SDL_AtomicGetPtr(&SDL_EventRing.producer);
+    if (producer == NULL) {
+        if (SDL_AtomicCASPtr(&SDL_EventRing.producer, NULL, (void *)(uintptr_t)self)) {
+            return SDL_TRUE;
+        }
+        producer = SDL_AtomicGetPtr(&SDL_EventRing.producer);
+    }
+    return producer == (void *)(uintptr_t)self;
+}
+
+/* Push events onto the ring -- called by the producer thread only, without the queue lock */
+static int SDL_PushEventRing(SDL_Event *events, int numevents)
+{
+    int i;
+    int head = SDL_AtomicGet(&SDL_EventRing.head);
+    const int tail = SDL_AtomicGet(&SDL_EventRing.tail);
+
+    /* The consumer is done with every slot before tail */
+    SDL_MemoryBarrierAcquire();
+
+    for (i = 0; i < numevents; ++i) {
+        if (head - tail >= SDL_EVENT_RING_SIZE) {
+            SDL_SetError("Event queue is full (%d events)", SDL_EVENT_RING_SIZE);
+            break;
+        }
+        SDL_EventRing.events[head & (SDL_EVENT_RING_SIZE - 1)] = events[i];
+        ++head;
+    }
+
+    /* Publish the events only after they are fully written */
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&SDL_EventRing.head, head);
+    return i;
+}
+
+/* Move the ring's events onto the regular queue -- called with the queue locked */
+static void SDL_DrainEventRing(void)
+{
+    int head, tail;
+
+    if (!SDL_EventRing.enabled) {
+        return;
+    }
+
+    head = SDL_AtomicGet(&SDL_EventRing.head);
+    tail = SDL_AtomicGet(&SDL_EventRing.tail);
+    SDL_MemoryBarrierAcquire();
+
+    while (tail != head) {
+        if (!SDL_AddEvent(&SDL_EventRing.events[tail & (SDL_EVENT_RING_SIZE - 1)])) {
+            break; /* queue full, leave the rest on the ring */
+        }
+        ++tail;
+    }
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&SDL_EventRing.tail, tail);
+}
+
 static int SDL_SendWakeupEvent(void)
 {
     SDL_VideoDevice *_this = SDL_GetVideoDevice();
@@ -760,6 +851,18 @@ static int SDL_PeepEventsInternal(SDL_Event *events, int numevents, SDL_eventact
 {
     int i, used, sentinels_expected = 0;
 
+    /* Events from the ring's producer skip the lock, except the ones that need more
+       than a copy of the SDL_Event to be queued */
+    if (action == SDL_ADDEVENT && SDL_EventRing.enabled && SDL_EventQ.active &&
+        numevents == 1 && events[0].type != SDL_POLLSENTINEL && events[0].type != SDL_SYSWMEVENT &&
+        SDL_IsEventRingProducer()) {
+        used = SDL_PushEventRing(events, numevents);
+        if (used > 0) {
+            SDL_SendWakeupEvent();
+        }
+        return used;
+    }
+
     /* Lock the event queue */
     used = 0;
 
@@ -774,6 +877,7 @@ static int SDL_PeepEventsInternal(SDL_Event *events, int numevents, SDL_eventact
             SDL_UnlockMutex(SDL_EventQ.lock);
             return -1;
         }
+        SDL_DrainEventRing();
         if (action == SDL_ADDEVENT) {
             for (i = 0; i < numevents; ++i) {
                 used += SDL_AddEvent(&events[i]);
@@ -894,6 +998,7 @@ void SDL_FlushEvents(Uint32 minType, Uint32 maxType)
             SDL_UnlockMutex(SDL_EventQ.lock);
             return;
         }
+        SDL_DrainEventRing();
         for (entry = SDL_EventQ.head; entry; entry = next) {
             next = entry->next;
             type = entry->event.type;
@@ -1299,6 +1404,7 @@ void SDL_FilterEvents(SDL_EventFilter filter, void *userdata)
     SDL_LockMutex(SDL_EventQ.lock);
     {
         SDL_EventEntry *entry, *next;
+        SDL_DrainEventRing();
         for (entry = SDL_EventQ.head; entry; entry = next) {
             next = entry->next;
             if (!filter(userdata, &entry->event)) {
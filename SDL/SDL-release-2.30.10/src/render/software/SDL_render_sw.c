@@ -34,6 +34,7 @@
 #include "SDL_drawpoint.h"
 #include "SDL_rotate.h"
 #include "SDL_triangle.h"
+#include "../../thread/SDL_systhread.h"
 
 /* SDL surface based renderer implementation */
 
@@ -44,10 +45,53 @@ typedef struct
     SDL_bool surface_cliprect_dirty;
 } SW_DrawStateCache;
 
+/* Tile-parallel rasterization, see SDL_HINT_RENDER_SW_THREADS */
+#define SW_MAX_THREADS      64
+#define SW_TILES_PER_THREAD 4            /* more tiles than threads to balance uneven work */
+#define SW_TILE_MIN_PIXELS  (128 * 128)  /* batches smaller than this run on one thread */
+
+/* A clear, fill or point command with its viewport already applied */
+typedef struct
+{
+    const SDL_RenderCommand *cmd;
+    const void *verts;
+    Uint32 color;    /* mapped color, used when not blending */
+    SDL_Rect clip;   /* clip rect of the command, in surface coordinates */
+    SDL_Rect bounds; /* part of the surface the command can touch */
+} SW_TileOp;
+
+typedef struct SW_TilePool SW_TilePool;
+
+typedef struct
+{
+    SW_TilePool *pool;
+    SDL_Surface *surface; /* shares the target's pixels, owns its clip rect */
+    SDL_Thread *thread;
+} SW_TileWorker;
+
+struct SW_TilePool
+{
+    int num_threads;
+    SW_TileWorker workers[SW_MAX_THREADS];
+    SDL_sem *start;
+    SDL_sem *done;
+    SDL_atomic_t quit;
+
+    SW_TileOp *ops;
+    int num_ops;
+    int max_ops;
+    Sint64 pixels; /* bounding area of the queued ops */
+
+    SDL_atomic_t next_tile;
+    int num_tiles;
+    int tile_h;
+};
+
 typedef struct
 {
     SDL_Surface *surface;
     SDL_Surface *window;
+    SW_TilePool *tiles;
 } SW_RenderData;
 
 static SDL_Surface *SW_ActivateRenderer(SDL_Renderer *renderer)
@@ -658,10 +702,312 @@ static void SetDrawState(SDL_Surface *surface, SW_DrawStateCache *drawstate)
     }
 }
 
+/* Run the queued tile ops of one tile -- the ops only read shared state, each worker
+   writes through its own surface whose clip rect keeps it inside the tile */
+static void SW_RunTile(SW_TilePool *pool, SDL_Surface *surface, int tile)
+{
+    SDL_Rect tile_rect, clip;
+    int i;
+
+    tile_rect.x = 0;
+    tile_rect.y = tile * pool->tile_h;
+    tile_rect.w = surface->w;
+    tile_rect.h = SDL_min(pool->tile_h, surface->h - tile_rect.y);
+
+    for (i = 0; i < pool->num_ops; ++i) {
+        const SW_TileOp *op = &pool->ops[i];
+        const SDL_RenderCommand *cmd = op->cmd;
+
+        if (!SDL_HasIntersection(&op->bounds, &tile_rect)) {
+            continue;
+        }
+        SDL_IntersectRect(&op->clip, &tile_rect, &clip);
+        SDL_SetClipRect(surface, &clip);
+
+        switch (cmd->command) {
+        case SDL_RENDERCMD_CLEAR:
+            SDL_FillRect(surface, &clip, op->color);
+            break;
+
+        case SDL_RENDERCMD_DRAW_POINTS:
+            if (cmd->data.draw.blend == SDL_BLENDMODE_NONE) {
+                SDL_DrawPoints(surface, (const SDL_Point *)op->verts, (int)cmd->data.draw.count, op->color);
+            } else {
+                SDL_BlendPoints(surface, (const SDL_Point *)op->verts, (int)cmd->data.draw.count, cmd->data.draw.blend,
+                                cmd->data.draw.r, cmd->data.draw.g, cmd->data.draw.b, cmd->data.draw.a);
+            }
+            break;
+
+        case SDL_RENDERCMD_FILL_RECTS:
+            if (cmd->data.draw.blend == SDL_BLENDMODE_NONE) {
+                SDL_FillRects(surface, (const SDL_Rect *)op->verts, (int)cmd->data.draw.count, op->color);
+            } else {
+                SDL_BlendFillRects(surface, (const SDL_Rect *)op->verts, (int)cmd->data.draw.count, cmd->data.draw.blend,
+                                   cmd->data.draw.r, cmd->data.draw.g, cmd->data.draw.b, cmd->data.draw.a);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+static void SW_RunTiles(SW_TilePool *pool, SDL_Surface *surface)
+{
+    int tile;
+
+    while ((tile = SDL_AtomicAdd(&pool->next_tile, 1)) < pool->num_tiles) {
+        SW_RunTile(pool, surface, tile);
+    }
+}
+
+static int SDLCALL SW_TileThread(void *data)
+{
+    SW_TileWorker *worker = (SW_TileWorker *)data;
+    SW_TilePool *pool = worker->pool;
+
+    for (;;) {
+        SDL_SemWait(pool->start);
+        if (SDL_AtomicGet(&pool->quit)) {
+            break;
+        }
+        SW_RunTiles(pool, worker->surface);
+        SDL_SemPost(pool->done);
+    }
+    return 0;
+}
+
+static void SW_DestroyTilePool(SW_TilePool *pool)
+{
+    int i;
+
+    SDL_AtomicSet(&pool->quit, 1);
+    for (i = 1; i < pool->num_threads; ++i) {
+        if (pool->workers[i].thread) {
+            SDL_SemPost(pool->start);
+        }
+    }
+    for (i = 0; i < pool->num_threads; ++i) {
+        SDL_WaitThread(pool->workers[i].thread, NULL);
+        SDL_FreeSurface(pool->workers[i].surface);
+    }
+    if (pool->start) {
+        SDL_DestroySemaphore(pool->start);
+    }
+    if (pool->done) {
+        SDL_DestroySemaphore(pool->done);
+    }
+    SDL_free(pool->ops);
+    SDL_free(pool);
+}
+
+static SW_TilePool *SW_CreateTilePool(int num_threads)
+{
+    SW_TilePool *pool;
+    int i;
+
+    pool = (SW_TilePool *)SDL_calloc(1, sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+    pool->num_threads = SDL_min(num_threads, SW_MAX_THREADS);
+    pool->start = SDL_CreateSemaphore(0);
+    pool->done = SDL_CreateSemaphore(0);
+    if (!pool->start || !pool->done) {
+        SW_DestroyTilePool(pool);
+        return NULL;
+    }
+
+    /* Worker 0 is the thread running the command queue */
+    for (i = 0; i < pool->num_threads; ++i) {
+        pool->workers[i].pool = pool;
+    }
+    for (i = 1; i < pool->num_threads; ++i) {
+        pool->workers[i].thread = SDL_CreateThreadInternal(SW_TileThread, "SDLRenderSW", 0, &pool->workers[i]);
+        if (!pool->workers[i].thread) {
+            SW_DestroyTilePool(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+/* Give every worker a surface over the target's pixels. Returns SDL_FALSE if the target
+   cannot be shared this way and has to be rendered on one thread. The worker surfaces
+   only get recreated when the layout changes; a double buffered window framebuffer
+   moves its pixels on every present, they are then just pointed at the new ones. */
+static SDL_bool SW_PrepareTileSurfaces(SW_TilePool *pool, SDL_Surface *surface)
+{
+    const SDL_Surface *shared = pool->workers[0].surface;
+    int i;
+
+    if (SDL_MUSTLOCK(surface) || surface->format->palette || !surface->pixels) {
+        return SDL_FALSE;
+    }
+    if (shared && shared->w == surface->w && shared->h == surface->h &&
+        shared->pitch == surface->pitch && shared->format->format == surface->format->format) {
+        /* The worker surfaces are SDL_PREALLOC, they don't own their pixels */
+        for (i = 0; i < pool->num_threads; ++i) {
+            pool->workers[i].surface->pixels = surface->pixels;
+        }
+        return SDL_TRUE;
+    }
+
+    for (i = 0; i < pool->num_threads; ++i) {
+        SDL_FreeSurface(pool->workers[i].surface);
+        pool->workers[i].surface = SDL_CreateRGBSurfaceWithFormatFrom(surface->pixels, surface->w, surface->h,
+                                                                      surface->format->BitsPerPixel, surface->pitch,
+                                                                      surface->format->format);
+        if (!pool->workers[i].surface) {
+            /* Leave no half-made set behind, the next flush starts over */
+            while (i-- > 0) {
+                SDL_FreeSurface(pool->workers[i].surface);
+                pool->workers[i].surface = NULL;
+            }
+            return SDL_FALSE;
+        }
+    }
+    return SDL_TRUE;
+}
+
+/* Commands that only write pixels inside their own clip rect, independently per pixel */
+static SDL_bool SW_IsTileCommand(const SDL_RenderCommand *cmd)
+{
+    switch (cmd->command) {
+    case SDL_RENDERCMD_CLEAR:
+    case SDL_RENDERCMD_DRAW_POINTS:
+    case SDL_RENDERCMD_FILL_RECTS:
+        return SDL_TRUE;
+    default:
+        return SDL_FALSE;
+    }
+}
+
+/* Commands that only change the draw state */
+static SDL_bool SW_IsStateCommand(const SDL_RenderCommand *cmd)
+{
+    switch (cmd->command) {
+    case SDL_RENDERCMD_SETDRAWCOLOR:
+    case SDL_RENDERCMD_SETVIEWPORT:
+    case SDL_RENDERCMD_SETCLIPRECT:
+    case SDL_RENDERCMD_NO_OP:
+        return SDL_TRUE;
+    default:
+        return SDL_FALSE;
+    }
+}
+
+/* Apply the viewport to a tile command and queue it, the same way the serial path would run it */
+static int SW_QueueTileOp(SW_TilePool *pool, SDL_Surface *surface, SDL_RenderCommand *cmd, void *vertices,
+                          const SW_DrawStateCache *drawstate)
+{
+    SW_TileOp *op;
+    SDL_Rect surface_rect;
+    int i;
+
+    if (pool->num_ops == pool->max_ops) {
+        const int max_ops = pool->max_ops ? pool->max_ops * 2 : 64;
+        SW_TileOp *ops = (SW_TileOp *)SDL_realloc(pool->ops, max_ops * sizeof(*ops));
+        if (!ops) {
+            return SDL_OutOfMemory();
+        }
+        pool->ops = ops;
+        pool->max_ops = max_ops;
+    }
+    op = &pool->ops[pool->num_ops++];
+    op->cmd = cmd;
+
+    surface_rect.x = 0;
+    surface_rect.y = 0;
+    surface_rect.w = surface->w;
+    surface_rect.h = surface->h;
+
+    if (cmd->command == SDL_RENDERCMD_CLEAR) {
+        /* By definition the clear ignores the clip rect */
+        op->verts = NULL;
+        op->color = SDL_MapRGBA(surface->format, cmd->data.color.r, cmd->data.color.g, cmd->data.color.b, cmd->data.color.a);
+        op->clip = surface_rect;
+        op->bounds = surface_rect;
+        pool->pixels += (Sint64)surface->w * surface->h;
+        return 0;
+    }
+
+    SDL_assert_release(drawstate->viewport != NULL);
+    op->verts = ((Uint8 *)vertices) + cmd->data.draw.first;
+    op->color = SDL_MapRGBA(surface->format, cmd->data.draw.r, cmd->data.draw.g, cmd->data.draw.b, cmd->data.draw.a);
+
+    /* Same clip rect as SetDrawState() would give the surface */
+    if (drawstate->cliprect) {
+        op->clip.x = drawstate->cliprect->x + drawstate->viewport->x;
+        op->clip.y = drawstate->cliprect->y + drawstate->viewport->y;
+        op->clip.w = drawstate->cliprect->w;
+        op->clip.h = drawstate->cliprect->h;
+        SDL_IntersectRect(drawstate->viewport, &op->clip, &op->clip);
+    } else {
+        op->clip = *drawstate->viewport;
+    }
+    SDL_IntersectRect(&op->clip, &surface_rect, &op->clip);
+
+    if (cmd->command == SDL_RENDERCMD_DRAW_POINTS) {
+        SDL_Point *verts = (SDL_Point *)op->verts;
+        const int count = (int)cmd->data.draw.count;
+        if (drawstate->viewport->x || drawstate->viewport->y) {
+            for (i = 0; i < count; i++) {
+                verts[i].x += drawstate->viewport->x;
+                verts[i].y += drawstate->viewport->y;
+            }
+        }
+        SDL_zero(op->bounds);
+        SDL_EnclosePoints(verts, count, &op->clip, &op->bounds);
+    } else {
+        SDL_Rect *verts = (SDL_Rect *)op->verts;
+        const int count = (int)cmd->data.draw.count;
+        SDL_zero(op->bounds);
+        for (i = 0; i < count; i++) {
+            verts[i].x += drawstate->viewport->x;
+            verts[i].y += drawstate->viewport->y;
+            SDL_UnionRect(&op->bounds, &verts[i], &op->bounds);
+        }
+        SDL_IntersectRect(&op->bounds, &op->clip, &op->bounds);
+    }
+    pool->pixels += (Sint64)op->bounds.w * op->bounds.h;
+    return 0;
+}
+
+/* Run the queued tile ops, on all threads if there is enough work */
+static void SW_FlushTileOps(SW_TilePool *pool, SDL_Surface *surface)
+{
+    int i, num_threads;
+
+    if (pool->num_ops == 0) {
+        return;
+    }
+
+    num_threads = (pool->pixels >= SW_TILE_MIN_PIXELS) ? pool->num_threads : 1;
+    pool->num_tiles = SDL_min(num_threads * SW_TILES_PER_THREAD, surface->h);
+    pool->tile_h = (surface->h + pool->num_tiles - 1) / pool->num_tiles;
+    pool->num_tiles = (surface->h + pool->tile_h - 1) / pool->tile_h;
+    SDL_AtomicSet(&pool->next_tile, 0);
+
+    for (i = 1; i < num_threads; ++i) {
+        SDL_SemPost(pool->start);
+    }
+    SW_RunTiles(pool, pool->workers[0].surface);
+    for (i = 1; i < num_threads; ++i) {
+        SDL_SemWait(pool->done);
+    }
+
+    pool->num_ops = 0;
+    pool->pixels = 0;
+}
+
 static int SW_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd, void *vertices, size_t vertsize)
 {
+    SW_RenderData *data = (SW_RenderData *)renderer->driverdata;
     SDL_Surface *surface = SW_ActivateRenderer(renderer);
     SW_DrawStateCache drawstate;
+    SW_TilePool *tiles;
 
     if (!surface) {
         return -1;
@@ -671,7 +1017,27 @@ static int SW_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd, vo
     drawstate.cliprect = NULL;
     drawstate.surface_cliprect_dirty = SDL_TRUE;
 
+    /* Clears, fills and points are collected and rasterized per tile in parallel. Any
+       other command first waits for those to finish, then runs here as usual. */
+    tiles = data->tiles;
+    if (tiles && !SW_PrepareTileSurfaces(tiles, surface)) {
+        tiles = NULL;
+    }
+
     while (cmd) {
+        if (tiles) {
+            if (SW_IsTileCommand(cmd)) {
+                if (SW_QueueTileOp(tiles, surface, cmd, vertices, &drawstate) < 0) {
+                    return -1;
+                }
+                cmd = cmd->next;
+                continue;
+            }
+            if (!SW_IsStateCommand(cmd)) {
+                SW_FlushTileOps(tiles, surface);
+            }
+        }
+
         switch (cmd->command) {
             case SDL_RENDERCMD_SETDRAWCOLOR: {
                 break;  /* Not used in this backend. */
@@ -928,6 +1294,10 @@ static int SW_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd, vo
         cmd = cmd->next;
     }
 
+    if (tiles) {
+        SW_FlushTileOps(tiles, surface);
+    }
+
     return 0;
 }
 
@@ -986,6 +1356,9 @@ static void SW_DestroyRenderer(SDL_Renderer *renderer)
     if (window) {
         SDL_DestroyWindowSurface(window);
     }
+    if (data && data->tiles) {
+        SW_DestroyTilePool(data->tiles);
+    }
     SDL_free(data);
     SDL_free(renderer);
 }
@@ -994,6 +1367,7 @@ SDL_Renderer *SW_CreateRendererForSurface(SDL_Surface *surface)
 {
     SDL_Renderer *renderer;
     SW_RenderData *data;
+    const char *threads;
 
     if (!surface) {
         SDL_InvalidParamError("surface");
@@ -1015,6 +1389,11 @@ SDL_Renderer *SW_CreateRendererForSurface(SDL_Surface *surface)
     data->surface = surface;
     data->window = surface;
 
+    threads = SDL_GetHint(SDL_HINT_RENDER_SW_THREADS);
+    if (threads && SDL_atoi(threads) > 1) {
+        data->tiles = SW_CreateTilePool(SDL_atoi(threads));
+    }
+
     renderer->WindowEvent = SW_WindowEvent;
     renderer->GetOutputSize = SW_GetOutputSize;
     renderer->CreateTexture = SW_CreateTexture;
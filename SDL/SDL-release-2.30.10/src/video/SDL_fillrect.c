@@ -23,6 +23,9 @@
 #include "SDL_video.h"
 #include "SDL_blit.h"
 #include "SDL_cpuinfo.h"
+#include "SDL_hints.h"
+
+typedef void (*SDL_FillRectFunc)(Uint8 *pixels, int pitch, Uint32 color, int w, int h);
 
 #ifdef __SSE__
 /* *INDENT-OFF* */ /* clang-format off */
@@ -135,6 +138,125 @@ DEFINE_SSE_FILLRECT(4, Uint32)
 /* *INDENT-ON* */ /* clang-format on */
 #endif            /* __SSE__ */
 
+/* AVX2 and AVX-512 32bpp fills, built with target attributes so they can be picked at
+   runtime without compiling the whole library for those instruction sets. */
+#if defined(HAVE_IMMINTRIN_H) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define HAVE_AVX_FILLRECT
+#define SDL_TARGETING_AVX2   __attribute__((target("avx2")))
+#define SDL_TARGETING_AVX512 __attribute__((target("avx512f")))
+
+/* Fills bigger than this use non-temporal stores, smaller ones (board cells, glyph
+   backgrounds) are likely read again soon and stay in the cache. */
+#define FILLRECT_STREAM_BYTES (256 * 1024)
+
+SDL_TARGETING_AVX2 static void SDL_FillRect4AVX2(Uint8 *pixels, int pitch, Uint32 color, int w, int h)
+{
+    const __m256i c256 = _mm256_set1_epi32((int)color);
+    const SDL_bool stream = ((size_t)w * h * 4 >= FILLRECT_STREAM_BYTES);
+    Uint32 *p;
+    int n;
+
+    /* If the number of bytes per row is equal to the pitch, treat */
+    /* all rows as one long continuous row (for better performance) */
+    if (w * 4 == pitch) {
+        w = w * h;
+        h = 1;
+    }
+
+    while (h--) {
+        p = (Uint32 *)pixels;
+        n = w;
+
+        while (n > 0 && ((uintptr_t)p & 31)) {
+            *p++ = color;
+            --n;
+        }
+        if (stream) {
+            for (; n >= 32; n -= 32, p += 32) {
+                _mm256_stream_si256((__m256i *)(p + 0), c256);
+                _mm256_stream_si256((__m256i *)(p + 8), c256);
+                _mm256_stream_si256((__m256i *)(p + 16), c256);
+                _mm256_stream_si256((__m256i *)(p + 24), c256);
+            }
+        } else {
+            for (; n >= 32; n -= 32, p += 32) {
+                _mm256_store_si256((__m256i *)(p + 0), c256);
+                _mm256_store_si256((__m256i *)(p + 8), c256);
+                _mm256_store_si256((__m256i *)(p + 16), c256);
+                _mm256_store_si256((__m256i *)(p + 24), c256);
+            }
+        }
+        for (; n >= 8; n -= 8, p += 8) {
+            _mm256_store_si256((__m256i *)p, c256);
+        }
+        while (n-- > 0) {
+            *p++ = color;
+        }
+        pixels += pitch;
+    }
+
+    if (stream) {
+        _mm_sfence();
+    }
+}
+
+SDL_TARGETING_AVX512 static void SDL_FillRect4AVX512(Uint8 *pixels, int pitch, Uint32 color, int w, int h)
+{
+    const __m512i c512 = _mm512_set1_epi32((int)color);
+    const SDL_bool stream = ((size_t)w * h * 4 >= FILLRECT_STREAM_BYTES);
+    Uint32 *p;
+    int n;
+
+    if (w * 4 == pitch) {
+        w = w * h;
+        h = 1;
+    }
+
+    while (h--) {
+        p = (Uint32 *)pixels;
+        n = w;
+
+        /* Masked stores cover the unaligned head and the tail of the row */
+        if ((uintptr_t)p & 63) {
+            int head = (int)((64 - ((uintptr_t)p & 63)) / 4);
+            if (head > n) {
+                head = n;
+            }
+            _mm512_mask_storeu_epi32(p, (__mmask16)((1u << head) - 1), c512);
+            p += head;
+            n -= head;
+        }
+        if (stream) {
+            for (; n >= 64; n -= 64, p += 64) {
+                _mm512_stream_si512((void *)(p + 0), c512);
+                _mm512_stream_si512((void *)(p + 16), c512);
+                _mm512_stream_si512((void *)(p + 32), c512);
+                _mm512_stream_si512((void *)(p + 48), c512);
+            }
+        } else {
+            for (; n >= 64; n -= 64, p += 64) {
+                _mm512_store_si512((void *)(p + 0), c512);
+                _mm512_store_si512((void *)(p + 16), c512);
+                _mm512_store_si512((void *)(p + 32), c512);
+                _mm512_store_si512((void *)(p + 48), c512);
+            }
+        }
+        for (; n >= 16; n -= 16, p += 16) {
+            _mm512_store_si512((void *)p, c512);
+        }
+        if (n > 0) {
+            _mm512_mask_storeu_epi32(p, (__mmask16)((1u << n) - 1), c512);
+        }
+        pixels += pitch;
+    }
+
+    if (stream) {
+        _mm_sfence();
+    }
+}
+#endif /* HAVE_AVX_FILLRECT */
+
 static void SDL_FillRect1(Uint8 *pixels, int pitch, Uint32 color, int w, int h)
 {
     int n;
@@ -235,6 +357,47 @@ static void SDL_FillRect4(Uint8 *pixels, int pitch, Uint32 color, int w, int h)
     }
 }
 
+/* The widest 32bpp kernel the CPU supports, or the one SDL_HINT_FILLRECT_KERNEL asks
+   for when the CPU supports that */
+static SDL_FillRectFunc SDL_ChooseFillRect4(void)
+{
+    const char *kernel = SDL_GetHint(SDL_HINT_FILLRECT_KERNEL);
+
+    if (kernel && *kernel) {
+        if (SDL_strcasecmp(kernel, "scalar") == 0) {
+            return SDL_FillRect4;
+        }
+#ifdef __SSE__
+        if (SDL_strcasecmp(kernel, "sse") == 0 && SDL_HasSSE()) {
+            return SDL_FillRect4SSE;
+        }
+#endif
+#ifdef HAVE_AVX_FILLRECT
+        if (SDL_strcasecmp(kernel, "avx2") == 0 && SDL_HasAVX2()) {
+            return SDL_FillRect4AVX2;
+        }
+        if (SDL_strcasecmp(kernel, "avx512") == 0 && SDL_HasAVX512F()) {
+            return SDL_FillRect4AVX512;
+        }
+#endif
+    }
+
+#ifdef HAVE_AVX_FILLRECT
+    if (SDL_HasAVX512F()) {
+        return SDL_FillRect4AVX512;
+    }
+    if (SDL_HasAVX2()) {
+        return SDL_FillRect4AVX2;
+    }
+#endif
+#ifdef __SSE__
+    if (SDL_HasSSE()) {
+        return SDL_FillRect4SSE;
+    }
+#endif
+    return SDL_FillRect4;
+}
+
 /*
  * This function performs a fast fill of the given rectangle with 'color'
  */
@@ -310,7 +473,7 @@ int SDL_FillRects(SDL_Surface *dst, const SDL_Rect *rects, int count,
     SDL_Rect clipped;
     Uint8 *pixels;
     const SDL_Rect *rect;
-    void (*fill_function)(Uint8 * pixels, int pitch, Uint32 color, int w, int h) = NULL;
+    SDL_FillRectFunc fill_function = NULL;
     int i;
 
     if (!dst) {
@@ -417,13 +580,7 @@ int SDL_FillRects(SDL_Surface *dst, const SDL_Rect *rects, int count,
 
         case 4:
         {
-#ifdef __SSE__
-            if (SDL_HasSSE()) {
-                fill_function = SDL_FillRect4SSE;
-                break;
-            }
-#endif
-            fill_function = SDL_FillRect4;
+            fill_function = SDL_ChooseFillRect4();
             break;
         }
 
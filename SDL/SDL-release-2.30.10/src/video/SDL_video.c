@@ -2674,6 +2674,11 @@ static SDL_bool ShouldAttemptTextureFramebuffer(void)
         }
     } else {
         /* Check for platform specific defaults */
+        /* The offscreen framebuffer is what gets saved and read back with SDL_LockPresentedFrame(),
+           a texture framebuffer would draw into an EGL surface nobody looks at. */
+        if (_this->CreateWindowFramebuffer && (SDL_strcmp(_this->name, "offscreen") == 0)) {
+            attempt_texture_framebuffer = SDL_FALSE;
+        }
 #if defined(__LINUX__)
         /* On WSL, direct X11 is faster than using OpenGL for window framebuffers, so try to detect WSL and avoid texture framebuffer. */
         if ((_this->CreateWindowFramebuffer) && (SDL_strcmp(_this->name, "x11") == 0)) {
@@ -2828,6 +2833,28 @@ int SDL_DestroyWindowSurface(SDL_Window *window)
     return 0;
 }
 
+int SDL_LockPresentedFrame(SDL_Window *window, const void **pixels, int *pitch, Uint32 *format, Uint32 *frame)
+{
+    CHECK_WINDOW_MAGIC(window, -1);
+
+    if (!pixels) {
+        return SDL_InvalidParamError("pixels");
+    }
+    if (!_this->LockPresentedFrame) {
+        return SDL_Unsupported();
+    }
+    return _this->LockPresentedFrame(_this, window, pixels, pitch, format, frame);
+}
+
+void SDL_UnlockPresentedFrame(SDL_Window *window)
+{
+    CHECK_WINDOW_MAGIC(window,);
+
+    if (_this->UnlockPresentedFrame) {
+        _this->UnlockPresentedFrame(_this, window);
+    }
+}
+
 int SDL_SetWindowBrightness(SDL_Window * window, float brightness)
 {
     Uint16 ramp[256];
@@ -25,29 +25,55 @@
 #include "../SDL_sysvideo.h"
 #include "SDL_offscreenframebuffer_c.h"
 
-#define OFFSCREEN_SURFACE "_SDL_DummySurface"
+#include "SDL_hints.h"
+
+#define OFFSCREEN_FRAMEBUFFER "_SDL_OffscreenFramebuffer"
+
+/* The window framebuffer. SDL renders into the back buffer; with double
+ * buffering a present turns it into the front buffer, which consumers map
+ * through SDL_LockPresentedFrame() while the next frame renders. */
+typedef struct
+{
+    SDL_Surface *buffers[2];
+    int num_buffers;
+    int back;
+    int front;
+    SDL_SpinLock lock;      /* guards front, locked and frame */
+    SDL_bool locked;
+    Uint32 frame;           /* frames presented, the front buffer holds this one */
+} OFFSCREEN_Framebuffer;
 
 int SDL_OFFSCREEN_CreateWindowFramebuffer(_THIS, SDL_Window *window, Uint32 *format, void **pixels, int *pitch)
 {
-    SDL_Surface *surface;
+    OFFSCREEN_Framebuffer *framebuffer;
     const Uint32 surface_format = SDL_PIXELFORMAT_RGB888;
-    int w, h;
+    int w, h, i;
 
     /* Free the old framebuffer surface */
     SDL_OFFSCREEN_DestroyWindowFramebuffer(_this, window);
 
+    framebuffer = (OFFSCREEN_Framebuffer *)SDL_calloc(1, sizeof(*framebuffer));
+    if (!framebuffer) {
+        return SDL_OutOfMemory();
+    }
+    framebuffer->num_buffers = SDL_GetHintBoolean(SDL_HINT_VIDEO_OFFSCREEN_DOUBLE_BUFFER, SDL_FALSE) ? 2 : 1;
+
     /* Create a new one */
     SDL_GetWindowSizeInPixels(window, &w, &h);
-    surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, surface_format);
-    if (!surface) {
-        return -1;
+    for (i = 0; i < framebuffer->num_buffers; ++i) {
+        framebuffer->buffers[i] = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, surface_format);
+        if (!framebuffer->buffers[i]) {
+            SDL_FreeSurface(framebuffer->buffers[0]);
+            SDL_free(framebuffer);
+            return -1;
+        }
     }
 
     /* Save the info and return! */
-    SDL_SetWindowData(window, OFFSCREEN_SURFACE, surface);
+    SDL_SetWindowData(window, OFFSCREEN_FRAMEBUFFER, framebuffer);
     *format = surface_format;
-    *pixels = surface->pixels;
-    *pitch = surface->pitch;
+    *pixels = framebuffer->buffers[0]->pixels;
+    *pitch = framebuffer->buffers[0]->pitch;
 
     return 0;
 }
@@ -55,12 +81,28 @@ int SDL_OFFSCREEN_CreateWindowFramebuffer(_THIS, SDL_Window *window, Uint32 *for
 int SDL_OFFSCREEN_UpdateWindowFramebuffer(_THIS, SDL_Window *window, const SDL_Rect *rects, int numrects)
 {
     static int frame_number;
+    OFFSCREEN_Framebuffer *framebuffer;
     SDL_Surface *surface;
 
-    surface = (SDL_Surface *)SDL_GetWindowData(window, OFFSCREEN_SURFACE);
-    if (!surface) {
+    framebuffer = (OFFSCREEN_Framebuffer *)SDL_GetWindowData(window, OFFSCREEN_FRAMEBUFFER);
+    if (!framebuffer) {
         return SDL_SetError("Couldn't find offscreen surface for window");
     }
+    surface = framebuffer->buffers[framebuffer->back];
+
+    SDL_AtomicLock(&framebuffer->lock);
+    if (framebuffer->num_buffers == 1) {
+        framebuffer->frame++;
+    } else if (!framebuffer->locked && window->surface && window->surface->pixels == surface->pixels) {
+        /* Publish the finished frame and render the next one into the other buffer */
+        framebuffer->front = framebuffer->back;
+        framebuffer->back = !framebuffer->back;
+        window->surface->pixels = framebuffer->buffers[framebuffer->back]->pixels;
+        framebuffer->frame++;
+    }
+    /* else a consumer still reads the front buffer, the frame is dropped and
+       the next one overwrites it */
+    SDL_AtomicUnlock(&framebuffer->lock);
 
     /* Send the data to the display */
     if (SDL_getenv("SDL_VIDEO_OFFSCREEN_SAVE_FRAMES")) {
@@ -74,10 +116,64 @@ int SDL_OFFSCREEN_UpdateWindowFramebuffer(_THIS, SDL_Window *window, const SDL_R
 
 void SDL_OFFSCREEN_DestroyWindowFramebuffer(_THIS, SDL_Window *window)
 {
+    OFFSCREEN_Framebuffer *framebuffer;
+    int i;
+
+    framebuffer = (OFFSCREEN_Framebuffer *)SDL_SetWindowData(window, OFFSCREEN_FRAMEBUFFER, NULL);
+    if (framebuffer) {
+        for (i = 0; i < framebuffer->num_buffers; ++i) {
+            SDL_FreeSurface(framebuffer->buffers[i]);
+        }
+        SDL_free(framebuffer);
+    }
+}
+
+int SDL_OFFSCREEN_LockPresentedFrame(_THIS, SDL_Window *window, const void **pixels, int *pitch, Uint32 *format, Uint32 *frame)
+{
+    OFFSCREEN_Framebuffer *framebuffer;
     SDL_Surface *surface;
 
-    surface = (SDL_Surface *)SDL_SetWindowData(window, OFFSCREEN_SURFACE, NULL);
-    SDL_FreeSurface(surface);
+    framebuffer = (OFFSCREEN_Framebuffer *)SDL_GetWindowData(window, OFFSCREEN_FRAMEBUFFER);
+    if (!framebuffer) {
+        return SDL_SetError("Window has no offscreen framebuffer");
+    }
+
+    SDL_AtomicLock(&framebuffer->lock);
+    if (framebuffer->locked) {
+        SDL_AtomicUnlock(&framebuffer->lock);
+        return SDL_SetError("Presented frame is already locked");
+    }
+    if (framebuffer->frame == 0) {
+        SDL_AtomicUnlock(&framebuffer->lock);
+        return SDL_SetError("No frame presented yet");
+    }
+    framebuffer->locked = SDL_TRUE;
+    surface = framebuffer->buffers[framebuffer->front];
+    if (frame) {
+        *frame = framebuffer->frame;
+    }
+    SDL_AtomicUnlock(&framebuffer->lock);
+
+    *pixels = surface->pixels;
+    if (pitch) {
+        *pitch = surface->pitch;
+    }
+    if (format) {
+        *format = surface->format->format;
+    }
+    return 0;
+}
+
+void SDL_OFFSCREEN_UnlockPresentedFrame(_THIS, SDL_Window *window)
+{
+    OFFSCREEN_Framebuffer *framebuffer;
+
+    framebuffer = (OFFSCREEN_Framebuffer *)SDL_GetWindowData(window, OFFSCREEN_FRAMEBUFFER);
+    if (framebuffer) {
+        SDL_AtomicLock(&framebuffer->lock);
+        framebuffer->locked = SDL_FALSE;
+        SDL_AtomicUnlock(&framebuffer->lock);
+    }
 }
 
 #endif /* SDL_VIDEO_DRIVER_OFFSCREEN */
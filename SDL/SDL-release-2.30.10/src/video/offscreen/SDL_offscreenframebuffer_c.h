@@ -23,5 +23,7 @@
 extern int SDL_OFFSCREEN_CreateWindowFramebuffer(_THIS, SDL_Window *window, Uint32 *format, void **pixels, int *pitch);
 extern int SDL_OFFSCREEN_UpdateWindowFramebuffer(_THIS, SDL_Window *window, const SDL_Rect *rects, int numrects);
 extern void SDL_OFFSCREEN_DestroyWindowFramebuffer(_THIS, SDL_Window *window);
+extern int SDL_OFFSCREEN_LockPresentedFrame(_THIS, SDL_Window *window, const void **pixels, int *pitch, Uint32 *format, Uint32 *frame);
+extern void SDL_OFFSCREEN_UnlockPresentedFrame(_THIS, SDL_Window *window);
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -216,6 +216,8 @@ typedef struct cached_glyph {
     FT_UInt index;
     TTF_Image bitmap;
     TTF_Image pixmap;
+    int lru_prev;   /* Neighbours in the font's LRU list, -1 at the ends */
+    int lru_next;
     int sz_left;
     int sz_top;
     int sz_width;
@@ -243,6 +245,34 @@ typedef struct PosBuf {
     int y;
 } PosBuf_t;
 
+/* Number of laid out strings cached per font, 2 per set */
+#define LAYOUT_CACHE_SIZE       64
+/* Longer strings are laid out every time */
+#define LAYOUT_CACHE_MAX_TEXT   256
+
+/* A string laid out by TTF_Size_Internal(), kept so drawing it again skips
+ * decoding, kerning and glyph metrics */
+typedef struct layout_run {
+    int stored;
+    Uint32 hash;
+    Uint32 last_used;
+    /* Key: the text and every setting the layout depends on */
+    char text[LAYOUT_CACHE_MAX_TEXT];
+    size_t text_len;
+    Uint32 generation;
+    int allow_kerning;
+#if TTF_USE_HARFBUZZ
+    hb_direction_t hb_direction;
+    hb_script_t hb_script;
+#endif
+    /* Result */
+    int w, h;
+    int xstart, ystart;
+    PosBuf_t *pos_buf;
+    Uint32 pos_len;
+    Uint32 pos_max;
+} layout_run;
+
 /* The structure used to hold internal font information */
 struct TTF_Font {
     /* Freetype2 maintains all sorts of useful info itself */
@@ -272,8 +302,18 @@ struct TTF_Font {
     int underline_top_row;
     int strikethrough_top_row;
 
-    /* Cache for style-transformed glyphs */
-    c_glyph cache[256];
+    /* Cache for style-transformed glyphs: 'cache' holds the glyphs and
+     * 'cache_table' maps glyph indices to them with open addressing.
+     * Glyphs never move while cached, the least recently used one is
+     * evicted when the cache is full. */
+    c_glyph *cache;
+    int *cache_table;      /* cache slot + 1, 0 for an empty bucket */
+    int cache_size;        /* number of glyphs, a power of two */
+    int cache_used;
+    int cache_lru_head;    /* most recently used slot */
+    int cache_lru_tail;    /* least recently used slot */
+    TTF_GlyphCacheStats cache_stats;
+    Uint32 cache_generation;   /* bumped on every flush, so atlases notice stale glyphs */
     FT_UInt cache_index[128];
 
     /* We are responsible for closing the font stream */
@@ -287,6 +327,10 @@ struct TTF_Font {
     Uint32 pos_len;
     Uint32 pos_max;
 
+    /* Recently laid out strings, allocated on first use */
+    layout_run *layout_cache;
+    Uint32 layout_clock;
+
     /* Hinting modes */
     int ft_load_target;
     int render_subpixel;
@@ -362,6 +406,7 @@ static SDL_INLINE int Find_GlyphByIndex(TTF_Font *font, FT_UInt idx,
         int translation, c_glyph **out_glyph, TTF_Image **out_image);
 
 static void Flush_Cache(TTF_Font *font);
+static int Alloc_Cache(TTF_Font *font, int size);
 
 #if defined(USE_DUFFS_LOOP)
 
@@ -1807,6 +1852,11 @@ TTF_Font* TTF_OpenFontIndexDPIRW(SDL_RWops *src, int freesrc, int ptsize, long i
     font->src = src;
     font->freesrc = freesrc;
 
+    if (Alloc_Cache(font, TTF_GLYPH_CACHE_DEFAULT_SIZE) < 0) {
+        TTF_CloseFont(font);
+        return NULL;
+    }
+
     stream = (FT_Stream)SDL_malloc(sizeof (*stream));
     if (stream == NULL) {
         TTF_SetError("Out of memory");
@@ -2091,13 +2141,152 @@ static void Flush_Glyph(c_glyph *glyph)
 static void Flush_Cache(TTF_Font *font)
 {
     int i;
-    int size = sizeof (font->cache) / sizeof (font->cache[0]);
 
-    for (i = 0; i < size; ++i) {
+    for (i = 0; i < font->cache_used; ++i) {
         if (font->cache[i].stored) {
             Flush_Glyph(&font->cache[i]);
         }
     }
+    if (font->cache_table) {
+        SDL_memset(font->cache_table, 0, 2 * font->cache_size * sizeof (*font->cache_table));
+    }
+    font->cache_used = 0;
+    font->cache_lru_head = -1;
+    font->cache_lru_tail = -1;
+    font->cache_generation++;
+}
+
+/* (Re)allocate the glyph cache for 'size' glyphs, rounded up to a power of two.
+ * The hash table has twice as many buckets to keep probe sequences short. */
+static int Alloc_Cache(TTF_Font *font, int size)
+{
+    c_glyph *cache;
+    int *table;
+    int pow2 = 16;
+
+    while (pow2 < size) {
+        pow2 *= 2;
+    }
+
+    cache = (c_glyph *)SDL_calloc(pow2, sizeof (*cache));
+    table = (int *)SDL_calloc(2 * pow2, sizeof (*table));
+    if (cache == NULL || table == NULL) {
+        SDL_free(cache);
+        SDL_free(table);
+        TTF_SetError("Out of memory");
+        return -1;
+    }
+
+    Flush_Cache(font);
+    SDL_free(font->cache);
+    SDL_free(font->cache_table);
+    font->cache = cache;
+    font->cache_table = table;
+    font->cache_size = pow2;
+    font->cache_used = 0;
+    font->cache_lru_head = -1;
+    font->cache_lru_tail = -1;
+    return 0;
+}
+
+static SDL_INLINE Uint32 Cache_Bucket(const TTF_Font *font, FT_UInt idx)
+{
+    return ((Uint32)idx * 2654435761u) & (2 * font->cache_size - 1);
+}
+
+static void Cache_Unlink(TTF_Font *font, int slot)
+{
+    c_glyph *glyph = &font->cache[slot];
+
+    if (glyph->lru_prev >= 0) {
+        font->cache[glyph->lru_prev].lru_next = glyph->lru_next;
+    } else {
+        font->cache_lru_head = glyph->lru_next;
+    }
+    if (glyph->lru_next >= 0) {
+        font->cache[glyph->lru_next].lru_prev = glyph->lru_prev;
+    } else {
+        font->cache_lru_tail = glyph->lru_prev;
+    }
+}
+
+static void Cache_PushFront(TTF_Font *font, int slot)
+{
+    c_glyph *glyph = &font->cache[slot];
+
+    glyph->lru_prev = -1;
+    glyph->lru_next = font->cache_lru_head;
+    if (font->cache_lru_head >= 0) {
+        font->cache[font->cache_lru_head].lru_prev = slot;
+    } else {
+        font->cache_lru_tail = slot;
+    }
+    font->cache_lru_head = slot;
+}
+
+/* Remove 'idx' from the hash table, shifting back the entries that probed past it */
+static void Cache_RemoveKey(TTF_Font *font, FT_UInt idx)
+{
+    const Uint32 mask = 2 * font->cache_size - 1;
+    Uint32 bucket = Cache_Bucket(font, idx);
+    Uint32 next;
+
+    while (font->cache[font->cache_table[bucket] - 1].index != idx) {
+        bucket = (bucket + 1) & mask;
+    }
+
+    for (next = (bucket + 1) & mask; font->cache_table[next]; next = (next + 1) & mask) {
+        const Uint32 home = Cache_Bucket(font, font->cache[font->cache_table[next] - 1].index);
+        /* Move the entry back if its home bucket is not between the hole and its position */
+        if (((next - home) & mask) >= ((next - bucket) & mask)) {
+            font->cache_table[bucket] = font->cache_table[next];
+            bucket = next;
+        }
+    }
+    font->cache_table[bucket] = 0;
+}
+
+/* Get the cache slot of glyph 'idx', taking a free slot or evicting the least
+ * recently used glyph if it is not cached yet. The slot moves to the front of
+ * the LRU list either way. */
+static c_glyph *Cache_Lookup(TTF_Font *font, FT_UInt idx)
+{
+    const Uint32 mask = 2 * font->cache_size - 1;
+    Uint32 bucket = Cache_Bucket(font, idx);
+    c_glyph *glyph;
+    int slot;
+
+    for (; font->cache_table[bucket]; bucket = (bucket + 1) & mask) {
+        slot = font->cache_table[bucket] - 1;
+        if (font->cache[slot].index == idx) {
+            if (slot != font->cache_lru_head) {
+                Cache_Unlink(font, slot);
+                Cache_PushFront(font, slot);
+            }
+            return &font->cache[slot];
+        }
+    }
+
+    if (font->cache_used < font->cache_size) {
+        slot = font->cache_used++;
+    } else {
+        slot = font->cache_lru_tail;
+        glyph = &font->cache[slot];
+        Cache_RemoveKey(font, glyph->index);
+        Cache_Unlink(font, slot);
+        Flush_Glyph(glyph);
+        font->cache_stats.evictions++;
+
+        /* The removal may have shifted entries, find the free bucket again */
+        for (bucket = Cache_Bucket(font, idx); font->cache_table[bucket]; bucket = (bucket + 1) & mask) {
+        }
+    }
+
+    glyph = &font->cache[slot];
+    glyph->index = idx;
+    font->cache_table[bucket] = slot + 1;
+    Cache_PushFront(font, slot);
+    return glyph;
 }
 
 static FT_Error Load_Glyph(TTF_Font *font, c_glyph *cached, int want, int translation)
@@ -2620,8 +2809,7 @@ static SDL_INLINE int Find_GlyphByIndex(TTF_Font *font, FT_UInt idx,
         int want_bitmap, int want_pixmap, int want_color, int want_lcd, int want_subpixel,
         int translation, c_glyph **out_glyph, TTF_Image **out_image)
 {
-    /* cache size is 256, get key by masking */
-    c_glyph *glyph = &font->cache[idx & 0xff];
+    c_glyph *glyph = Cache_Lookup(font, idx);
 
     if (out_glyph) {
         *out_glyph = glyph;
@@ -2651,6 +2839,7 @@ static SDL_INLINE int Find_GlyphByIndex(TTF_Font *font, FT_UInt idx,
         }
 
         if ((glyph->stored & want) == want) {
+            font->cache_stats.hits++;
             return 0;
         }
 
@@ -2661,6 +2850,7 @@ static SDL_INLINE int Find_GlyphByIndex(TTF_Font *font, FT_UInt idx,
         }
 
         glyph->index = idx;
+        font->cache_stats.misses++;
         retval = Load_Glyph(font, glyph, want, translation);
         if (retval == 0) {
             return 0;
@@ -2676,23 +2866,28 @@ static SDL_INLINE int Find_GlyphByIndex(TTF_Font *font, FT_UInt idx,
         /* Faster check as it gets inlined */
         if (want_pixmap) {
             if ((glyph->stored & CACHED_PIXMAP) && glyph->index == idx) {
+                font->cache_stats.hits++;
                 return 0;
             }
         } else if (want_bitmap) {
             if ((glyph->stored & CACHED_BITMAP) && glyph->index == idx) {
+                font->cache_stats.hits++;
                 return 0;
             }
         } else if (want_color) {
             if ((glyph->stored & CACHED_COLOR) && glyph->index == idx) {
+                font->cache_stats.hits++;
                 return 0;
             }
         } else if (want_lcd) {
             if ((glyph->stored & CACHED_LCD) && glyph->index == idx) {
+                font->cache_stats.hits++;
                 return 0;
             }
         } else {
             /* Get metrics */
             if (glyph->stored && glyph->index == idx) {
+                font->cache_stats.hits++;
                 return 0;
             }
         }
@@ -2710,6 +2905,7 @@ static SDL_INLINE int Find_GlyphByIndex(TTF_Font *font, FT_UInt idx,
         }
 
         glyph->index = idx;
+        font->cache_stats.misses++;
         retval = Load_Glyph(font, glyph, want, 0);
         if (retval == 0) {
             return 0;
@@ -2750,6 +2946,8 @@ void TTF_CloseFont(TTF_Font *font)
         hb_font_destroy(font->hb_font);
 #endif
         Flush_Cache(font);
+        SDL_free(font->cache);
+        SDL_free(font->cache_table);
         if (font->face) {
             FT_Done_Face(font->face);
         }
@@ -2762,6 +2960,13 @@ void TTF_CloseFont(TTF_Font *font)
         if (font->pos_buf) {
             SDL_free(font->pos_buf);
         }
+        if (font->layout_cache) {
+            int i;
+            for (i = 0; i < LAYOUT_CACHE_SIZE; ++i) {
+                SDL_free(font->layout_cache[i].pos_buf);
+            }
+            SDL_free(font->layout_cache);
+        }
         SDL_free(font);
     }
 }
@@ -3153,6 +3358,139 @@ int TTF_SetFontScriptName(TTF_Font *font, const char *script)
 #endif
 }
 
+/* Whether a cached run was laid out with the font's current settings */
+static int Layout_Matches(const TTF_Font *font, const layout_run *run)
+{
+#if TTF_USE_HARFBUZZ
+    hb_direction_t hb_direction = font->hb_direction;
+    hb_script_t hb_script = font->hb_script;
+
+    if (hb_direction == HB_DIRECTION_INVALID) {
+        hb_direction = g_hb_direction;
+    }
+    if (hb_script == HB_SCRIPT_INVALID) {
+        hb_script = g_hb_script;
+    }
+    if (run->hb_direction != hb_direction || run->hb_script != hb_script) {
+        return 0;
+    }
+#endif
+    return run->generation == font->cache_generation &&
+           run->allow_kerning == font->allow_kerning;
+}
+
+/* Hash the text, returns 0 when it is too long to cache */
+static Uint32 Layout_Hash(const char *text, size_t *len)
+{
+    Uint32 hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; text[i]; ++i) {
+        if (i == LAYOUT_CACHE_MAX_TEXT) {
+            return 0;
+        }
+        hash = (hash ^ (Uint8)text[i]) * 16777619u;
+    }
+    *len = i;
+    return hash ? hash : 1;
+}
+
+/* Restore a cached layout into pos_buf and the size outputs, returns 0 on a hit */
+static int Layout_Lookup(TTF_Font *font, const char *text, size_t len, Uint32 hash,
+        int *w, int *h, int *xstart, int *ystart)
+{
+    layout_run *run = NULL;
+    int way;
+
+    if (!font->layout_cache) {
+        return -1;
+    }
+
+    for (way = 0; way < 2; ++way) {
+        layout_run *candidate = &font->layout_cache[(hash & (LAYOUT_CACHE_SIZE / 2 - 1)) * 2 + way];
+        if (candidate->stored && candidate->hash == hash && candidate->text_len == len &&
+            SDL_memcmp(candidate->text, text, len) == 0 && Layout_Matches(font, candidate)) {
+            run = candidate;
+            break;
+        }
+    }
+    if (!run) {
+        return -1;
+    }
+
+    if (run->pos_len > font->pos_max) {
+        PosBuf_t *pos_buf = (PosBuf_t *)SDL_realloc(font->pos_buf, run->pos_len * sizeof (font->pos_buf[0]));
+        if (!pos_buf) {
+            return -1;
+        }
+        font->pos_buf = pos_buf;
+        font->pos_max = run->pos_len;
+    }
+    SDL_memcpy(font->pos_buf, run->pos_buf, run->pos_len * sizeof (font->pos_buf[0]));
+    font->pos_len = run->pos_len;
+
+    if (w) {
+        *w = run->w;
+    }
+    if (h) {
+        *h = run->h;
+    }
+    if (xstart) {
+        *xstart = run->xstart;
+    }
+    if (ystart) {
+        *ystart = run->ystart;
+    }
+    run->last_used = ++font->layout_clock;
+    return 0;
+}
+
+/* Remember the layout just computed in pos_buf, replacing the older run of its set.
+ * A failure only means the string is laid out again next time. */
+static void Layout_Store(TTF_Font *font, const char *text, size_t len, Uint32 hash,
+        int w, int h, int xstart, int ystart)
+{
+    layout_run *set, *run;
+
+    if (!font->layout_cache) {
+        font->layout_cache = (layout_run *)SDL_calloc(LAYOUT_CACHE_SIZE, sizeof (layout_run));
+        if (!font->layout_cache) {
+            return;
+        }
+    }
+
+    set = &font->layout_cache[(hash & (LAYOUT_CACHE_SIZE / 2 - 1)) * 2];
+    run = (set[0].last_used <= set[1].last_used) ? &set[0] : &set[1];
+
+    if (font->pos_len > run->pos_max) {
+        PosBuf_t *pos_buf = (PosBuf_t *)SDL_realloc(run->pos_buf, font->pos_len * sizeof (font->pos_buf[0]));
+        if (!pos_buf) {
+            run->stored = 0;
+            return;
+        }
+        run->pos_buf = pos_buf;
+        run->pos_max = font->pos_len;
+    }
+    SDL_memcpy(run->pos_buf, font->pos_buf, font->pos_len * sizeof (font->pos_buf[0]));
+    run->pos_len = font->pos_len;
+
+    SDL_memcpy(run->text, text, len);
+    run->text_len = len;
+    run->hash = hash;
+    run->generation = font->cache_generation;
+    run->allow_kerning = font->allow_kerning;
+#if TTF_USE_HARFBUZZ
+    run->hb_direction = (font->hb_direction == HB_DIRECTION_INVALID) ? g_hb_direction : font->hb_direction;
+    run->hb_script = (font->hb_script == HB_SCRIPT_INVALID) ? g_hb_script : font->hb_script;
+#endif
+    run->w = w;
+    run->h = h;
+    run->xstart = xstart;
+    run->ystart = ystart;
+    run->last_used = ++font->layout_clock;
+    run->stored = 1;
+}
+
 static int TTF_Size_Internal(TTF_Font *font,
         const char *text, const str_type_t str_type,
         int *w, int *h, int *xstart, int *ystart,
@@ -3186,6 +3524,12 @@ static int TTF_Size_Internal(TTF_Font *font,
     int char_count = 0;
     int current_width = 0;
 
+    /* Layout cache, measurements are not cached */
+    const char *layout_text = NULL;     /* 'text' is advanced while decoding */
+    Uint32 layout_hash = 0;
+    size_t layout_len = 0;
+    int layout_w, layout_h, layout_xstart, layout_ystart;
+
     TTF_CHECK_INITIALIZED(-1);
     TTF_CHECK_POINTER(font, -1);
     TTF_CHECK_POINTER(text, -1);
@@ -3210,6 +3554,24 @@ static int TTF_Size_Internal(TTF_Font *font,
         text = (const char *)utf8_alloc;
     }
 
+    if (!measure_width) {
+        layout_text = text;
+        layout_hash = Layout_Hash(text, &layout_len);
+    }
+    if (layout_hash) {
+        if (Layout_Lookup(font, text, layout_len, layout_hash, w, h, xstart, ystart) == 0) {
+            if (utf8_alloc) {
+                SDL_stack_free(utf8_alloc);
+            }
+            return 0;
+        }
+        /* Always compute every output, so the run can be stored */
+        w = w ? w : &layout_w;
+        h = h ? h : &layout_h;
+        xstart = xstart ? xstart : &layout_xstart;
+        ystart = ystart ? ystart : &layout_ystart;
+    }
+
     maxy = font->height;
 
     /* Reset buffer */
@@ -3429,6 +3791,10 @@ static int TTF_Size_Internal(TTF_Font *font,
         }
     }
 
+    if (layout_hash) {
+        Layout_Store(font, layout_text, layout_len, layout_hash, *w, *h, *xstart, *ystart);
+    }
+
 #if TTF_USE_HARFBUZZ
     if (hb_buffer) {
         hb_buffer_destroy(hb_buffer);
@@ -4203,6 +4569,548 @@ SDL_bool TTF_GetFontSDF(const TTF_Font *font)
     return font->render_sdf;
 }
 
+int TTF_SetFontGlyphCacheSize(TTF_Font *font, int size)
+{
+    TTF_CHECK_POINTER(font, -1);
+    if (size < 1) {
+        return TTF_SetError("Invalid cache size");
+    }
+    return Alloc_Cache(font, size);
+}
+
+int TTF_GetFontGlyphCacheSize(const TTF_Font *font)
+{
+    TTF_CHECK_POINTER(font, -1);
+    return font->cache_size;
+}
+
+void TTF_GetFontGlyphCacheStats(const TTF_Font *font, TTF_GlyphCacheStats *stats)
+{
+    if (font && stats) {
+        *stats = font->cache_stats;
+        stats->cached = font->cache_used;
+    }
+}
+
+void TTF_ResetFontGlyphCacheStats(TTF_Font *font)
+{
+    if (font) {
+        SDL_zero(font->cache_stats);
+    }
+}
+
+/* Glyph atlas: glyph pixmaps are packed once into texture pages with a shelf
+ * packer, text is then drawn as textured quads from those pages. */
+
+/* Transparent border around each packed glyph, so linear filtering never
+ * samples a neighbour */
+#define ATLAS_PADDING   1
+
+/* Size of the opaque block used to draw underline and strikethrough */
+#define ATLAS_SOLID     3
+
+typedef struct {
+    int stored;
+    FT_UInt index;
+    int page;           /* -1 for a glyph without pixels, eg a space */
+    int x;              /* position in the page */
+    int y;
+    int width;
+    int rows;
+    int left;
+    int top;
+} atlas_glyph;
+
+typedef struct {
+    SDL_Texture *texture;
+    /* Shelf packer: glyphs are placed left to right on the current shelf,
+     * a new shelf starts below once a glyph does not fit */
+    int shelf_x;
+    int shelf_y;
+    int shelf_h;
+    /* Pending draw list, 4 vertices and 6 indices per quad */
+    SDL_Vertex *vertices;
+    int *indices;
+    int num_quads;
+    int max_quads;
+} atlas_page;
+
+struct TTF_Atlas {
+    SDL_Renderer *renderer;
+    TTF_Font *font;
+    Uint32 generation;      /* font->cache_generation the glyphs were packed for */
+    int page_size;
+    atlas_page *pages;
+    int num_pages;
+    /* Packed glyphs, open addressing on the glyph index */
+    atlas_glyph *glyphs;
+    int glyphs_size;        /* a power of two */
+    int glyphs_used;
+    atlas_glyph solid;      /* opaque block for underline and strikethrough */
+    Uint32 *upload;         /* scratch buffer to convert a pixmap to ARGB */
+    int upload_size;
+};
+
+static int Atlas_AddPage(TTF_Atlas *atlas)
+{
+    atlas_page *pages;
+    atlas_page *page;
+    Uint32 *zero;
+
+    pages = (atlas_page *)SDL_realloc(atlas->pages, (atlas->num_pages + 1) * sizeof (*pages));
+    if (!pages) {
+        return SDL_OutOfMemory();
+    }
+    atlas->pages = pages;
+
+    page = &pages[atlas->num_pages];
+    SDL_zerop(page);
+    page->texture = SDL_CreateTexture(atlas->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+                                      atlas->page_size, atlas->page_size);
+    if (!page->texture) {
+        return -1;
+    }
+    SDL_SetTextureBlendMode(page->texture, SDL_BLENDMODE_BLEND);
+
+    /* Static textures start undefined, clear the page once so padding is transparent */
+    zero = (Uint32 *)SDL_calloc((size_t)atlas->page_size * atlas->page_size, sizeof (Uint32));
+    if (!zero) {
+        SDL_DestroyTexture(page->texture);
+        return SDL_OutOfMemory();
+    }
+    SDL_UpdateTexture(page->texture, NULL, zero, atlas->page_size * sizeof (Uint32));
+    SDL_free(zero);
+
+    atlas->num_pages++;
+    return 0;
+}
+
+/* Find room for a width x rows block, adding a page if the last one is full */
+static int Atlas_Pack(TTF_Atlas *atlas, int width, int rows, atlas_glyph *glyph)
+{
+    const int w = width + 2 * ATLAS_PADDING;
+    const int h = rows + 2 * ATLAS_PADDING;
+    atlas_page *page;
+
+    if (w > atlas->page_size || h > atlas->page_size) {
+        return TTF_SetError("Glyph too large for atlas page");
+    }
+
+    if (atlas->num_pages == 0 && Atlas_AddPage(atlas) < 0) {
+        return -1;
+    }
+
+    page = &atlas->pages[atlas->num_pages - 1];
+    if (page->shelf_x + w > atlas->page_size) {
+        page->shelf_x = 0;
+        page->shelf_y += page->shelf_h;
+        page->shelf_h = 0;
+    }
+    if (page->shelf_y + h > atlas->page_size) {
+        if (Atlas_AddPage(atlas) < 0) {
+            return -1;
+        }
+        page = &atlas->pages[atlas->num_pages - 1];
+    }
+
+    glyph->page = atlas->num_pages - 1;
+    glyph->x = page->shelf_x + ATLAS_PADDING;
+    glyph->y = page->shelf_y + ATLAS_PADDING;
+    glyph->width = width;
+    glyph->rows = rows;
+
+    page->shelf_x += w;
+    if (h > page->shelf_h) {
+        page->shelf_h = h;
+    }
+    return 0;
+}
+
+/* Copy 8-bit coverage into the page as white with alpha, the vertex color tints it */
+static int Atlas_Upload(TTF_Atlas *atlas, const atlas_glyph *glyph, const Uint8 *src, int pitch)
+{
+    const int size = glyph->width * glyph->rows;
+    SDL_Rect rect;
+    Uint32 *dst;
+    int row, col;
+
+    if (size > atlas->upload_size) {
+        Uint32 *upload = (Uint32 *)SDL_realloc(atlas->upload, size * sizeof (Uint32));
+        if (!upload) {
+            return SDL_OutOfMemory();
+        }
+        atlas->upload = upload;
+        atlas->upload_size = size;
+    }
+
+    dst = atlas->upload;
+    for (row = 0; row < glyph->rows; ++row) {
+        for (col = 0; col < glyph->width; ++col) {
+            *dst++ = ((Uint32)src[col] << 24) | 0x00FFFFFF;
+        }
+        src += pitch;
+    }
+
+    rect.x = glyph->x;
+    rect.y = glyph->y;
+    rect.w = glyph->width;
+    rect.h = glyph->rows;
+    return SDL_UpdateTexture(atlas->pages[glyph->page].texture, &rect, atlas->upload, glyph->width * sizeof (Uint32));
+}
+
+static int Atlas_PackSolid(TTF_Atlas *atlas)
+{
+    Uint8 opaque[ATLAS_SOLID * ATLAS_SOLID];
+
+    SDL_memset(opaque, 0xFF, sizeof (opaque));
+    if (Atlas_Pack(atlas, ATLAS_SOLID, ATLAS_SOLID, &atlas->solid) < 0) {
+        return -1;
+    }
+    return Atlas_Upload(atlas, &atlas->solid, opaque, ATLAS_SOLID);
+}
+
+static void Atlas_FreePages(TTF_Atlas *atlas)
+{
+    int i;
+
+    for (i = 0; i < atlas->num_pages; ++i) {
+        SDL_DestroyTexture(atlas->pages[i].texture);
+        SDL_free(atlas->pages[i].vertices);
+        SDL_free(atlas->pages[i].indices);
+    }
+    atlas->num_pages = 0;
+}
+
+/* Forget every packed glyph. The pages are dropped too, reusing them would
+ * leave old glyphs behind in the padding of new ones. */
+static int Atlas_Reset(TTF_Atlas *atlas)
+{
+    Atlas_FreePages(atlas);
+
+    if (atlas->glyphs) {
+        SDL_memset(atlas->glyphs, 0, atlas->glyphs_size * sizeof (*atlas->glyphs));
+    }
+    atlas->glyphs_used = 0;
+    atlas->generation = atlas->font->cache_generation;
+    return Atlas_PackSolid(atlas);
+}
+
+static atlas_glyph *Atlas_Slot(atlas_glyph *glyphs, int size, FT_UInt idx)
+{
+    int slot = (int)(idx * 2654435761u) & (size - 1);
+
+    while (glyphs[slot].stored && glyphs[slot].index != idx) {
+        slot = (slot + 1) & (size - 1);
+    }
+    return &glyphs[slot];
+}
+
+/* Keep the table at most half full */
+static int Atlas_GrowGlyphs(TTF_Atlas *atlas)
+{
+    const int size = atlas->glyphs_size ? 2 * atlas->glyphs_size : 64;
+    atlas_glyph *glyphs;
+    int i;
+
+    glyphs = (atlas_glyph *)SDL_calloc(size, sizeof (*glyphs));
+    if (!glyphs) {
+        return SDL_OutOfMemory();
+    }
+    for (i = 0; i < atlas->glyphs_size; ++i) {
+        if (atlas->glyphs[i].stored) {
+            *Atlas_Slot(glyphs, size, atlas->glyphs[i].index) = atlas->glyphs[i];
+        }
+    }
+    SDL_free(atlas->glyphs);
+    atlas->glyphs = glyphs;
+    atlas->glyphs_size = size;
+    return 0;
+}
+
+/* Look up a glyph, rendering and packing it on first use */
+static int Atlas_GetGlyph(TTF_Atlas *atlas, FT_UInt idx, atlas_glyph **out_glyph)
+{
+    const int alignment = Get_Alignment() - 1;
+    atlas_glyph *glyph;
+    TTF_Image *image;
+
+    if (2 * (atlas->glyphs_used + 1) > atlas->glyphs_size && Atlas_GrowGlyphs(atlas) < 0) {
+        return -1;
+    }
+
+    glyph = Atlas_Slot(atlas->glyphs, atlas->glyphs_size, idx);
+    if (glyph->stored) {
+        *out_glyph = glyph;
+        return 0;
+    }
+
+    if (Find_GlyphByIndex(atlas->font, idx, 0, CACHED_PIXMAP, 0, 0, 0, 0, NULL, &image) < 0) {
+        return -1;
+    }
+
+    SDL_zerop(glyph);
+    glyph->index = idx;
+    glyph->page = -1;
+    glyph->left = image->left;
+    glyph->top = image->top;
+    if (image->width > 0 && image->rows > 0) {
+        if (Atlas_Pack(atlas, image->width, image->rows, glyph) < 0 ||
+            Atlas_Upload(atlas, glyph, image->buffer + alignment, image->pitch) < 0) {
+            return -1;
+        }
+    }
+    glyph->stored = 1;
+    atlas->glyphs_used++;
+
+    *out_glyph = glyph;
+    return 0;
+}
+
+/* Append a quad drawing the page area (sx, sy, sw, sh) at dst */
+static int Atlas_AddQuad(TTF_Atlas *atlas, int page_index, const SDL_FRect *dst,
+                         float sx, float sy, float sw, float sh, SDL_Color color)
+{
+    const float scale = 1.0f / atlas->page_size;
+    atlas_page *page = &atlas->pages[page_index];
+    SDL_Vertex *v;
+    int *i;
+    int base;
+
+    if (page->num_quads == page->max_quads) {
+        const int max_quads = page->max_quads ? 2 * page->max_quads : 64;
+        SDL_Vertex *vertices;
+        int *indices;
+
+        vertices = (SDL_Vertex *)SDL_realloc(page->vertices, max_quads * 4 * sizeof (*vertices));
+        if (!vertices) {
+            return SDL_OutOfMemory();
+        }
+        page->vertices = vertices;
+        indices = (int *)SDL_realloc(page->indices, max_quads * 6 * sizeof (*indices));
+        if (!indices) {
+            return SDL_OutOfMemory();
+        }
+        page->indices = indices;
+        page->max_quads = max_quads;
+    }
+
+    base = 4 * page->num_quads;
+    v = &page->vertices[base];
+    v[0].position.x = dst->x;
+    v[0].position.y = dst->y;
+    v[0].tex_coord.x = sx * scale;
+    v[0].tex_coord.y = sy * scale;
+    v[1].position.x = dst->x + dst->w;
+    v[1].position.y = dst->y;
+    v[1].tex_coord.x = (sx + sw) * scale;
+    v[1].tex_coord.y = sy * scale;
+    v[2].position.x = dst->x + dst->w;
+    v[2].position.y = dst->y + dst->h;
+    v[2].tex_coord.x = (sx + sw) * scale;
+    v[2].tex_coord.y = (sy + sh) * scale;
+    v[3].position.x = dst->x;
+    v[3].position.y = dst->y + dst->h;
+    v[3].tex_coord.x = sx * scale;
+    v[3].tex_coord.y = (sy + sh) * scale;
+    v[0].color = v[1].color = v[2].color = v[3].color = color;
+
+    i = &page->indices[6 * page->num_quads];
+    i[0] = base;
+    i[1] = base + 1;
+    i[2] = base + 2;
+    i[3] = base;
+    i[4] = base + 2;
+    i[5] = base + 3;
+
+    page->num_quads++;
+    return 0;
+}
+
+/* Draw a style line from the center texel of the solid block, so filtering stays opaque */
+static int Atlas_AddLine(TTF_Atlas *atlas, float x, float y, float w, float h, SDL_Color color)
+{
+    const SDL_FRect dst = { x, y, w, h };
+    const float center_x = atlas->solid.x + ATLAS_SOLID / 2 + 0.5f;
+    const float center_y = atlas->solid.y + ATLAS_SOLID / 2 + 0.5f;
+
+    return Atlas_AddQuad(atlas, atlas->solid.page, &dst, center_x, center_y, 0.0f, 0.0f, color);
+}
+
+TTF_Atlas *TTF_CreateAtlas(SDL_Renderer *renderer, TTF_Font *font, int page_size)
+{
+    TTF_Atlas *atlas;
+
+    TTF_CHECK_INITIALIZED(NULL);
+    TTF_CHECK_POINTER(renderer, NULL);
+    TTF_CHECK_POINTER(font, NULL);
+
+    if (page_size <= 0) {
+        page_size = TTF_ATLAS_DEFAULT_PAGE_SIZE;
+    }
+
+    atlas = (TTF_Atlas *)SDL_calloc(1, sizeof (*atlas));
+    if (!atlas) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    atlas->renderer = renderer;
+    atlas->font = font;
+    atlas->page_size = page_size;
+
+    if (Atlas_Reset(atlas) < 0) {
+        TTF_DestroyAtlas(atlas);
+        return NULL;
+    }
+    return atlas;
+}
+
+void TTF_DestroyAtlas(TTF_Atlas *atlas)
+{
+    if (!atlas) {
+        return;
+    }
+    Atlas_FreePages(atlas);
+    SDL_free(atlas->pages);
+    SDL_free(atlas->glyphs);
+    SDL_free(atlas->upload);
+    SDL_free(atlas);
+}
+
+int TTF_AddAtlasTextUTF8(TTF_Atlas *atlas, const char *text, const SDL_FRect *dstrect, SDL_Color fg)
+{
+    TTF_Font *font;
+    int xstart, ystart, width, height;
+    float scale_x = 1.0f, scale_y = 1.0f;
+    Uint32 i;
+
+    TTF_CHECK_INITIALIZED(-1);
+    TTF_CHECK_POINTER(atlas, -1);
+    TTF_CHECK_POINTER(text, -1);
+    TTF_CHECK_POINTER(dstrect, -1);
+
+    font = atlas->font;
+
+#if TTF_USE_SDF
+    /* The atlas holds coverage pixmaps, not distance fields */
+    if (font->render_sdf) {
+        return TTF_SetError("SDF fonts are not supported by the atlas");
+    }
+#endif
+
+    /* Size, style, outline or hinting changed since the glyphs were packed */
+    if (atlas->generation != font->cache_generation && Atlas_Reset(atlas) < 0) {
+        return -1;
+    }
+
+    if (TTF_Size_Internal(font, text, STR_UTF8, &width, &height, &xstart, &ystart, NO_MEASUREMENT) < 0) {
+        return -1;
+    }
+    if (width == 0 || height == 0) {
+        return 0;
+    }
+
+    /* Stretch the text box over dstrect, like SDL_RenderCopy would */
+    if (dstrect->w > 0.0f) {
+        scale_x = dstrect->w / width;
+    }
+    if (dstrect->h > 0.0f) {
+        scale_y = dstrect->h / height;
+    }
+
+    fg.a = fg.a ? fg.a : SDL_ALPHA_OPAQUE;
+
+    for (i = 0; i < font->pos_len; i++) {
+        atlas_glyph *glyph;
+        SDL_FRect dst;
+
+        if (Atlas_GetGlyph(atlas, font->pos_buf[i].index, &glyph) < 0) {
+            return -1;
+        }
+        if (glyph->page < 0) {
+            continue;
+        }
+
+        dst.x = dstrect->x + (xstart + FT_FLOOR(font->pos_buf[i].x) + glyph->left) * scale_x;
+        dst.y = dstrect->y + (ystart + FT_FLOOR(font->pos_buf[i].y) - glyph->top) * scale_y;
+        dst.w = glyph->width * scale_x;
+        dst.h = glyph->rows * scale_y;
+        if (Atlas_AddQuad(atlas, glyph->page, &dst, (float)glyph->x, (float)glyph->y,
+                          (float)glyph->width, (float)glyph->rows, fg) < 0) {
+            return -1;
+        }
+    }
+
+    if (TTF_HANDLE_STYLE_UNDERLINE(font) &&
+        Atlas_AddLine(atlas, dstrect->x, dstrect->y + (ystart + font->underline_top_row) * scale_y,
+                      width * scale_x, font->line_thickness * scale_y, fg) < 0) {
+        return -1;
+    }
+    if (TTF_HANDLE_STYLE_STRIKETHROUGH(font) &&
+        Atlas_AddLine(atlas, dstrect->x, dstrect->y + (ystart + font->strikethrough_top_row) * scale_y,
+                      width * scale_x, font->line_thickness * scale_y, fg) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int TTF_GetAtlasPageCount(const TTF_Atlas *atlas)
+{
+    TTF_CHECK_POINTER(atlas, -1);
+    return atlas->num_pages;
+}
+
+int TTF_GetAtlasDrawList(const TTF_Atlas *atlas, int page, TTF_AtlasDrawList *list)
+{
+    const atlas_page *p;
+
+    TTF_CHECK_POINTER(atlas, -1);
+    TTF_CHECK_POINTER(list, -1);
+
+    if (page < 0 || page >= atlas->num_pages) {
+        return TTF_SetError("Invalid atlas page");
+    }
+
+    p = &atlas->pages[page];
+    list->texture = p->texture;
+    list->vertices = p->vertices;
+    list->num_vertices = 4 * p->num_quads;
+    list->indices = p->indices;
+    list->num_indices = 6 * p->num_quads;
+    return 0;
+}
+
+void TTF_ClearAtlasDrawLists(TTF_Atlas *atlas)
+{
+    int i;
+
+    if (!atlas) {
+        return;
+    }
+    for (i = 0; i < atlas->num_pages; ++i) {
+        atlas->pages[i].num_quads = 0;
+    }
+}
+
+int TTF_RenderAtlas(TTF_Atlas *atlas)
+{
+    int retval = 0;
+    int i;
+
+    TTF_CHECK_POINTER(atlas, -1);
+
+    for (i = 0; i < atlas->num_pages; ++i) {
+        const atlas_page *page = &atlas->pages[i];
+        if (page->num_quads > 0 &&
+            SDL_RenderGeometry(atlas->renderer, page->texture,
+                               page->vertices, 4 * page->num_quads,
+                               page->indices, 6 * page->num_quads) < 0) {
+            retval = -1;
+        }
+    }
+    TTF_ClearAtlasDrawLists(atlas);
+    return retval;
+}
+
 void TTF_SetFontWrappedAlign(TTF_Font *font, int align)
 {
     TTF_CHECK_POINTER(font,);
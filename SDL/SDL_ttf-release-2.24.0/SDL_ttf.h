@@ -2216,6 +2216,244 @@ extern DECLSPEC int TTF_SetFontSDF(TTF_Font *font, SDL_bool on_off);
  */
 extern DECLSPEC SDL_bool TTF_GetFontSDF(const TTF_Font *font);
 
+/**
+ * Default number of glyphs cached per font.
+ *
+ * \sa TTF_SetFontGlyphCacheSize
+ */
+#define TTF_GLYPH_CACHE_DEFAULT_SIZE 512
+
+/**
+ * Glyph cache counters of a font.
+ *
+ * A hit is a glyph lookup served from the cache, a miss had to load and
+ * render the glyph with FreeType. An eviction dropped the least recently
+ * used glyph to make room for another one.
+ *
+ * \sa TTF_GetFontGlyphCacheStats
+ */
+typedef struct TTF_GlyphCacheStats
+{
+    Uint64 hits;
+    Uint64 misses;
+    Uint64 evictions;
+    int cached;         /**< Glyphs currently in the cache */
+} TTF_GlyphCacheStats;
+
+/**
+ * Set how many glyphs a font caches.
+ *
+ * The size is rounded up to a power of two. Glyphs are looked up by their
+ * index in a hash table, and once the cache is full the least recently used
+ * glyph is evicted. The default is TTF_GLYPH_CACHE_DEFAULT_SIZE.
+ *
+ * This clears already-generated glyphs, if any, from the cache.
+ *
+ * \param font the font to resize the cache of.
+ * \param size the number of glyphs to cache, at least 1.
+ * \returns 0 on success, -1 on error.
+ *
+ * \since This function is a local addition to the vendored SDL_ttf 2.24.0,
+ *        it is not part of upstream SDL_ttf.
+ *
+ * \sa TTF_GetFontGlyphCacheSize
+ * \sa TTF_GetFontGlyphCacheStats
+ */
+extern DECLSPEC int SDLCALL TTF_SetFontGlyphCacheSize(TTF_Font *font, int size);
+
+/**
+ * Query how many glyphs a font can cache.
+ *
+ * \param font the font to query.
+ * \returns the cache size in glyphs, or -1 on error.
+ *
+ * \since This function is a local addition to the vendored SDL_ttf 2.24.0,
+ *        it is not part of upstream SDL_ttf.
+ *
+ * \sa TTF_SetFontGlyphCacheSize
+ */
+extern DECLSPEC int SDLCALL TTF_GetFontGlyphCacheSize(const TTF_Font *font);
+
+/**
+ * Query the glyph cache counters of a font.
+ *
+ * The counters accumulate from when the font was opened or
+ * TTF_ResetFontGlyphCacheStats() was last called.
+ *
+ * \param font the font to query.
+ * \param stats filled in with the counters.
+ *
+ * \since This function is a local addition to the vendored SDL_ttf 2.24.0,
+ *        it is not part of upstream SDL_ttf.
+ *
+ * \sa TTF_ResetFontGlyphCacheStats
+ */
+extern DECLSPEC void SDLCALL TTF_GetFontGlyphCacheStats(const TTF_Font *font, TTF_GlyphCacheStats *stats);
+
+/**
+ * Reset the glyph cache counters of a font to zero.
+ *
+ * \param font the font to reset the counters of.
+ *
+ * \since This function is a local addition to the vendored SDL_ttf 2.24.0,
+ *        it is not part of upstream SDL_ttf.
+ *
+ * \sa TTF_GetFontGlyphCacheStats
+ */
+extern DECLSPEC void SDLCALL TTF_ResetFontGlyphCacheStats(TTF_Font *font);
+
+/**
+ * Default width and height of the texture pages of a glyph atlas.
+ *
+ * \sa TTF_CreateAtlas
+ */
+#define TTF_ATLAS_DEFAULT_PAGE_SIZE 512
+
+/**
+ * The internal structure containing a glyph atlas.
+ *
+ * An atlas packs the glyphs of one font into texture pages of one renderer
+ * as they are first used. Text is then drawn as textured quads from those
+ * pages, so drawing a string again costs no surface allocation and no
+ * texture upload.
+ *
+ * \sa TTF_CreateAtlas
+ */
+typedef struct TTF_Atlas TTF_Atlas;
+
+/**
+ * The pending quads of one atlas page.
+ *
+ * The arrays can be passed straight to SDL_RenderGeometry(). They belong to
+ * the atlas and stay valid until the next call that adds text to it, clears
+ * it or destroys it.
+ *
+ * \sa TTF_GetAtlasDrawList
+ */
+typedef struct TTF_AtlasDrawList
+{
+    SDL_Texture *texture;       /**< The page the quads sample from */
+    const SDL_Vertex *vertices; /**< 4 per quad */
+    int num_vertices;
+    const int *indices;         /**< 6 per quad, two triangles */
+    int num_indices;
+} TTF_AtlasDrawList;
+
+/**
+ * Create a glyph atlas for drawing text of a font with a renderer.
+ *
+ * Glyphs are rendered anti-aliased, as with TTF_RenderUTF8_Blended(), and
+ * stored as white with the coverage in alpha, the text color is applied
+ * through the vertex colors. Color glyphs are drawn in the text color.
+ *
+ * Changing the font's size, style, outline or hinting drops the packed
+ * glyphs and the pending quads on the next call that adds text. If the
+ * renderer loses its textures (SDL_RENDER_DEVICE_RESET), destroy the atlas
+ * and create a new one.
+ *
+ * \param renderer the renderer that owns the texture pages.
+ * \param font the font to draw text with, it must outlive the atlas.
+ * \param page_size width and height of each page in pixels, or 0 for
+ *                  TTF_ATLAS_DEFAULT_PAGE_SIZE.
+ * \returns a new atlas, or NULL on error.
+ *
+ * \since This function is a local addition to the vendored SDL_ttf 2.24.0,
+ *        it is not part of upstream SDL_ttf.
+ *
+ * \sa TTF_DestroyAtlas
+ * \sa TTF_AddAtlasTextUTF8
+ */
+extern DECLSPEC TTF_Atlas * SDLCALL TTF_CreateAtlas(SDL_Renderer *renderer, TTF_Font *font, int page_size);
+
+/**
+ * Dispose of an atlas and its texture pages.
+ *
+ * \param atlas the atlas to destroy, may be NULL.
+ *
+ * \since This function is a local addition to the vendored SDL_ttf 2.24.0,
+ *        it is not part of upstream SDL_ttf.
+ *
+ * \sa TTF_CreateAtlas
+ */
+extern DECLSPEC void SDLCALL TTF_DestroyAtlas(TTF_Atlas *atlas);
+
+/**
+ * Add the quads drawing UTF-8 text to the atlas' draw lists.
+ *
+ * Glyphs not packed yet are rendered and uploaded to a page once. The text
+ * box (as measured by TTF_SizeUTF8()) is placed at the top left of
+ * `dstrect`, and stretched over it when its width or height is positive.
+ * Fonts with SDF rendering enabled (TTF_SetFontSDF()) are not supported.
+ *
+ * \param atlas the atlas to draw with.
+ * \param text the text to draw, in UTF-8 encoding.
+ * \param dstrect where to draw the text.
+ * \param fg the foreground color for the text.
+ * \returns 0 on success, -1 on error.
+ *
+ * \since This function is a local addition to the vendored SDL_ttf 2.24.0,
+ *        it is not part of upstream SDL_ttf.
+ *
+ * \sa TTF_RenderAtlas
+ * \sa TTF_GetAtlasDrawList
+ */
+extern DECLSPEC int SDLCALL TTF_AddAtlasTextUTF8(TTF_Atlas *atlas, const char *text, const SDL_FRect *dstrect, SDL_Color fg);
+
+/**
+ * Query how many texture pages an atlas uses.
+ *
+ * \param atlas the atlas to query.
+ * \returns the number of pages, or -1 on error.
+ *
+ * \since This function is a local addition to the vendored SDL_ttf 2.24.0,
+ *        it is not part of upstream SDL_ttf.
+ *
+ * \sa TTF_GetAtlasDrawList
+ */
+extern DECLSPEC int SDLCALL TTF_GetAtlasPageCount(const TTF_Atlas *atlas);
+
+/**
+ * Get the pending quads of an atlas page, for submitting them with
+ * SDL_RenderGeometry() yourself.
+ *
+ * \param atlas the atlas to query.
+ * \param page the page, from 0 to TTF_GetAtlasPageCount() - 1.
+ * \param list filled in with the page's draw list.
+ * \returns 0 on success, -1 on error.
+ *
+ * \since This function is a local addition to the vendored SDL_ttf 2.24.0,
+ *        it is not part of upstream SDL_ttf.
+ *
+ * \sa TTF_ClearAtlasDrawLists
+ */
+extern DECLSPEC int SDLCALL TTF_GetAtlasDrawList(const TTF_Atlas *atlas, int page, TTF_AtlasDrawList *list);
+
+/**
+ * Drop the pending quads of every page, keeping the packed glyphs.
+ *
+ * \param atlas the atlas to clear.
+ *
+ * \since This function is a local addition to the vendored SDL_ttf 2.24.0,
+ *        it is not part of upstream SDL_ttf.
+ *
+ * \sa TTF_GetAtlasDrawList
+ */
+extern DECLSPEC void SDLCALL TTF_ClearAtlasDrawLists(TTF_Atlas *atlas);
+
+/**
+ * Draw the pending quads, one SDL_RenderGeometry() call per page that has
+ * any, and clear the draw lists.
+ *
+ * \param atlas the atlas to draw.
+ * \returns 0 on success, -1 on error.
+ *
+ * \since This function is a local addition to the vendored SDL_ttf 2.24.0,
+ *        it is not part of upstream SDL_ttf.
+ *
+ * \sa TTF_AddAtlasTextUTF8
+ */
+extern DECLSPEC int SDLCALL TTF_RenderAtlas(TTF_Atlas *atlas);
+
 /**
  * Report SDL_ttf errors
  *
@@ -0,0 +1,355 @@
+#ifdef TETRIS_ALLOC_PROFILE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+
+// Declared after the system headers so the real allocator is used in this file.
+#include "alloc_prof.h"
+#undef malloc
+#undef calloc
+#undef realloc
+#undef free
+
+/**************************************************************************
+** Config
+**************************************************************************/
+#define ALLOC_PROF_MAX_SITES    128     /**< Call sites tracked, later ones count as "other" */
+#define ALLOC_PROF_MAX_PHASES   16
+#define ALLOC_PROF_TOP_SITES    10      /**< Call sites listed in the report */
+
+/**************************************************************************
+** Structs
+**************************************************************************/
+
+/**
+ * Stored in front of every block so free knows how much it releases. The union keeps
+ * the returned pointer aligned like malloc's.
+ */
+typedef union AllocHeader
+{
+    struct
+    {
+        size_t      size;
+        int         site;
+    };
+    max_align_t     align;
+} AllocHeader;
+
+typedef struct AllocSite
+{
+    const char*     file;               /**< NULL for an unused slot */
+    int             line;
+    Uint64          count;
+    Uint64          bytes;
+} AllocSite;
+
+typedef struct AllocPhase
+{
+    const char*     name;
+    Uint64          count;
+    Uint64          bytes;
+} AllocPhase;
+
+/**************************************************************************
+** Global variables
+**************************************************************************/
+static SDL_SpinLock         Lock;
+static AllocSite            Sites[ ALLOC_PROF_MAX_SITES ];
+static AllocPhase           Phases[ ALLOC_PROF_MAX_PHASES ] = { { "other", 0, 0 } };
+static int                  PhaseCount = 1;
+static _Thread_local int    CurrentPhase;       /**< Every thread is in a phase of its own */
+
+static Uint64               TotalCount;
+static Uint64               TotalFrees;
+static size_t               LiveBytes;
+static size_t               PeakBytes;
+
+static Uint64               FrameCount;
+static _Thread_local Uint64 FrameAllocs;        /**< Allocations of this thread since its last frame */
+static Uint64               FrameTotal;         /**< Allocations of the thread marking frames */
+static Uint64               FramesWithAllocs;
+static Uint64               MaxFrameAllocs;
+
+static SDL_malloc_func      SdlMalloc   = malloc;
+static SDL_calloc_func      SdlCalloc   = calloc;
+static SDL_realloc_func     SdlRealloc  = realloc;
+static SDL_free_func        SdlFree     = free;
+
+/**************************************************************************
+** Bookkeeping, called with Lock held
+**************************************************************************/
+
+// Find or claim the slot of a call site. Sites are never removed, so pointer equality
+// on __FILE__ is enough in practice and a strcmp keeps it correct otherwise.
+static int
+findSite( const char* file, int line )
+{
+    unsigned int hash = (unsigned int) line * 2654435761u ^ (unsigned int) (uintptr_t) file;
+    for( int probe = 0; probe < ALLOC_PROF_MAX_SITES - 1; probe++ )
+    {
+        const int slot = (int) ( ( hash + probe ) % ( ALLOC_PROF_MAX_SITES - 1 ) );
+        AllocSite* site = &Sites[ slot ];
+        if( site->file == NULL )
+        {
+            site->file = file;
+            site->line = line;
+            return slot;
+        }
+        if( site->line == line && ( site->file == file || strcmp( site->file, file ) == 0 ) )
+        {
+            return slot;
+        }
+    }
+
+    // Table full, the last slot collects everything else.
+    Sites[ ALLOC_PROF_MAX_SITES - 1 ].file = "other";
+    return ALLOC_PROF_MAX_SITES - 1;
+}
+
+static void
+recordAlloc( AllocHeader* header, size_t size, const char* file, int line )
+{
+    SDL_AtomicLock( &Lock );
+
+    const int site = findSite( file, line );
+    header->size = size;
+    header->site = site;
+
+    Sites[ site ].count++;
+    Sites[ site ].bytes += size;
+    Phases[ CurrentPhase ].count++;
+    Phases[ CurrentPhase ].bytes += size;
+    TotalCount++;
+    FrameAllocs++;
+
+    LiveBytes += size;
+    if( LiveBytes > PeakBytes )
+    {
+        PeakBytes = LiveBytes;
+    }
+
+    SDL_AtomicUnlock( &Lock );
+}
+
+static void
+recordFree( const AllocHeader* header )
+{
+    SDL_AtomicLock( &Lock );
+    LiveBytes -= header->size;
+    TotalFrees++;
+    SDL_AtomicUnlock( &Lock );
+}
+
+/**************************************************************************
+** Allocator
+**************************************************************************/
+
+void*
+allocProfMalloc( size_t size, const char* file, int line )
+{
+    AllocHeader* header = SdlMalloc( sizeof( AllocHeader ) + size );
+    if( header == NULL )
+    {
+        return NULL;
+    }
+    recordAlloc( header, size, file, line );
+    return header + 1;
+}
+
+void*
+allocProfCalloc( size_t count, size_t size, const char* file, int line )
+{
+    if( size != 0 && count > ( SIZE_MAX - sizeof( AllocHeader ) ) / size )
+    {
+        return NULL;
+    }
+    void* ptr = allocProfMalloc( count * size, file, line );
+    if( ptr != NULL )
+    {
+        memset( ptr, 0, count * size );
+    }
+    return ptr;
+}
+
+void
+allocProfFree( void* ptr )
+{
+    if( ptr == NULL )
+    {
+        return;
+    }
+    AllocHeader* header = (AllocHeader*) ptr - 1;
+    recordFree( header );
+    SdlFree( header );
+}
+
+void*
+allocProfRealloc( void* ptr, size_t size, const char* file, int line )
+{
+    if( ptr == NULL )
+    {
+        return allocProfMalloc( size, file, line );
+    }
+
+    AllocHeader* old_header = (AllocHeader*) ptr - 1;
+    const AllocHeader old = *old_header;
+    AllocHeader* header = SdlRealloc( old_header, sizeof( AllocHeader ) + size );
+    if( header == NULL )
+    {
+        return NULL;
+    }
+
+    // A realloc is counted as a new allocation at its call site.
+    recordFree( &old );
+    recordAlloc( header, size, file, line );
+    return header + 1;
+}
+
+// SDL does not pass a call site, everything it (and SDL_ttf) allocates shares one.
+static void*
+sdlMalloc( size_t size )
+{
+    return allocProfMalloc( size, "SDL", 0 );
+}
+
+static void*
+sdlCalloc( size_t count, size_t size )
+{
+    return allocProfCalloc( count, size, "SDL", 0 );
+}
+
+static void*
+sdlRealloc( void* ptr, size_t size )
+{
+    return allocProfRealloc( ptr, size, "SDL", 0 );
+}
+
+/**************************************************************************
+** Public
+**************************************************************************/
+
+/*
+ * Route SDL's allocations through the profiler. Must run before anything is allocated,
+ * blocks from before the switch cannot be freed through the new functions.
+ */
+void
+allocProfInstall()
+{
+    SDL_GetOriginalMemoryFunctions( &SdlMalloc, &SdlCalloc, &SdlRealloc, &SdlFree );
+    SDL_SetMemoryFunctions( sdlMalloc, sdlCalloc, sdlRealloc, allocProfFree );
+}
+
+/*
+ * Attribute the following allocations of the calling thread to phase name (a string
+ * literal). NULL goes back to "other", where threads start out.
+ */
+void
+allocProfPhase( const char* name )
+{
+    SDL_AtomicLock( &Lock );
+
+    int phase = 0;
+    if( name != NULL )
+    {
+        for( phase = 1; phase < PhaseCount; phase++ )
+        {
+            if( strcmp( Phases[ phase ].name, name ) == 0 )
+            {
+                break;
+            }
+        }
+        if( phase == PhaseCount )
+        {
+            if( PhaseCount < ALLOC_PROF_MAX_PHASES )
+            {
+                Phases[ PhaseCount++ ].name = name;
+            } else
+            {
+                phase = 0;
+            }
+        }
+    }
+    CurrentPhase = phase;
+
+    SDL_AtomicUnlock( &Lock );
+}
+
+/*
+ * Mark the end of a frame. Only the calling thread's allocations count towards frames,
+ * so call it from the thread that renders.
+ */
+void
+allocProfFrame()
+{
+    SDL_AtomicLock( &Lock );
+    FrameCount++;
+    FrameTotal += FrameAllocs;
+    if( FrameAllocs > 0 )
+    {
+        FramesWithAllocs++;
+    }
+    if( FrameAllocs > MaxFrameAllocs )
+    {
+        MaxFrameAllocs = FrameAllocs;
+    }
+    FrameAllocs = 0;
+    SDL_AtomicUnlock( &Lock );
+}
+
+static int
+compareSites( const void* a, const void* b )
+{
+    const AllocSite* site_a = a;
+    const AllocSite* site_b = b;
+    if( site_a->count != site_b->count )
+    {
+        return site_a->count < site_b->count ? 1 : -1;
+    }
+    return 0;
+}
+
+/*
+ * Print the totals, the per-phase and per-frame counts and the busiest call sites.
+ */
+void
+allocProfReport()
+{
+    AllocSite sites[ ALLOC_PROF_MAX_SITES ];
+
+    SDL_AtomicLock( &Lock );
+    memcpy( sites, Sites, sizeof( sites ) );
+
+    printf( "Allocations: %llu allocs, %llu frees, %zu bytes live, %zu bytes peak\n",
+            (unsigned long long) TotalCount, (unsigned long long) TotalFrees, LiveBytes, PeakBytes );
+    printf( "Frames: %llu, %llu with allocations, at most %llu in one frame, %.2f per frame\n",
+            (unsigned long long) FrameCount,
+            (unsigned long long) FramesWithAllocs,
+            (unsigned long long) MaxFrameAllocs,
+            FrameCount > 0 ? (double) FrameTotal / (double) FrameCount : 0.0 );
+
+    printf( "Per phase:\n" );
+    for( int p = 0; p < PhaseCount; p++ )
+    {
+        printf( "  %-20s %10llu allocs %12llu bytes\n",
+                Phases[ p ].name,
+                (unsigned long long) Phases[ p ].count,
+                (unsigned long long) Phases[ p ].bytes );
+    }
+    SDL_AtomicUnlock( &Lock );
+
+    qsort( sites, ALLOC_PROF_MAX_SITES, sizeof( AllocSite ), compareSites );
+    printf( "Top call sites:\n" );
+    for( int s = 0; s < ALLOC_PROF_TOP_SITES && sites[ s ].count > 0; s++ )
+    {
+        char where[ 256 ];
+        snprintf( where, sizeof( where ), "%s:%d", sites[ s ].file, sites[ s ].line );
+        printf( "  %-40s %10llu allocs %12llu bytes\n",
+                where,
+                (unsigned long long) sites[ s ].count,
+                (unsigned long long) sites[ s ].bytes );
+    }
+}
+
+#endif // TETRIS_ALLOC_PROFILE
@@ -0,0 +1,64 @@
+#ifndef ALLOC_PROF_H
+#define ALLOC_PROF_H
+
+/**************************************************************************
+** Allocation profiler. Built when TETRIS_ALLOC_PROFILE is defined (the
+** TETRIS_ALLOC_PROFILE CMake option), otherwise every call below compiles
+** to nothing.
+**
+** SDL's allocator (and so SDL_ttf's) is replaced through
+** SDL_SetMemoryFunctions, and files that include this header after the
+** system headers have their malloc/calloc/realloc/free redirected here.
+** Allocations are counted per frame, per phase and per call site, along
+** with the bytes live and the peak. Phases are per thread, and frames only
+** count the allocations of the thread that marks them.
+**************************************************************************/
+
+#ifdef TETRIS_ALLOC_PROFILE
+
+#include <stddef.h>
+
+#define ALLOC_PROF_INSTALL()        allocProfInstall()
+#define ALLOC_PROF_PHASE( name )    allocProfPhase( name )
+#define ALLOC_PROF_FRAME()          allocProfFrame()
+#define ALLOC_PROF_REPORT()         allocProfReport()
+
+#define malloc( size )              allocProfMalloc( size, __FILE__, __LINE__ )
+#define calloc( count, size )       allocProfCalloc( count, size, __FILE__, __LINE__ )
+#define realloc( ptr, size )        allocProfRealloc( ptr, size, __FILE__, __LINE__ )
+#define free( ptr )                 allocProfFree( ptr )
+
+void
+allocProfInstall();
+
+void
+allocProfPhase( const char* name );
+
+void
+allocProfFrame();
+
+void
+allocProfReport();
+
+void*
+allocProfMalloc( size_t size, const char* file, int line );
+
+void*
+allocProfCalloc( size_t count, size_t size, const char* file, int line );
+
+void*
+allocProfRealloc( void* ptr, size_t size, const char* file, int line );
+
+void
+allocProfFree( void* ptr );
+
+#else
+
+#define ALLOC_PROF_INSTALL()
+#define ALLOC_PROF_PHASE( name )
+#define ALLOC_PROF_FRAME()
+#define ALLOC_PROF_REPORT()
+
+#endif // TETRIS_ALLOC_PROFILE
+
+#endif //ALLOC_PROF_H
@@ -0,0 +1,421 @@
+#include "board_eval.h"
+
+#include <SDL.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define EVAL_X86 1
+#include <immintrin.h>
+#endif
+
+// MSVC allows intrinsics for any instruction set, GCC and Clang need the function
+// to be compiled for the target first.
+#if defined(EVAL_X86) && ( defined(__GNUC__) || defined(__clang__) )
+#define EVAL_TARGET( isa ) __attribute__(( target( isa ) ))
+#else
+#define EVAL_TARGET( isa )
+#endif
+
+#if BOARD_HEIGHT == 32
+#define BOARD_MASK  0xFFFFFFFFu
+#else
+#define BOARD_MASK  ( ( 1u << BOARD_HEIGHT ) - 1 )
+#endif
+
+typedef void ( *EvalBoardsFunc )( const PackedBoard*, int, const EvalWeights*, float* );
+
+/**************************************************************************
+** Packing
+**************************************************************************/
+
+/*
+ * Convert a board matrix (indexed x, y) to its bit-per-cell form. A column of the matrix
+ * is contiguous, so it is read directly rather than cell by cell through matrixGet.
+ */
+void
+packBoard( const Matrix* board, PackedBoard* packed )
+{
+    for( int x = 0; x < BOARD_WIDTH; x++ )
+    {
+        const int* cells = board->content + x * board->cols;
+        uint32_t col = 0;
+        for( int y = 0; y < BOARD_HEIGHT; y++ )
+        {
+            col |= (uint32_t) ( cells[ y ] > 0 ) << y;
+        }
+        packed->cols[ x ] = col;
+    }
+}
+
+/**************************************************************************
+** Scalar reference path
+**************************************************************************/
+
+static int
+popCount32( uint32_t v )
+{
+    v = v - ( ( v >> 1 ) & 0x55555555u );
+    v = ( v & 0x33333333u ) + ( ( v >> 2 ) & 0x33333333u );
+    v = ( v + ( v >> 4 ) ) & 0x0F0F0F0Fu;
+    v = v + ( v >> 8 );
+    v = v + ( v >> 16 );
+    return (int) ( v & 0x3F );
+}
+
+// Set every bit below (higher y) the top-most filled cell of a column.
+static uint32_t
+smearDown( uint32_t col )
+{
+    col |= col << 1;
+    col |= col << 2;
+    col |= col << 4;
+    col |= col << 8;
+    col |= col << 16;
+    return col & BOARD_MASK;
+}
+
+void
+evalBoardFeatures( const PackedBoard* board, EvalFeatures* features )
+{
+    int heights[ BOARD_WIDTH ];
+
+    features->height = 0;
+    features->holes = 0;
+    features->bumpiness = 0;
+    features->wells = 0;
+    features->row_transitions = popCount32( ~board->cols[ 0 ] & BOARD_MASK ) +
+                                popCount32( ~board->cols[ BOARD_WIDTH - 1 ] & BOARD_MASK );
+
+    for( int x = 0; x < BOARD_WIDTH; x++ )
+    {
+        const uint32_t below = smearDown( board->cols[ x ] );
+        heights[ x ] = popCount32( below );
+        features->height += heights[ x ];
+        features->holes += popCount32( below & ~board->cols[ x ] );
+    }
+
+    for( int x = 0; x < BOARD_WIDTH - 1; x++ )
+    {
+        const int diff = heights[ x ] - heights[ x + 1 ];
+        features->bumpiness += diff < 0 ? -diff : diff;
+        features->row_transitions += popCount32( board->cols[ x ] ^ board->cols[ x + 1 ] );
+    }
+
+    for( int x = 0; x < BOARD_WIDTH; x++ )
+    {
+        const int left  = x > 0                 ? heights[ x - 1 ] : BOARD_HEIGHT;
+        const int right = x < BOARD_WIDTH - 1   ? heights[ x + 1 ] : BOARD_HEIGHT;
+        const int depth = ( left < right ? left : right ) - heights[ x ];
+        if( depth > 0 )
+        {
+            features->wells += depth;
+        }
+    }
+}
+
+/*
+ * Score boards one at a time. This is the reference the SIMD kernels are verified against
+ * and the fallback for CPUs without SSE2.
+ */
+void
+evalBoardsScalar( const PackedBoard* boards, int count, const EvalWeights* weights, float* scores )
+{
+    for( int i = 0; i < count; i++ )
+    {
+        EvalFeatures f;
+        evalBoardFeatures( &boards[ i ], &f );
+
+        float score = (float) f.height * weights->height;
+        score += (float) f.holes * weights->holes;
+        score += (float) f.bumpiness * weights->bumpiness;
+        score += (float) f.wells * weights->wells;
+        score += (float) f.row_transitions * weights->row_transitions;
+        scores[ i ] = score;
+    }
+}
+
+/**************************************************************************
+** SIMD kernels. Each lane holds one board, so a pass scores as many boards
+** as there are 32-bit lanes. Leftover boards go through the scalar path.
+**************************************************************************/
+#ifdef EVAL_X86
+
+EVAL_TARGET( "avx2" ) static inline __m256i
+popCountAVX2( __m256i v )
+{
+    const __m256i m1 = _mm256_set1_epi32( 0x55555555 );
+    const __m256i m2 = _mm256_set1_epi32( 0x33333333 );
+    const __m256i m4 = _mm256_set1_epi32( 0x0F0F0F0F );
+
+    v = _mm256_sub_epi32( v, _mm256_and_si256( _mm256_srli_epi32( v, 1 ), m1 ) );
+    v = _mm256_add_epi32( _mm256_and_si256( v, m2 ), _mm256_and_si256( _mm256_srli_epi32( v, 2 ), m2 ) );
+    v = _mm256_and_si256( _mm256_add_epi32( v, _mm256_srli_epi32( v, 4 ) ), m4 );
+    v = _mm256_add_epi32( v, _mm256_srli_epi32( v, 8 ) );
+    v = _mm256_add_epi32( v, _mm256_srli_epi32( v, 16 ) );
+    return _mm256_and_si256( v, _mm256_set1_epi32( 0x3F ) );
+}
+
+EVAL_TARGET( "avx2" ) static void
+evalBoardsAVX2( const PackedBoard* boards, int count, const EvalWeights* weights, float* scores )
+{
+    const __m256i mask   = _mm256_set1_epi32( BOARD_MASK );
+    const __m256i wall   = _mm256_set1_epi32( BOARD_HEIGHT );
+    const __m256i zero   = _mm256_setzero_si256();
+    const __m256i stride = _mm256_setr_epi32( 0,
+                                              1 * BOARD_WIDTH,
+                                              2 * BOARD_WIDTH,
+                                              3 * BOARD_WIDTH,
+                                              4 * BOARD_WIDTH,
+                                              5 * BOARD_WIDTH,
+                                              6 * BOARD_WIDTH,
+                                              7 * BOARD_WIDTH );
+    int i = 0;
+
+    for( ; i + EVAL_BATCH_AVX2 <= count; i += EVAL_BATCH_AVX2 )
+    {
+        __m256i cols[ BOARD_WIDTH ];
+        __m256i heights[ BOARD_WIDTH ];
+        __m256i height = zero;
+        __m256i holes = zero;
+        __m256i bumpiness = zero;
+        __m256i wells = zero;
+        __m256i transitions;
+
+        for( int x = 0; x < BOARD_WIDTH; x++ )
+        {
+            cols[ x ] = _mm256_i32gather_epi32( (const int*) &boards[ i ].cols[ x ], stride, 4 );
+
+            __m256i below = cols[ x ];
+            below = _mm256_or_si256( below, _mm256_slli_epi32( below, 1 ) );
+            below = _mm256_or_si256( below, _mm256_slli_epi32( below, 2 ) );
+            below = _mm256_or_si256( below, _mm256_slli_epi32( below, 4 ) );
+            below = _mm256_or_si256( below, _mm256_slli_epi32( below, 8 ) );
+            below = _mm256_or_si256( below, _mm256_slli_epi32( below, 16 ) );
+            below = _mm256_and_si256( below, mask );
+
+            heights[ x ] = popCountAVX2( below );
+            height = _mm256_add_epi32( height, heights[ x ] );
+            holes = _mm256_add_epi32( holes, popCountAVX2( _mm256_andnot_si256( cols[ x ], below ) ) );
+        }
+
+        transitions = _mm256_add_epi32( popCountAVX2( _mm256_andnot_si256( cols[ 0 ], mask ) ),
+                                        popCountAVX2( _mm256_andnot_si256( cols[ BOARD_WIDTH - 1 ], mask ) ) );
+
+        for( int x = 0; x < BOARD_WIDTH - 1; x++ )
+        {
+            const __m256i diff = _mm256_sub_epi32( heights[ x ], heights[ x + 1 ] );
+            bumpiness = _mm256_add_epi32( bumpiness, _mm256_abs_epi32( diff ) );
+            transitions = _mm256_add_epi32( transitions,
+                                            popCountAVX2( _mm256_xor_si256( cols[ x ], cols[ x + 1 ] ) ) );
+        }
+
+        for( int x = 0; x < BOARD_WIDTH; x++ )
+        {
+            const __m256i left  = x > 0                 ? heights[ x - 1 ] : wall;
+            const __m256i right = x < BOARD_WIDTH - 1   ? heights[ x + 1 ] : wall;
+            const __m256i depth = _mm256_sub_epi32( _mm256_min_epi32( left, right ), heights[ x ] );
+            wells = _mm256_add_epi32( wells, _mm256_max_epi32( depth, zero ) );
+        }
+
+        __m256 score = _mm256_mul_ps( _mm256_cvtepi32_ps( height ), _mm256_set1_ps( weights->height ) );
+        score = _mm256_add_ps( score, _mm256_mul_ps( _mm256_cvtepi32_ps( holes ),
+                                                     _mm256_set1_ps( weights->holes ) ) );
+        score = _mm256_add_ps( score, _mm256_mul_ps( _mm256_cvtepi32_ps( bumpiness ),
+                                                     _mm256_set1_ps( weights->bumpiness ) ) );
+        score = _mm256_add_ps( score, _mm256_mul_ps( _mm256_cvtepi32_ps( wells ),
+                                                     _mm256_set1_ps( weights->wells ) ) );
+        score = _mm256_add_ps( score, _mm256_mul_ps( _mm256_cvtepi32_ps( transitions ),
+                                                     _mm256_set1_ps( weights->row_transitions ) ) );
+        _mm256_storeu_ps( &scores[ i ], score );
+    }
+
+    evalBoardsScalar( &boards[ i ], count - i, weights, &scores[ i ] );
+}
+
+EVAL_TARGET( "sse2" ) static inline __m128i
+popCountSSE2( __m128i v )
+{
+    const __m128i m1 = _mm_set1_epi32( 0x55555555 );
+    const __m128i m2 = _mm_set1_epi32( 0x33333333 );
+    const __m128i m4 = _mm_set1_epi32( 0x0F0F0F0F );
+
+    v = _mm_sub_epi32( v, _mm_and_si128( _mm_srli_epi32( v, 1 ), m1 ) );
+    v = _mm_add_epi32( _mm_and_si128( v, m2 ), _mm_and_si128( _mm_srli_epi32( v, 2 ), m2 ) );
+    v = _mm_and_si128( _mm_add_epi32( v, _mm_srli_epi32( v, 4 ) ), m4 );
+    v = _mm_add_epi32( v, _mm_srli_epi32( v, 8 ) );
+    v = _mm_add_epi32( v, _mm_srli_epi32( v, 16 ) );
+    return _mm_and_si128( v, _mm_set1_epi32( 0x3F ) );
+}
+
+// SSE2 has no 32-bit abs/min/max, so these use the sign mask of the difference instead.
+// Heights are small, so the differences cannot overflow.
+EVAL_TARGET( "sse2" ) static void
+evalBoardsSSE2( const PackedBoard* boards, int count, const EvalWeights* weights, float* scores )
+{
+    const __m128i mask = _mm_set1_epi32( BOARD_MASK );
+    const __m128i wall = _mm_set1_epi32( BOARD_HEIGHT );
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+
+    for( ; i + EVAL_BATCH_SSE2 <= count; i += EVAL_BATCH_SSE2 )
+    {
+        __m128i cols[ BOARD_WIDTH ];
+        __m128i heights[ BOARD_WIDTH ];
+        __m128i height = zero;
+        __m128i holes = zero;
+        __m128i bumpiness = zero;
+        __m128i wells = zero;
+        __m128i transitions;
+
+        for( int x = 0; x < BOARD_WIDTH; x++ )
+        {
+            cols[ x ] = _mm_setr_epi32( (int) boards[ i ].cols[ x ],
+                                        (int) boards[ i + 1 ].cols[ x ],
+                                        (int) boards[ i + 2 ].cols[ x ],
+                                        (int) boards[ i + 3 ].cols[ x ] );
+
+            __m128i below = cols[ x ];
+            below = _mm_or_si128( below, _mm_slli_epi32( below, 1 ) );
+            below = _mm_or_si128( below, _mm_slli_epi32( below, 2 ) );
+            below = _mm_or_si128( below, _mm_slli_epi32( below, 4 ) );
+            below = _mm_or_si128( below, _mm_slli_epi32( below, 8 ) );
+            below = _mm_or_si128( below, _mm_slli_epi32( below, 16 ) );
+            below = _mm_and_si128( below, mask );
+
+            heights[ x ] = popCountSSE2( below );
+            height = _mm_add_epi32( height, heights[ x ] );
+            holes = _mm_add_epi32( holes, popCountSSE2( _mm_andnot_si128( cols[ x ], below ) ) );
+        }
+
+        transitions = _mm_add_epi32( popCountSSE2( _mm_andnot_si128( cols[ 0 ], mask ) ),
+                                     popCountSSE2( _mm_andnot_si128( cols[ BOARD_WIDTH - 1 ], mask ) ) );
+
+        for( int x = 0; x < BOARD_WIDTH - 1; x++ )
+        {
+            const __m128i diff = _mm_sub_epi32( heights[ x ], heights[ x + 1 ] );
+            const __m128i sign = _mm_srai_epi32( diff, 31 );
+            bumpiness = _mm_add_epi32( bumpiness, _mm_sub_epi32( _mm_xor_si128( diff, sign ), sign ) );
+            transitions = _mm_add_epi32( transitions,
+                                         popCountSSE2( _mm_xor_si128( cols[ x ], cols[ x + 1 ] ) ) );
+        }
+
+        for( int x = 0; x < BOARD_WIDTH; x++ )
+        {
+            const __m128i left  = x > 0                 ? heights[ x - 1 ] : wall;
+            const __m128i right = x < BOARD_WIDTH - 1   ? heights[ x + 1 ] : wall;
+            const __m128i diff  = _mm_sub_epi32( left, right );
+            const __m128i low   = _mm_add_epi32( right, _mm_and_si128( diff, _mm_srai_epi32( diff, 31 ) ) );
+            const __m128i depth = _mm_sub_epi32( low, heights[ x ] );
+            wells = _mm_add_epi32( wells, _mm_andnot_si128( _mm_srai_epi32( depth, 31 ), depth ) );
+        }
+
+        __m128 score = _mm_mul_ps( _mm_cvtepi32_ps( height ), _mm_set1_ps( weights->height ) );
+        score = _mm_add_ps( score, _mm_mul_ps( _mm_cvtepi32_ps( holes ),
+                                               _mm_set1_ps( weights->holes ) ) );
+        score = _mm_add_ps( score, _mm_mul_ps( _mm_cvtepi32_ps( bumpiness ),
+                                               _mm_set1_ps( weights->bumpiness ) ) );
+        score = _mm_add_ps( score, _mm_mul_ps( _mm_cvtepi32_ps( wells ),
+                                               _mm_set1_ps( weights->wells ) ) );
+        score = _mm_add_ps( score, _mm_mul_ps( _mm_cvtepi32_ps( transitions ),
+                                               _mm_set1_ps( weights->row_transitions ) ) );
+        _mm_storeu_ps( &scores[ i ], score );
+    }
+
+    evalBoardsScalar( &boards[ i ], count - i, weights, &scores[ i ] );
+}
+
+#endif // EVAL_X86
+
+/**************************************************************************
+** Runtime dispatch
+**************************************************************************/
+
+static SDL_atomic_t EvalKernel;     /**< 0 = not selected yet, then 1 + index in EVAL_KERNELS */
+
+static const struct
+{
+    const char*     name;
+    EvalBoardsFunc  func;
+} EVAL_KERNELS[] =
+{
+    { "scalar", evalBoardsScalar },
+#ifdef EVAL_X86
+    { "sse2",   evalBoardsSSE2 },
+    { "avx2",   evalBoardsAVX2 },
+#endif
+};
+
+// The kernels are ordered by width, a CPU that runs one also runs those before it.
+static int
+widestEvalKernel()
+{
+#ifdef EVAL_X86
+    if( SDL_HasAVX2() )
+    {
+        return 2;
+    }
+    if( SDL_HasSSE2() )
+    {
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+static int
+selectEvalKernel()
+{
+    int kernel = SDL_AtomicGet( &EvalKernel );
+    if( kernel > 0 )
+    {
+        return kernel - 1;
+    }
+
+    kernel = widestEvalKernel();
+    SDL_AtomicSet( &EvalKernel, kernel + 1 );
+    return kernel;
+}
+
+/*
+ * Score count boards into scores using the widest kernel the CPU supports. Results are
+ * identical to evalBoardsScalar.
+ */
+void
+evalBoards( const PackedBoard* boards, int count, const EvalWeights* weights, float* scores )
+{
+    EVAL_KERNELS[ selectEvalKernel() ].func( boards, count, weights, scores );
+}
+
+/*
+ * Make evalBoards use the kernel called name ("scalar", "sse2" or "avx2"), or the widest
+ * one the CPU supports again when name is NULL. Returns false, and keeps the current
+ * kernel, when there is no such kernel or the CPU cannot run it.
+ */
+bool
+evalBoardsSetKernel( const char* name )
+{
+    if( name == NULL )
+    {
+        SDL_AtomicSet( &EvalKernel, 0 );
+        return true;
+    }
+
+    const int count = (int) SDL_arraysize( EVAL_KERNELS );
+    for( int kernel = 0; kernel < count && kernel <= widestEvalKernel(); kernel++ )
+    {
+        if( SDL_strcmp( EVAL_KERNELS[ kernel ].name, name ) == 0 )
+        {
+            SDL_AtomicSet( &EvalKernel, kernel + 1 );
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Name of the kernel evalBoards dispatches to.
+ */
+const char*
+evalBoardsKernelName()
+{
+    return EVAL_KERNELS[ selectEvalKernel() ].name;
+}
@@ -0,0 +1,71 @@
+#ifndef BOARD_EVAL_H
+#define BOARD_EVAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+#include "matrix.h"
+
+/**************************************************************************
+** Packed board
+**************************************************************************/
+
+/**
+ * Copy of a board with one bit per cell, stored per column: bit y of cols[ x ] is set
+ * when cell (x, y) is filled. Row 0 is the top of the board.
+ */
+typedef struct PackedBoard
+{
+    uint32_t    cols[ BOARD_WIDTH ];
+} PackedBoard;
+
+_Static_assert( BOARD_HEIGHT <= 32, "PackedBoard stores a column in 32 bits" );
+
+/**************************************************************************
+** Evaluation
+**************************************************************************/
+
+/**
+ * Weights applied to the board features. Every feature is a penalty, so weights
+ * are normally negative and a higher score means a better board.
+ */
+typedef struct EvalWeights
+{
+    float   height;             /**< Sum of all column heights */
+    float   holes;              /**< Empty cells with a filled cell above them */
+    float   bumpiness;          /**< Sum of height differences between neighbouring columns */
+    float   wells;              /**< Sum of well depths (walls count as full columns) */
+    float   row_transitions;    /**< Filled/empty changes along each row (walls count as filled) */
+} EvalWeights;
+
+typedef struct EvalFeatures
+{
+    int     height;
+    int     holes;
+    int     bumpiness;
+    int     wells;
+    int     row_transitions;
+} EvalFeatures;
+
+#define EVAL_BATCH_AVX2     8   /**< Boards scored per pass by the AVX2 kernel */
+#define EVAL_BATCH_SSE2     4   /**< Boards scored per pass by the SSE2 kernel */
+
+void
+packBoard( const Matrix* board, PackedBoard* packed );
+
+void
+evalBoardFeatures( const PackedBoard* board, EvalFeatures* features );
+
+void
+evalBoardsScalar( const PackedBoard* boards, int count, const EvalWeights* weights, float* scores );
+
+void
+evalBoards( const PackedBoard* boards, int count, const EvalWeights* weights, float* scores );
+
+bool
+evalBoardsSetKernel( const char* name );
+
+const char*
+evalBoardsKernelName();
+
+#endif //BOARD_EVAL_H
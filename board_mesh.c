@@ -0,0 +1,96 @@
+#include "board_mesh.h"
+
+/*
+ * Create a mesh of width by height cells of cell_size pixels, cell_padding apart, with
+ * its top left corner at (x, y). Every cell starts out transparent black.
+ */
+BoardMesh*
+boardMeshCreate( int width, int height, float x, float y, float cell_size, float cell_padding )
+{
+    BoardMesh* mesh = SDL_calloc( 1, sizeof( BoardMesh ) );
+    if( mesh == NULL )
+    {
+        return NULL;
+    }
+
+    const int cells = width * height;
+    mesh->width = width;
+    mesh->height = height;
+    mesh->vertices = SDL_calloc( (size_t) cells * 4, sizeof( SDL_Vertex ) );
+    mesh->indices = SDL_calloc( (size_t) cells * 6, sizeof( int ) );
+    if( mesh->vertices == NULL || mesh->indices == NULL )
+    {
+        boardMeshDestroy( mesh );
+        return NULL;
+    }
+
+    for( int j = 0; j < height; j++ )
+    {
+        for( int i = 0; i < width; i++ )
+        {
+            const int cell = j * width + i;
+            const float left = x + i * ( cell_size + cell_padding );
+            const float top = y + j * ( cell_size + cell_padding );
+            SDL_Vertex* quad = &mesh->vertices[ cell * 4 ];
+            int* triangles = &mesh->indices[ cell * 6 ];
+
+            quad[ 0 ].position = (SDL_FPoint){ left, top };
+            quad[ 1 ].position = (SDL_FPoint){ left + cell_size, top };
+            quad[ 2 ].position = (SDL_FPoint){ left + cell_size, top + cell_size };
+            quad[ 3 ].position = (SDL_FPoint){ left, top + cell_size };
+
+            triangles[ 0 ] = cell * 4;
+            triangles[ 1 ] = cell * 4 + 1;
+            triangles[ 2 ] = cell * 4 + 2;
+            triangles[ 3 ] = cell * 4;
+            triangles[ 4 ] = cell * 4 + 2;
+            triangles[ 5 ] = cell * 4 + 3;
+        }
+    }
+
+    return mesh;
+}
+
+void
+boardMeshDestroy( BoardMesh* mesh )
+{
+    if( mesh == NULL )
+    {
+        return;
+    }
+    SDL_free( mesh->vertices );
+    SDL_free( mesh->indices );
+    SDL_free( mesh );
+}
+
+/*
+ * Color the cell at i (column) and j (row). Cells outside the mesh are ignored.
+ */
+void
+boardMeshSetCell( BoardMesh* mesh, int i, int j, SDL_Color color )
+{
+    if( i < 0 || i >= mesh->width || j < 0 || j >= mesh->height )
+    {
+        return;
+    }
+
+    SDL_Vertex* quad = &mesh->vertices[ ( j * mesh->width + i ) * 4 ];
+    if( SDL_memcmp( &quad[ 0 ].color, &color, sizeof( SDL_Color ) ) == 0 )
+    {
+        return;
+    }
+    for( int v = 0; v < 4; v++ )
+    {
+        quad[ v ].color = color;
+    }
+}
+
+/*
+ * Queue every cell as one geometry command.
+ */
+int
+boardMeshDraw( const BoardMesh* mesh, SDL_Renderer* renderer )
+{
+    const int cells = mesh->width * mesh->height;
+    return SDL_RenderGeometry( renderer, NULL, mesh->vertices, cells * 4, mesh->indices, cells * 6 );
+}
@@ -0,0 +1,35 @@
+#ifndef BOARD_MESH_H
+#define BOARD_MESH_H
+
+#include <stdbool.h>
+#include <SDL.h>
+
+/**************************************************************************
+** A grid of cells drawn with a single SDL_RenderGeometry call. Every cell
+** is a quad of 4 vertices and 6 indices. Positions and indices are built
+** once; setting a cell's color rewrites only its 4 vertex colors, and only
+** when the color changed. The cost of drawing the board no longer depends
+** on its size.
+**************************************************************************/
+
+typedef struct BoardMesh
+{
+    int             width;              /**< Cells per row */
+    int             height;             /**< Rows */
+    SDL_Vertex*     vertices;           /**< [ height ][ width ][ 4 ] */
+    int*            indices;            /**< [ height ][ width ][ 6 ] */
+} BoardMesh;
+
+BoardMesh*
+boardMeshCreate( int width, int height, float x, float y, float cell_size, float cell_padding );
+
+void
+boardMeshDestroy( BoardMesh* mesh );
+
+void
+boardMeshSetCell( BoardMesh* mesh, int i, int j, SDL_Color color );
+
+int
+boardMeshDraw( const BoardMesh* mesh, SDL_Renderer* renderer );
+
+#endif //BOARD_MESH_H
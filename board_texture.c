@@ -0,0 +1,157 @@
+#include "board_texture.h"
+
+#include <stdbool.h>
+
+static Uint32
+toTexel( SDL_Color color )
+{
+    return (Uint32) color.a << 24 | (Uint32) color.r << 16 | (Uint32) color.g << 8 | color.b;
+}
+
+// The overlay is drawn once: every cell covers cell_size + cell_padding pixels of the
+// scaled texture, and its last cell_padding columns and rows are painted over.
+static SDL_Texture*
+createGrid( SDL_Renderer* renderer, int width, int height, int cell_size, int cell_padding, SDL_Color color )
+{
+    const int stride = cell_size + cell_padding;
+    const int pixel_width = width * stride;
+    const int pixel_height = height * stride;
+    Uint32* pixels = SDL_malloc( (size_t) pixel_width * pixel_height * sizeof( Uint32 ) );
+    if( pixels == NULL )
+    {
+        return NULL;
+    }
+
+    const Uint32 line = toTexel( color );
+    for( int y = 0; y < pixel_height; y++ )
+    {
+        for( int x = 0; x < pixel_width; x++ )
+        {
+            const bool padding = x % stride >= cell_size || y % stride >= cell_size;
+            pixels[ y * pixel_width + x ] = padding ? line : 0;
+        }
+    }
+
+    SDL_Texture* grid = SDL_CreateTexture( renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+                                           pixel_width, pixel_height );
+    if( grid != NULL )
+    {
+        SDL_UpdateTexture( grid, NULL, pixels, pixel_width * (int) sizeof( Uint32 ) );
+        SDL_SetTextureBlendMode( grid, SDL_BLENDMODE_BLEND );
+    }
+    SDL_free( pixels );
+    return grid;
+}
+
+/*
+ * Create a board of width by height cells of cell_size pixels with its top left corner
+ * at (x, y). The cell_padding pixels between cells are drawn in padding_color, which
+ * should be the background. Every cell starts out transparent black.
+ */
+BoardTexture*
+boardTextureCreate( SDL_Renderer* renderer, int width, int height, int x, int y,
+                    int cell_size, int cell_padding, SDL_Color padding_color )
+{
+    BoardTexture* board = SDL_calloc( 1, sizeof( BoardTexture ) );
+    if( board == NULL )
+    {
+        return NULL;
+    }
+
+    board->width = width;
+    board->height = height;
+    board->destination = (SDL_Rect){ x, y, width * ( cell_size + cell_padding ), height * ( cell_size + cell_padding ) };
+    board->texels = SDL_calloc( (size_t) width * height, sizeof( Uint32 ) );
+    board->cells = SDL_CreateTexture( renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height );
+    board->grid = cell_padding > 0 ? createGrid( renderer, width, height, cell_size, cell_padding, padding_color ) : NULL;
+    if( board->texels == NULL || board->cells == NULL || ( cell_padding > 0 && board->grid == NULL ) )
+    {
+        boardTextureDestroy( board );
+        return NULL;
+    }
+
+    SDL_SetTextureScaleMode( board->cells, SDL_ScaleModeNearest );
+    SDL_SetTextureBlendMode( board->cells, SDL_BLENDMODE_NONE );
+    board->dirty = (SDL_Rect){ 0, 0, width, height };
+    return board;
+}
+
+void
+boardTextureDestroy( BoardTexture* board )
+{
+    if( board == NULL )
+    {
+        return;
+    }
+    if( board->cells != NULL )
+    {
+        SDL_DestroyTexture( board->cells );
+    }
+    if( board->grid != NULL )
+    {
+        SDL_DestroyTexture( board->grid );
+    }
+    SDL_free( board->texels );
+    SDL_free( board );
+}
+
+/*
+ * Color the cell at i (column) and j (row). Cells outside the board are ignored.
+ */
+void
+boardTextureSetCell( BoardTexture* board, int i, int j, SDL_Color color )
+{
+    if( i < 0 || i >= board->width || j < 0 || j >= board->height )
+    {
+        return;
+    }
+
+    const Uint32 texel = toTexel( color );
+    Uint32* current = &board->texels[ j * board->width + i ];
+    if( *current == texel )
+    {
+        return;
+    }
+    *current = texel;
+
+    const SDL_Rect cell = { i, j, 1, 1 };
+    if( board->dirty.w == 0 )
+    {
+        board->dirty = cell;
+    } else
+    {
+        SDL_UnionRect( &board->dirty, &cell, &board->dirty );
+    }
+}
+
+/*
+ * Upload the changed texels and draw the board.
+ */
+int
+boardTextureDraw( BoardTexture* board, SDL_Renderer* renderer )
+{
+    if( board->dirty.w > 0 )
+    {
+        // A locked region must be written in full, so every row of the dirty rectangle
+        // is copied from the shadow.
+        void* pixels;
+        int pitch;
+        if( SDL_LockTexture( board->cells, &board->dirty, &pixels, &pitch ) == 0 )
+        {
+            for( int row = 0; row < board->dirty.h; row++ )
+            {
+                SDL_memcpy( (Uint8*) pixels + (size_t) row * pitch,
+                            &board->texels[ ( board->dirty.y + row ) * board->width + board->dirty.x ],
+                            (size_t) board->dirty.w * sizeof( Uint32 ) );
+            }
+            SDL_UnlockTexture( board->cells );
+            board->dirty.w = 0;
+        }
+    }
+
+    if( SDL_RenderCopy( renderer, board->cells, NULL, &board->destination ) < 0 )
+    {
+        return -1;
+    }
+    return board->grid != NULL ? SDL_RenderCopy( renderer, board->grid, NULL, &board->destination ) : 0;
+}
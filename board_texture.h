@@ -0,0 +1,39 @@
+#ifndef BOARD_TEXTURE_H
+#define BOARD_TEXTURE_H
+
+#include <SDL.h>
+
+/**************************************************************************
+** A grid of cells drawn from a streaming texture with one texel per cell,
+** scaled up with nearest filtering, with a grid overlay texture on top for
+** the padding between cells. Drawing costs two SDL_RenderCopy calls for
+** any board size. Cell colors are kept in a shadow copy, and only the
+** rectangle of texels that changed since the last draw is uploaded, so
+** the upload cost follows the changes and not the board's area.
+**************************************************************************/
+
+typedef struct BoardTexture
+{
+    int             width;              /**< Cells per row */
+    int             height;             /**< Rows */
+    SDL_Texture*    cells;              /**< width x height, one texel per cell */
+    SDL_Texture*    grid;               /**< Padding lines, transparent over the cells */
+    SDL_Rect        destination;
+    Uint32*         texels;             /**< Shadow copy of cells, [ height ][ width ] ARGB8888 */
+    SDL_Rect        dirty;              /**< Texels changed since the last upload, empty when w is 0 */
+} BoardTexture;
+
+BoardTexture*
+boardTextureCreate( SDL_Renderer* renderer, int width, int height, int x, int y,
+                    int cell_size, int cell_padding, SDL_Color padding_color );
+
+void
+boardTextureDestroy( BoardTexture* board );
+
+void
+boardTextureSetCell( BoardTexture* board, int i, int j, SDL_Color color );
+
+int
+boardTextureDraw( BoardTexture* board, SDL_Renderer* renderer );
+
+#endif //BOARD_TEXTURE_H
@@ -0,0 +1,273 @@
+#include "bot.h"
+
+#include <float.h>
+#include <stddef.h>
+
+// Cell offsets of every shape and rotation relative to the pivot point, taken from
+// getLocalShapeCells so the bot always agrees with the game.
+static int SHAPE_OFFSETS[ 7 ][ 4 ][ 4 ][ 2 ];
+
+// Weights found by tetris_tuner, a sensible starting point for search and autoplay.
+const BotWeights BOT_DEFAULT_WEIGHTS = { { -0.51f, -0.36f, -0.18f, -0.05f, -0.10f }, 0.76f };
+
+/*
+ * Build the shape offset table. Must be called once before the bot is used.
+ */
+void
+botInit()
+{
+    for( TETRIS_SHAPE shape = 0; shape < 7; shape++ )
+    {
+        for( TETRIS_ROT rot = 0; rot < 4; rot++ )
+        {
+            Matrix* coords = getLocalShapeCells( shape, 0, 0, rot );
+            for( int coord = 0; coord < coords->rows; coord++ )
+            {
+                SHAPE_OFFSETS[ shape ][ rot ][ coord ][ 0 ] = matrixGet( coords, coord, 0 );
+                SHAPE_OFFSETS[ shape ][ rot ][ coord ][ 1 ] = matrixGet( coords, coord, 1 );
+            }
+            matrixFree( coords );
+        }
+    }
+}
+
+// Same rules as validateShape, on a packed board.
+static bool
+fits( const PackedBoard* board, TETRIS_SHAPE shape, TETRIS_ROT rot, int x, int y )
+{
+    for( int cell = 0; cell < 4; cell++ )
+    {
+        const int cx = x + SHAPE_OFFSETS[ shape ][ rot ][ cell ][ 0 ];
+        const int cy = y + SHAPE_OFFSETS[ shape ][ rot ][ cell ][ 1 ];
+
+        if( cx < 0 || cx > BOARD_WIDTH - 1 || cy > BOARD_HEIGHT - 1 )
+        {
+            return false;
+        }
+        if( cy >= 0 && ( board->cols[ cx ] >> cy ) & 1u )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Freeze the shape into the board and remove full rows. Returns the number of rows
+// cleared, or -1 when the shape sticks out above the board.
+static int
+place( PackedBoard* board, TETRIS_SHAPE shape, TETRIS_ROT rot, int x, int y )
+{
+    uint32_t full = 0xFFFFFFFFu;
+    int lines = 0;
+
+    for( int cell = 0; cell < 4; cell++ )
+    {
+        const int cx = x + SHAPE_OFFSETS[ shape ][ rot ][ cell ][ 0 ];
+        const int cy = y + SHAPE_OFFSETS[ shape ][ rot ][ cell ][ 1 ];
+        if( cy < 0 )
+        {
+            return -1;
+        }
+        board->cols[ cx ] |= 1u << cy;
+    }
+
+    for( int col = 0; col < BOARD_WIDTH; col++ )
+    {
+        full &= board->cols[ col ];
+    }
+
+    // Removing a row only moves the rows above it (lower y), so full rows can be
+    // removed from the top down without updating the mask.
+    for( int row = 0; row < BOARD_HEIGHT; row++ )
+    {
+        if( !( ( full >> row ) & 1u ) )
+        {
+            continue;
+        }
+
+        const uint32_t above = ( 1u << row ) - 1;
+        for( int col = 0; col < BOARD_WIDTH; col++ )
+        {
+            const uint32_t c = board->cols[ col ];
+            board->cols[ col ] = ( c & ~( above | ( 1u << row ) ) ) | ( ( c & above ) << 1 );
+        }
+        lines++;
+    }
+
+    return lines;
+}
+
+// Enumerate the moves for the active shape along the path botApplyMove takes: rotate at
+// the current position, slide sideways, then drop. Fills the board and cleared rows each
+// move leaves behind (boards and lines may be NULL) and returns the number of moves.
+static int
+listMoves( const GameState* game_state, BotMove* moves, PackedBoard* boards, int* lines )
+{
+    PackedBoard board;
+    PackedBoard after;
+    int         count = 0;
+
+    const TETRIS_SHAPE shape = game_state->active_shape;
+    const int start_x = game_state->active_shape_x;
+    const int start_y = game_state->active_shape_y;
+
+    packBoard( game_state->board, &board );
+
+    TETRIS_ROT rot = game_state->active_shape_rot;
+    for( int rotations = 0; rotations < 4; rotations++ )
+    {
+        if( rotations > 0 )
+        {
+            rot = ( rot + 1 ) % 4;
+            if( !fits( &board, shape, rot, start_x, start_y ) )
+            {
+                break;
+            }
+        }
+
+        for( int dir = -1; dir <= 1; dir += 2 )
+        {
+            // The start column is tried once, when sliding left.
+            int x = dir < 0 ? start_x : start_x + 1;
+            if( dir > 0 && !fits( &board, shape, rot, start_x + 1, start_y ) )
+            {
+                continue;
+            }
+
+            while( fits( &board, shape, rot, x, start_y ) )
+            {
+                int y = start_y;
+                while( fits( &board, shape, rot, x, y + 1 ) )
+                {
+                    y++;
+                }
+
+                after = board;
+                const int cleared = place( &after, shape, rot, x, y );
+                if( cleared >= 0 )
+                {
+                    moves[ count ].rotations = rotations;
+                    moves[ count ].x = x;
+                    moves[ count ].score = 0;
+                    if( boards != NULL )    boards[ count ] = after;
+                    if( lines != NULL )     lines[ count ] = cleared;
+                    count++;
+                }
+                x += dir;
+            }
+        }
+    }
+
+    return count;
+}
+
+/*
+ * List every move for the active shape that does not end the game. moves must hold
+ * BOT_MAX_MOVES entries.
+ */
+int
+botListMoves( const GameState* game_state, BotMove* moves )
+{
+    return listMoves( game_state, moves, NULL, NULL );
+}
+
+/*
+ * Find the best move for the active shape. Returns false when every move ends the game.
+ */
+bool
+botFindMove( const GameState* game_state, const BotWeights* weights, BotMove* move )
+{
+    return botFindMoveWith( game_state, weights, NULL, move );
+}
+
+/*
+ * Like botFindMove, but when network is not NULL it scores the boards left behind instead
+ * of weights->eval. Rows cleared still count weights->lines each.
+ */
+bool
+botFindMoveWith( const GameState* game_state, const BotWeights* weights, const NnModel* network, BotMove* move )
+{
+    PackedBoard candidates[ BOT_MAX_MOVES ];
+    BotMove     moves[ BOT_MAX_MOVES ];
+    int         lines[ BOT_MAX_MOVES ];
+    float       scores[ BOT_MAX_MOVES ];
+
+    const int count = listMoves( game_state, moves, candidates, lines );
+    if( count == 0 )
+    {
+        return false;
+    }
+
+    if( network != NULL )
+    {
+        nnEvalBoards( network, candidates, count, scores );
+    } else
+    {
+        evalBoards( candidates, count, &weights->eval, scores );
+    }
+
+    int best = 0;
+    float best_score = -FLT_MAX;
+    for( int i = 0; i < count; i++ )
+    {
+        const float score = scores[ i ] + (float) lines[ i ] * weights->lines;
+        if( score > best_score )
+        {
+            best = i;
+            best_score = score;
+        }
+    }
+
+    *move = moves[ best ];
+    move->score = best_score;
+    return true;
+}
+
+/*
+ * Play a move found by botFindMove with the game's own rules and lock the shape.
+ */
+void
+botApplyMove( GameState* game_state, const BotMove* move )
+{
+    for( int i = 0; i < move->rotations; i++ )
+    {
+        rotateShape( game_state );
+    }
+
+    const int dx = move->x < game_state->active_shape_x ? -1 : 1;
+    while( game_state->active_shape_x != move->x )
+    {
+        if( moveShape( game_state, dx, 0 ) < 0 )
+        {
+            break;
+        }
+    }
+
+    while( moveShape( game_state, 0, 1 ) == 0 )
+    {
+    }
+
+    logicTick( game_state );
+}
+
+void
+botWeightsFromArray( const float* values, BotWeights* weights )
+{
+    weights->eval.height            = values[ 0 ];
+    weights->eval.holes             = values[ 1 ];
+    weights->eval.bumpiness         = values[ 2 ];
+    weights->eval.wells             = values[ 3 ];
+    weights->eval.row_transitions   = values[ 4 ];
+    weights->lines                  = values[ 5 ];
+}
+
+void
+botWeightsToArray( const BotWeights* weights, float* values )
+{
+    values[ 0 ] = weights->eval.height;
+    values[ 1 ] = weights->eval.holes;
+    values[ 2 ] = weights->eval.bumpiness;
+    values[ 3 ] = weights->eval.wells;
+    values[ 4 ] = weights->eval.row_transitions;
+    values[ 5 ] = weights->lines;
+}
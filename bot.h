@@ -0,0 +1,54 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include <stdbool.h>
+#include "board_eval.h"
+#include "game.h"
+#include "nn_eval.h"
+
+/**************************************************************************
+** Heuristic bot. Tries every rotation and column for the active shape,
+** scores the resulting boards with evalBoards, or a network (nn_eval.h),
+** and plays the best one.
+**************************************************************************/
+
+typedef struct BotWeights
+{
+    EvalWeights     eval;               /**< Weights for the board that is left behind */
+    float           lines;              /**< Weight per row cleared by the placement */
+} BotWeights;
+
+#define BOT_WEIGHT_COUNT    6           /**< Number of floats in BotWeights */
+#define BOT_MAX_MOVES       ( 4 * BOARD_WIDTH )
+
+typedef struct BotMove
+{
+    int             rotations;          /**< Clockwise rotations to apply at the spawn position */
+    int             x;                  /**< Target x-position of the shape pivot point */
+    float           score;              /**< Score of the board after the move */
+} BotMove;
+
+extern const BotWeights BOT_DEFAULT_WEIGHTS;
+
+void
+botInit();
+
+int
+botListMoves( const GameState* game_state, BotMove* moves );
+
+bool
+botFindMove( const GameState* game_state, const BotWeights* weights, BotMove* move );
+
+bool
+botFindMoveWith( const GameState* game_state, const BotWeights* weights, const NnModel* network, BotMove* move );
+
+void
+botApplyMove( GameState* game_state, const BotMove* move );
+
+void
+botWeightsFromArray( const float* values, BotWeights* weights );
+
+void
+botWeightsToArray( const BotWeights* weights, float* values );
+
+#endif //BOT_H
@@ -0,0 +1,539 @@
+//
+// Environment server for reinforcement learning. Runs many games without a window and
+// lets a training process step them in batches through shared memory, see env_shm.h.
+//
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+#include "env_shm.h"
+#include "game.h"
+#include "obs_encoder.h"
+#include "replay.h"
+
+/**************************************************************************
+** Config
+**************************************************************************/
+#define DEFAULT_NAME            "/tetris_env"
+#define DEFAULT_ENVS            256
+#define DEFAULT_SEED            1u
+#define DEFAULT_MAX_STEPS       0       /**< Never truncate */
+#define STOP_POLL_MS            100
+
+/**************************************************************************
+** Structs
+**************************************************************************/
+
+typedef struct ServerConfig
+{
+    const char*     name;               /**< Shared memory name */
+    bool            replace;            /**< Take the name over even from a running server */
+    int             envs;               /**< Games in every batch */
+    int             threads;            /**< Worker threads, each owns a range of games */
+    int             max_steps;          /**< Episodes are truncated after this many steps */
+    bool            tensors;            /**< Also write the observations as tensors */
+    const char*     replay;             /**< Replay buffer file, NULL for none */
+    uint64_t        replay_capacity;    /**< Transitions, 0 to use an existing file as it is */
+    bool            replay_prioritized;
+    double          bench_seconds;      /**< Drive the server from a thread in this process */
+} ServerConfig;
+
+typedef struct Env
+{
+    GameState       game;
+    uint32_t        seed;               /**< Seed of the last reset command */
+    uint32_t        episode;            /**< Episodes since the last reset command */
+    int             steps;              /**< Steps into the current episode */
+} Env;
+
+typedef struct EnvServer
+{
+    EnvShm*         shm;
+    Env*            envs;
+    int             num_envs;
+    int             num_workers;
+    int             max_steps;
+    ReplayBuffer*   replay;             /**< Every step is appended here, NULL for none */
+    SDL_atomic_t    finished[ ENV_RING_SIZE ];  /**< Workers done with the batch in each slot */
+} EnvServer;
+
+typedef struct Worker
+{
+    EnvServer*      server;
+    int             first;              /**< First game this worker steps */
+    int             count;
+    SDL_Thread*     thread;
+    EnvObservation* states;             /**< Observations the games' next step starts from */
+    uint16_t*       rows;               /**< Their boards as rows */
+    ReplayTransition* transitions;      /**< The batch for the replay buffer */
+} Worker;
+
+static volatile sig_atomic_t StopRequested = 0;
+
+/**************************************************************************
+** Games
+**************************************************************************/
+
+// Every episode of every game gets its own seed, so runs with the same reset seed
+// replay exactly, however the games are spread over workers.
+static void
+startEpisode( EnvServer* server, int index )
+{
+    Env* env = &server->envs[ index ];
+    const uint32_t seed = env->seed + (uint32_t) index + env->episode * (uint32_t) server->num_envs;
+
+    freeGameState( &env->game );
+    initGameState( &env->game, seed );
+    env->episode++;
+    env->steps = 0;
+}
+
+static void
+observe( const Env* env, EnvObservation* observation )
+{
+    obsFromGame( &env->game, observation );
+    observation->steps = env->steps;
+}
+
+// Apply an action followed by one gravity tick, like a player pressing a key between
+// two logic ticks of the game.
+static void
+stepEnv( EnvServer* server, int index, const EnvSlot* slot )
+{
+    Env* env = &server->envs[ index ];
+    GameState* game = &env->game;
+    const int score = game->score;
+
+    switch( slot->actions[ index ] )
+    {
+        case ENV_ACTION_LEFT:
+            moveShape( game, -1, 0 );
+            break;
+        case ENV_ACTION_RIGHT:
+            moveShape( game, 1, 0 );
+            break;
+        case ENV_ACTION_ROTATE:
+            rotateShape( game );
+            break;
+        case ENV_ACTION_SOFT_DROP:
+            moveShape( game, 0, 1 );
+            break;
+        case ENV_ACTION_HARD_DROP:
+            while( moveShape( game, 0, 1 ) == 0 )
+            {
+            }
+            break;
+        default:
+            break;
+    }
+    logicTick( game );
+    env->steps++;
+
+    slot->rewards[ index ] = (float) ( game->score - score );
+    slot->dones[ index ] = ENV_DONE_NONE;
+    if( game->game_over )
+    {
+        slot->dones[ index ] = ENV_DONE_GAME_OVER;
+    } else if( server->max_steps > 0 && env->steps >= server->max_steps )
+    {
+        slot->dones[ index ] = ENV_DONE_TRUNCATED;
+    }
+
+    slot->episode_scores[ index ] = 0;
+    if( slot->dones[ index ] != ENV_DONE_NONE )
+    {
+        slot->episode_scores[ index ] = game->score;
+        startEpisode( server, index );
+    }
+    observe( env, &slot->observations[ index ] );
+}
+
+/**************************************************************************
+** Replay
+**************************************************************************/
+
+// Appending a whole batch at once takes one atomic add on the buffer's head, however
+// many games the worker steps.
+static void
+recordBatch( Worker* worker, const EnvSlot* slot )
+{
+    for( int k = 0; k < worker->count; k++ )
+    {
+        const int i = worker->first + k;
+        const EnvObservation* state = &worker->states[ k ];
+        ReplayTransition* transition = &worker->transitions[ k ];
+        const float reward = slot->rewards[ i ];
+
+        replayPackRows( &worker->rows[ (size_t) k * OBS_BOARD_BITS_SIZE ], transition->board );
+        transition->piece = (uint8_t) ( state->shape * OBS_ROT_COUNT + state->rot );
+        transition->x = (int8_t) state->x;
+        transition->y = (int8_t) state->y;
+        transition->action = slot->actions[ i ];
+        transition->done = slot->dones[ i ];
+        transition->reward = (int16_t) ( reward > INT16_MAX ? INT16_MAX : reward );
+    }
+    replayAppend( worker->server->replay, worker->transitions, worker->count );
+}
+
+/**************************************************************************
+** Workers
+**************************************************************************/
+
+static int
+workerThread( void* data )
+{
+    Worker* worker = data;
+    EnvServer* server = worker->server;
+    const int end = worker->first + worker->count;
+
+    for( int batch = 0; envWaitSubmitted( server->shm, batch ); batch++ )
+    {
+        const EnvSlot slot = envShmSlot( server->shm, batch );
+
+        if( slot.request->command == ENV_COMMAND_RESET )
+        {
+            for( int i = worker->first; i < end; i++ )
+            {
+                server->envs[ i ].seed = slot.request->seed;
+                server->envs[ i ].episode = 0;
+                startEpisode( server, i );
+                slot.rewards[ i ] = 0;
+                slot.dones[ i ] = ENV_DONE_NONE;
+                slot.episode_scores[ i ] = 0;
+                observe( &server->envs[ i ], &slot.observations[ i ] );
+            }
+        } else
+        {
+            // The state each game is in before the action is what the replay buffer keeps.
+            if( server->replay != NULL )
+            {
+                ObsBuffers rows;
+                SDL_zero( rows );
+                rows.board_bits = worker->rows;
+                obsEncode( worker->states, worker->count, &rows );
+            }
+
+            for( int i = worker->first; i < end; i++ )
+            {
+                stepEnv( server, i, &slot );
+            }
+
+            if( server->replay != NULL )
+            {
+                recordBatch( worker, &slot );
+            }
+        }
+        if( server->replay != NULL )
+        {
+            SDL_memcpy( worker->states, &slot.observations[ worker->first ], sizeof( EnvObservation ) * worker->count );
+        }
+
+        // Encode while this worker's observations are still in its cache.
+        if( slot.tensors.board_bits != NULL )
+        {
+            const ObsBuffers tensors = obsBuffersAt( &slot.tensors, worker->first );
+            obsEncode( &slot.observations[ worker->first ], worker->count, &tensors );
+        }
+
+        // The last worker to finish publishes the batch. Its counter is free again before
+        // the batch is completed, and the next batch in this slot cannot be submitted
+        // before that.
+        SDL_atomic_t* finished = &server->finished[ (unsigned int) batch % ENV_RING_SIZE ];
+        if( SDL_AtomicAdd( finished, 1 ) == server->num_workers - 1 )
+        {
+            SDL_AtomicSet( finished, 0 );
+            envComplete( server->shm, batch );
+        }
+    }
+
+    return 0;
+}
+
+/**************************************************************************
+** Benchmark
+**************************************************************************/
+
+static uint32_t BenchRng = 0x2545F491u;
+
+// Play random actions as fast as the server answers and report steps per second.
+static int
+benchThread( void* data )
+{
+    const ServerConfig* config = data;
+    EnvShm* shm = envShmOpen( config->name );
+    if( shm == NULL )
+    {
+        return 1;
+    }
+
+    const int num_envs = (int) shm->header->num_envs;
+    int batch = envSubmit( shm, ENV_COMMAND_RESET, DEFAULT_SEED );
+    envWaitCompleted( shm, batch );
+
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    const Uint64 start = SDL_GetPerformanceCounter();
+    const Uint64 end = start + (Uint64) ( config->bench_seconds * (double) frequency );
+    Uint64 batches = 0;
+    Uint64 episodes = 0;
+    Uint64 now = start;
+
+    do
+    {
+        const EnvSlot slot = envShmSlot( shm, batch + 1 );
+        for( int i = 0; i < num_envs; i++ )
+        {
+            BenchRng ^= BenchRng << 13;
+            BenchRng ^= BenchRng >> 17;
+            BenchRng ^= BenchRng << 5;
+            slot.actions[ i ] = (uint8_t) ( ( BenchRng >> 8 ) % ENV_ACTION_COUNT );
+        }
+
+        batch = envSubmit( shm, ENV_COMMAND_STEP, 0 );
+        if( !envWaitCompleted( shm, batch ) )
+        {
+            break;
+        }
+        for( int i = 0; i < num_envs; i++ )
+        {
+            episodes += slot.dones[ i ] != ENV_DONE_NONE;
+        }
+        batches++;
+        now = SDL_GetPerformanceCounter();
+    } while( now < end );
+
+    const double seconds = (double) ( now - start ) / (double) frequency;
+    printf( "%llu batches of %d games in %.2f s: %.0f steps/s, %.2f us per batch, %llu episodes\n",
+            (unsigned long long) batches,
+            num_envs,
+            seconds,
+            (double) batches * num_envs / seconds,
+            seconds * 1e6 / (double) batches,
+            (unsigned long long) episodes );
+
+    envShmClose( shm );
+    StopRequested = 1;
+    return 0;
+}
+
+/**************************************************************************
+** Public
+**************************************************************************/
+
+// Free the workers and their replay buffers, workers may be NULL.
+static void
+freeWorkers( Worker* workers, int count )
+{
+    for( int w = 0; workers != NULL && w < count; w++ )
+    {
+        free( workers[ w ].states );
+        free( workers[ w ].rows );
+        free( workers[ w ].transitions );
+    }
+    free( workers );
+}
+
+static void
+onSignal( int signal )
+{
+    (void) signal;
+    StopRequested = 1;
+}
+
+static void
+printUsage( const char* program )
+{
+    printf( "Usage: %s [--name /shm_name] [--replace] [--envs N] [--threads N] [--max-steps N] [--tensors]\n"
+            "       [--replay FILE] [--replay-capacity N] [--replay-prioritized] [--bench SECONDS]\n", program );
+}
+
+int
+main( int argc, char* argv[] )
+{
+    ServerConfig config;
+    config.name = DEFAULT_NAME;
+    config.replace = false;
+    config.envs = DEFAULT_ENVS;
+    config.threads = SDL_GetCPUCount();
+    config.max_steps = DEFAULT_MAX_STEPS;
+    config.tensors = false;
+    config.replay = NULL;
+    config.replay_capacity = 0;
+    config.replay_prioritized = false;
+    config.bench_seconds = 0;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        const bool has_value = i + 1 < argc;
+        if( strcmp( argv[ i ], "--name" ) == 0 && has_value )
+        {
+            config.name = argv[ ++i ];
+        } else if( strcmp( argv[ i ], "--replace" ) == 0 )
+        {
+            config.replace = true;
+        } else if( strcmp( argv[ i ], "--envs" ) == 0 && has_value )
+        {
+            config.envs = atoi( argv[ ++i ] );
+        } else if( strcmp( argv[ i ], "--threads" ) == 0 && has_value )
+        {
+            config.threads = atoi( argv[ ++i ] );
+        } else if( strcmp( argv[ i ], "--max-steps" ) == 0 && has_value )
+        {
+            config.max_steps = atoi( argv[ ++i ] );
+        } else if( strcmp( argv[ i ], "--tensors" ) == 0 )
+        {
+            config.tensors = true;
+        } else if( strcmp( argv[ i ], "--replay" ) == 0 && has_value )
+        {
+            config.replay = argv[ ++i ];
+        } else if( strcmp( argv[ i ], "--replay-capacity" ) == 0 && has_value )
+        {
+            config.replay_capacity = strtoull( argv[ ++i ], NULL, 10 );
+        } else if( strcmp( argv[ i ], "--replay-prioritized" ) == 0 )
+        {
+            config.replay_prioritized = true;
+        } else if( strcmp( argv[ i ], "--bench" ) == 0 && has_value )
+        {
+            config.bench_seconds = atof( argv[ ++i ] );
+        } else
+        {
+            printUsage( argv[ 0 ] );
+            return 1;
+        }
+    }
+    if( config.envs < 1 || config.threads < 1 || config.max_steps < 0 )
+    {
+        printUsage( argv[ 0 ] );
+        return 1;
+    }
+    if( config.threads > config.envs )
+    {
+        config.threads = config.envs;
+    }
+
+    int result = 0;
+    EnvServer server;
+    SDL_zero( server );
+    server.num_envs = config.envs;
+    server.num_workers = config.threads;
+    server.max_steps = config.max_steps;
+    server.envs = calloc( config.envs, sizeof( Env ) );
+    Worker* workers = calloc( config.threads, sizeof( Worker ) );
+    server.shm = envShmCreate( config.name, config.envs, config.max_steps, config.tensors, config.replace );
+    if( config.replay != NULL )
+    {
+        server.replay = replayOpen( config.replay, config.replay_capacity, config.replay_prioritized );
+    }
+
+    // Each worker splits off an even share of the games, with its own replay buffers.
+    bool allocated = server.envs != NULL && workers != NULL;
+    for( int w = 0; allocated && w < config.threads; w++ )
+    {
+        workers[ w ].server = &server;
+        workers[ w ].first = (int) ( (long long) config.envs * w / config.threads );
+        workers[ w ].count = (int) ( (long long) config.envs * ( w + 1 ) / config.threads ) - workers[ w ].first;
+        if( config.replay != NULL )
+        {
+            workers[ w ].states = calloc( workers[ w ].count, sizeof( EnvObservation ) );
+            workers[ w ].rows = calloc( (size_t) workers[ w ].count * OBS_BOARD_BITS_SIZE, sizeof( uint16_t ) );
+            workers[ w ].transitions = calloc( workers[ w ].count, sizeof( ReplayTransition ) );
+            allocated = workers[ w ].states != NULL && workers[ w ].rows != NULL && workers[ w ].transitions != NULL;
+        }
+    }
+    if( !allocated || server.shm == NULL || ( config.replay != NULL && server.replay == NULL ) )
+    {
+        if( !allocated )
+        {
+            printf( "Could not allocate the buffers for %d games\n", config.envs );
+        }
+        free( server.envs );
+        freeWorkers( workers, config.threads );
+        envShmClose( server.shm );
+        replayClose( server.replay );
+        return 1;
+    }
+
+    // Games are ready before the first reset, so stepping right away works too.
+    for( int i = 0; i < config.envs; i++ )
+    {
+        server.envs[ i ].seed = DEFAULT_SEED;
+        initGameState( &server.envs[ i ].game, DEFAULT_SEED + (uint32_t) i );
+        server.envs[ i ].episode = 1;
+    }
+
+    for( int w = 0; w < config.threads; w++ )
+    {
+        if( server.replay != NULL )
+        {
+            for( int k = 0; k < workers[ w ].count; k++ )
+            {
+                observe( &server.envs[ workers[ w ].first + k ], &workers[ w ].states[ k ] );
+            }
+        }
+        workers[ w ].thread = SDL_CreateThread( workerThread, "env", &workers[ w ] );
+        if( workers[ w ].thread == NULL )
+        {
+            // A batch is only completed once every worker has stepped its games, so the
+            // server cannot run with one missing.
+            printf( "Could not start worker %d. SDL_Error: %s\n", w, SDL_GetError() );
+            StopRequested = 1;
+            result = 1;
+            break;
+        }
+    }
+
+    signal( SIGINT, onSignal );
+    signal( SIGTERM, onSignal );
+
+    SDL_Thread* bench = NULL;
+    if( result == 0 && config.bench_seconds > 0 )
+    {
+        bench = SDL_CreateThread( benchThread, "bench", &config );
+        if( bench == NULL )
+        {
+            printf( "Could not start the benchmark. SDL_Error: %s\n", SDL_GetError() );
+            StopRequested = 1;
+            result = 1;
+        }
+    } else if( result == 0 )
+    {
+        printf( "Serving %d games on %s with %d threads\n", config.envs, config.name, config.threads );
+        if( config.tensors )
+        {
+            printf( "Encoding tensors with the %s kernel\n", obsEncodeKernelName() );
+        }
+        if( server.replay != NULL )
+        {
+            printf( "Recording to %s, %llu of %llu transitions\n", config.replay,
+                    (unsigned long long) replaySize( server.replay ),
+                    (unsigned long long) server.replay->header->capacity );
+        }
+    }
+
+    // After a failed start this stops the workers that did start right away.
+    while( !StopRequested && !SDL_AtomicGet( &server.shm->header->stopped ) )
+    {
+        SDL_Delay( STOP_POLL_MS );
+    }
+    envShmStop( server.shm );
+
+    for( int w = 0; w < config.threads; w++ )
+    {
+        SDL_WaitThread( workers[ w ].thread, NULL );
+    }
+    if( bench != NULL )
+    {
+        SDL_WaitThread( bench, NULL );
+    }
+
+    for( int i = 0; i < config.envs; i++ )
+    {
+        freeGameState( &server.envs[ i ].game );
+    }
+    replayClose( server.replay );
+    envShmClose( server.shm );
+    freeWorkers( workers, config.threads );
+    free( server.envs );
+    return result;
+}
@@ -0,0 +1,371 @@
+#include "env_shm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/**************************************************************************
+** Config
+**************************************************************************/
+#define ENV_SPIN_LIMIT          4000    /**< Polls before a waiter goes to sleep */
+#define ENV_WAIT_TIMEOUT_MS     100     /**< Sleepers recheck the stop flag this often */
+
+/**************************************************************************
+** Helpers
+**************************************************************************/
+
+static size_t
+alignUp( size_t size )
+{
+    return ( size + ENV_SHM_ALIGN - 1 ) & ~(size_t) ( ENV_SHM_ALIGN - 1 );
+}
+
+// True when counter has reached batch, also after the counters wrap around.
+static bool
+reached( int counter, int batch )
+{
+    return (int) ( (unsigned int) counter - (unsigned int) batch ) >= 0;
+}
+
+// The region is shared between processes, so these are the non-private futex calls.
+static void
+futexWait( SDL_atomic_t* word, int expected )
+{
+    const struct timespec timeout = { 0, ENV_WAIT_TIMEOUT_MS * 1000000L };
+    syscall( SYS_futex, &word->value, FUTEX_WAIT, expected, &timeout, NULL, 0 );
+}
+
+static void
+futexWake( SDL_atomic_t* word )
+{
+    syscall( SYS_futex, &word->value, FUTEX_WAKE, INT_MAX, NULL, NULL, 0 );
+}
+
+/*
+ * Wait until counter reaches batch. Spins first, a batch usually takes microseconds and
+ * a futex sleep costs more than that, then sleeps. Returns false once the region is
+ * stopped and batch was not reached.
+ */
+static bool
+waitCounter( EnvShm* shm, SDL_atomic_t* counter, SDL_atomic_t* waiters, int batch )
+{
+    // On one CPU the other side cannot run while this one spins.
+    const int spin_limit = SDL_GetCPUCount() > 1 ? ENV_SPIN_LIMIT : 0;
+    for( int spin = 0; spin < spin_limit; spin++ )
+    {
+        if( reached( SDL_AtomicGet( counter ), batch ) )
+        {
+            SDL_MemoryBarrierAcquire();
+            return true;
+        }
+        SDL_CPUPauseInstruction();
+    }
+
+    for( ;; )
+    {
+        const int value = SDL_AtomicGet( counter );
+        if( reached( value, batch ) )
+        {
+            SDL_MemoryBarrierAcquire();
+            return true;
+        }
+        if( SDL_AtomicGet( &shm->header->stopped ) )
+        {
+            return false;
+        }
+
+        // Announce the sleeper before the kernel rechecks the counter, so a waker
+        // that moves it afterwards always sees it.
+        SDL_AtomicIncRef( waiters );
+        futexWait( counter, value );
+        SDL_AtomicDecRef( waiters );
+    }
+}
+
+static void
+publishCounter( SDL_atomic_t* counter, SDL_atomic_t* waiters, int value )
+{
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet( counter, value );
+    if( SDL_AtomicGet( waiters ) > 0 )
+    {
+        futexWake( counter );
+    }
+}
+
+static EnvShm*
+mapRegion( const char* name, int fd, size_t size, bool owner )
+{
+    void* base = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    close( fd );
+    if( base == MAP_FAILED )
+    {
+        printf( "Could not map shared memory %s: %s\n", name, strerror( errno ) );
+        return NULL;
+    }
+
+    EnvShm* shm = SDL_calloc( 1, sizeof( EnvShm ) );
+    if( shm == NULL )
+    {
+        munmap( base, size );
+        return NULL;
+    }
+    shm->header = base;
+    shm->size = size;
+    shm->owner = owner;
+    SDL_strlcpy( shm->name, name, sizeof( shm->name ) );
+    return shm;
+}
+
+/**************************************************************************
+** Region
+**************************************************************************/
+
+// Reserve an array of count elements of size bytes in a slot and return its offset.
+static uint64_t
+reserve( size_t* offset, int count, size_t size )
+{
+    const size_t start = *offset;
+    *offset = alignUp( start + size * count );
+    return start;
+}
+
+// True when name holds a region of this version whose server has shut down, so it can
+// be replaced without taking it away from anyone.
+static bool
+regionStopped( const char* name )
+{
+    const int fd = shm_open( name, O_RDONLY, 0 );
+    if( fd < 0 )
+    {
+        return false;
+    }
+    EnvShmHeader header;
+    const bool stopped = pread( fd, &header, sizeof( header ), 0 ) == sizeof( header ) &&
+                         header.magic == ENV_SHM_MAGIC &&
+                         header.version == ENV_SHM_VERSION &&
+                         SDL_AtomicGet( &header.stopped ) != 0;
+    close( fd );
+    return stopped;
+}
+
+static void*
+slotArray( uint8_t* slot, uint64_t offset )
+{
+    return offset != 0 ? slot + offset : NULL;
+}
+
+/*
+ * Create the region name (e.g. "/tetris_env") for num_envs games. An existing region
+ * is only replaced when its server has stopped, or with replace, which takes it away
+ * from a server that may still be running. With tensors the slots also hold the
+ * encoded observations. Returns NULL on failure.
+ */
+EnvShm*
+envShmCreate( const char* name, int num_envs, int max_steps, bool tensors, bool replace )
+{
+    EnvShmHeader layout;
+    SDL_zero( layout );
+    layout.magic = ENV_SHM_MAGIC;
+    layout.version = ENV_SHM_VERSION;
+    layout.num_envs = (uint32_t) num_envs;
+    layout.ring_size = ENV_RING_SIZE;
+    layout.max_steps = (uint32_t) max_steps;
+    layout.observation_size = sizeof( EnvObservation );
+
+    size_t offset = alignUp( sizeof( EnvRequest ) );
+    layout.actions_offset = reserve( &offset, num_envs, sizeof( uint8_t ) );
+    layout.observations_offset = reserve( &offset, num_envs, sizeof( EnvObservation ) );
+    layout.rewards_offset = reserve( &offset, num_envs, sizeof( float ) );
+    layout.dones_offset = reserve( &offset, num_envs, sizeof( uint8_t ) );
+    layout.episode_scores_offset = reserve( &offset, num_envs, sizeof( int32_t ) );
+    if( tensors )
+    {
+        layout.board_bits_offset = reserve( &offset, num_envs, sizeof( uint16_t ) * OBS_BOARD_BITS_SIZE );
+        layout.board_offset = reserve( &offset, num_envs, sizeof( uint8_t ) * OBS_BOARD_SIZE );
+        layout.piece_offset = reserve( &offset, num_envs, sizeof( uint8_t ) * OBS_PIECE_SIZE );
+        layout.next_pieces_offset = reserve( &offset, num_envs, sizeof( uint8_t ) * OBS_NEXT_SIZE );
+        layout.position_offset = reserve( &offset, num_envs, sizeof( int8_t ) * OBS_POSITION_SIZE );
+        layout.heights_offset = reserve( &offset, num_envs, sizeof( uint8_t ) * OBS_HEIGHTS_SIZE );
+    }
+    layout.slot_stride = offset;
+    layout.slots_offset = alignUp( sizeof( EnvShmHeader ) );
+    layout.size = layout.slots_offset + layout.slot_stride * ENV_RING_SIZE;
+
+    int fd = shm_open( name, O_RDWR | O_CREAT | O_EXCL, 0600 );
+    if( fd < 0 && errno == EEXIST )
+    {
+        if( !replace && !regionStopped( name ) )
+        {
+            printf( "Shared memory %s is in use, stop its server or pass --replace\n", name );
+            return NULL;
+        }
+        shm_unlink( name );
+        fd = shm_open( name, O_RDWR | O_CREAT | O_EXCL, 0600 );
+    }
+    if( fd < 0 )
+    {
+        printf( "Could not create shared memory %s: %s\n", name, strerror( errno ) );
+        return NULL;
+    }
+    if( ftruncate( fd, (off_t) layout.size ) < 0 )
+    {
+        printf( "Could not size shared memory %s: %s\n", name, strerror( errno ) );
+        close( fd );
+        shm_unlink( name );
+        return NULL;
+    }
+
+    EnvShm* shm = mapRegion( name, fd, layout.size, true );
+    if( shm == NULL )
+    {
+        shm_unlink( name );
+        return NULL;
+    }
+
+    // The new file is zero filled, so the counters start at 0. Clients check the magic
+    // last, it is written once the rest of the header is.
+    const uint32_t magic = layout.magic;
+    layout.magic = 0;
+    *shm->header = layout;
+    SDL_MemoryBarrierRelease();
+    shm->header->magic = magic;
+    return shm;
+}
+
+/*
+ * Map the region a running server created. Returns NULL when it does not exist or was
+ * made by an incompatible server.
+ */
+EnvShm*
+envShmOpen( const char* name )
+{
+    const int fd = shm_open( name, O_RDWR, 0 );
+    if( fd < 0 )
+    {
+        printf( "Could not open shared memory %s: %s\n", name, strerror( errno ) );
+        return NULL;
+    }
+
+    EnvShmHeader header;
+    if( pread( fd, &header, sizeof( header ), 0 ) != sizeof( header ) ||
+        header.magic != ENV_SHM_MAGIC ||
+        header.version != ENV_SHM_VERSION ||
+        header.observation_size != sizeof( EnvObservation ) )
+    {
+        printf( "Shared memory %s is not a tetris environment (version %d)\n", name, ENV_SHM_VERSION );
+        close( fd );
+        return NULL;
+    }
+
+    return mapRegion( name, fd, header.size, false );
+}
+
+/*
+ * Unmap the region. The server also removes the name, clients that still have it
+ * mapped keep their mapping.
+ */
+void
+envShmClose( EnvShm* shm )
+{
+    if( shm == NULL )
+    {
+        return;
+    }
+    munmap( shm->header, shm->size );
+    if( shm->owner )
+    {
+        shm_unlink( shm->name );
+    }
+    SDL_free( shm );
+}
+
+EnvSlot
+envShmSlot( const EnvShm* shm, int batch )
+{
+    const EnvShmHeader* header = shm->header;
+    uint8_t* slot = (uint8_t*) header + header->slots_offset
+                  + header->slot_stride * ( (unsigned int) batch % ENV_RING_SIZE );
+
+    EnvSlot pointers;
+    pointers.request = (EnvRequest*) slot;
+    pointers.actions = slot + header->actions_offset;
+    pointers.observations = (EnvObservation*) ( slot + header->observations_offset );
+    pointers.rewards = (float*) ( slot + header->rewards_offset );
+    pointers.dones = slot + header->dones_offset;
+    pointers.episode_scores = (int32_t*) ( slot + header->episode_scores_offset );
+    pointers.tensors.board_bits = slotArray( slot, header->board_bits_offset );
+    pointers.tensors.board = slotArray( slot, header->board_offset );
+    pointers.tensors.piece = slotArray( slot, header->piece_offset );
+    pointers.tensors.next_pieces = slotArray( slot, header->next_pieces_offset );
+    pointers.tensors.position = slotArray( slot, header->position_offset );
+    pointers.tensors.heights = slotArray( slot, header->heights_offset );
+    return pointers;
+}
+
+/**************************************************************************
+** Signaling
+**************************************************************************/
+
+/*
+ * Client: publish the next batch. Its actions must already be in the slot from
+ * envShmSlot( shm, batch ). Returns the batch number to wait for.
+ */
+int
+envSubmit( EnvShm* shm, EnvCommand command, uint32_t seed )
+{
+    EnvShmHeader* header = shm->header;
+    const int batch = SDL_AtomicGet( &header->submitted );
+    EnvRequest* request = envShmSlot( shm, batch ).request;
+
+    request->command = command;
+    request->seed = seed;
+    publishCounter( &header->submitted, &header->submitted_waiters, batch + 1 );
+    return batch;
+}
+
+/*
+ * Server: wait until the client submitted batch. Returns false when the region stopped.
+ */
+bool
+envWaitSubmitted( EnvShm* shm, int batch )
+{
+    return waitCounter( shm, &shm->header->submitted, &shm->header->submitted_waiters, batch + 1 );
+}
+
+/*
+ * Server: publish the results of batch. Batches must complete in order.
+ */
+void
+envComplete( EnvShm* shm, int batch )
+{
+    publishCounter( &shm->header->completed, &shm->header->completed_waiters, batch + 1 );
+}
+
+/*
+ * Client: wait until the results of batch are in its slot. Returns false when the
+ * server stopped first.
+ */
+bool
+envWaitCompleted( EnvShm* shm, int batch )
+{
+    return waitCounter( shm, &shm->header->completed, &shm->header->completed_waiters, batch + 1 );
+}
+
+/*
+ * Tell the other side to stop. Waiters return false within ENV_WAIT_TIMEOUT_MS.
+ */
+void
+envShmStop( EnvShm* shm )
+{
+    SDL_AtomicSet( &shm->header->stopped, 1 );
+    futexWake( &shm->header->submitted );
+    futexWake( &shm->header->completed );
+}
@@ -0,0 +1,171 @@
+#ifndef ENV_SHM_H
+#define ENV_SHM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <SDL.h>
+#include "game.h"
+#include "obs_encoder.h"
+
+/**************************************************************************
+** Shared memory protocol of the environment server (tetris_env_server).
+** The server runs many headless games and a training process drives them
+** through one POSIX shared memory region, so actions and observations are
+** read and written in place and never copied through a socket.
+**
+** The region starts with an EnvShmHeader, followed by ENV_RING_SIZE batch
+** slots of slot_stride bytes each. A slot holds one batch for all games:
+**  - request (EnvRequest) and actions (uint8_t, one per game), written
+**    by the client,
+**  - observations (EnvObservation), rewards (float), dones (uint8_t) and
+**    episode scores (int32_t), one per game, written by the server,
+**  - optionally the observations encoded as tensors (see obs_encoder.h),
+**    when the server was started with them. Their offsets are 0 otherwise.
+** All offsets are in the header, so clients in other languages can map
+** the arrays directly (e.g. numpy.frombuffer on an mmap).
+**
+** Batch n lives in slot n % ENV_RING_SIZE. The client fills it and
+** publishes it by setting submitted to n + 1, the server steps every game
+** and sets completed to n + 1. Both counters are futex words: each side
+** spins briefly and then sleeps until the other one moves the counter.
+** The client may run up to ENV_RING_SIZE batches ahead, but must be done
+** with a slot's results before it submits the batch that reuses it.
+**
+** A game that ends is reset right away with its next seed. Its done flag
+** and episode score describe the episode that ended, its observation is
+** already the first one of the new episode.
+**************************************************************************/
+
+/**************************************************************************
+** Config
+**************************************************************************/
+#define ENV_SHM_MAGIC           0x564E4554u     /**< "TENV" */
+#define ENV_SHM_VERSION         2
+#define ENV_RING_SIZE           4               /**< Batches in flight */
+#define ENV_SHM_ALIGN           64              /**< Arrays start on their own cache line */
+
+/**************************************************************************
+** Protocol values
+**************************************************************************/
+typedef enum EnvCommand
+{
+    ENV_COMMAND_STEP,                   /**< Apply the actions and tick every game */
+    ENV_COMMAND_RESET                   /**< Start new episodes, game i gets seed + i */
+} EnvCommand;
+
+typedef enum EnvAction
+{
+    ENV_ACTION_NONE,
+    ENV_ACTION_LEFT,
+    ENV_ACTION_RIGHT,
+    ENV_ACTION_ROTATE,
+    ENV_ACTION_SOFT_DROP,               /**< One extra row down */
+    ENV_ACTION_HARD_DROP,               /**< Down until the shape lands */
+    ENV_ACTION_COUNT
+} EnvAction;
+
+typedef enum EnvDone
+{
+    ENV_DONE_NONE,
+    ENV_DONE_GAME_OVER,
+    ENV_DONE_TRUNCATED                  /**< Hit the server's step limit */
+} EnvDone;
+
+/**************************************************************************
+** Structs
+**************************************************************************/
+
+/**
+ * State of one game after a step, as plain integers.
+ */
+typedef struct EnvObservation
+{
+    uint32_t        board[ BOARD_WIDTH ];           /**< Frozen cells, bit y of board[ x ] is cell (x, y), row 0 on top */
+    int32_t         shape;                          /**< Active shape (TETRIS_SHAPE) */
+    int32_t         rot;                            /**< Active shape rotation (TETRIS_ROT) */
+    int32_t         x;                              /**< Pivot point of the active shape */
+    int32_t         y;
+    int32_t         next_shapes[ PIECE_QUEUE_SIZE ];/**< Upcoming shapes, next one first */
+    int32_t         next_rots[ PIECE_QUEUE_SIZE ];
+    int32_t         score;
+    int32_t         steps;                          /**< Steps into the episode */
+} EnvObservation;
+
+typedef struct EnvRequest
+{
+    uint32_t        command;            /**< EnvCommand */
+    uint32_t        seed;               /**< ENV_COMMAND_RESET only */
+} EnvRequest;
+
+typedef struct EnvShmHeader
+{
+    uint32_t        magic;
+    uint32_t        version;
+    uint32_t        num_envs;
+    uint32_t        ring_size;
+    uint32_t        max_steps;          /**< Episodes are truncated after this many steps, 0 for never */
+    uint32_t        observation_size;   /**< sizeof( EnvObservation ) */
+    uint64_t        size;               /**< Bytes in the whole region */
+    uint64_t        slots_offset;       /**< First slot, from the start of the region */
+    uint64_t        slot_stride;
+    uint64_t        actions_offset;     /**< Arrays, from the start of a slot */
+    uint64_t        observations_offset;
+    uint64_t        rewards_offset;
+    uint64_t        dones_offset;
+    uint64_t        episode_scores_offset;
+    uint64_t        board_bits_offset;  /**< Tensors, same layout as ObsBuffers */
+    uint64_t        board_offset;
+    uint64_t        piece_offset;
+    uint64_t        next_pieces_offset;
+    uint64_t        position_offset;
+    uint64_t        heights_offset;
+
+    _Alignas( ENV_SHM_ALIGN ) SDL_atomic_t submitted;   /**< Batches published by the client */
+    SDL_atomic_t    submitted_waiters;
+    _Alignas( ENV_SHM_ALIGN ) SDL_atomic_t completed;   /**< Batches finished by the server */
+    SDL_atomic_t    completed_waiters;
+    _Alignas( ENV_SHM_ALIGN ) SDL_atomic_t stopped;     /**< Set when either side shuts down */
+} EnvShmHeader;
+
+/**
+ * Pointers into one batch slot.
+ */
+typedef struct EnvSlot
+{
+    EnvRequest*     request;
+    uint8_t*        actions;
+    EnvObservation* observations;
+    float*          rewards;
+    uint8_t*        dones;
+    int32_t*        episode_scores;     /**< Final score of the episodes that ended in this batch */
+    ObsBuffers      tensors;            /**< All NULL unless the server encodes tensors */
+} EnvSlot;
+
+typedef struct EnvShm
+{
+    EnvShmHeader*   header;
+    size_t          size;
+    char            name[ 256 ];
+    bool            owner;              /**< Created the region and unlinks it on close */
+} EnvShm;
+
+/**************************************************************************
+** Region
+**************************************************************************/
+EnvShm*     envShmCreate( const char* name, int num_envs, int max_steps, bool tensors, bool replace );
+EnvShm*     envShmOpen( const char* name );
+void        envShmClose( EnvShm* shm );
+EnvSlot     envShmSlot( const EnvShm* shm, int batch );
+
+/**************************************************************************
+** Signaling. Batch numbers wrap around, they are only compared by
+** difference.
+**************************************************************************/
+int         envSubmit( EnvShm* shm, EnvCommand command, uint32_t seed );
+bool        envWaitSubmitted( EnvShm* shm, int batch );
+void        envComplete( EnvShm* shm, int batch );
+bool        envWaitCompleted( EnvShm* shm, int batch );
+void        envShmStop( EnvShm* shm );
+
+#endif //ENV_SHM_H
@@ -0,0 +1,225 @@
+//
+// Bakes the glyphs the HUD needs from a TrueType font into a C header, see hud_font.h.
+// The build runs it when TETRIS_FONT_FILE is set, otherwise the checked in
+// hud_font_data.h is used and no font file is needed at all.
+//
+// Usage: tetris_font_bake FONT.ttf PIXEL_SIZE OUTPUT.h
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+/**************************************************************************
+** Config
+**************************************************************************/
+#define GLYPHS                  " -./0123456789:ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+#define ATLAS_WIDTH             256     /**< Glyphs are packed in rows of this many pixels */
+#define ATLAS_PADDING           1       /**< Transparent pixels around every glyph, so filtering never reaches a neighbour */
+#define BYTES_PER_LINE          24
+
+/**************************************************************************
+** Structs
+**************************************************************************/
+
+typedef struct BakedGlyph
+{
+    int             x;                  /**< Position in the atlas */
+    int             y;
+    int             width;
+    int             height;
+    int             left;               /**< Offset from the pen position to the bitmap */
+    int             top;                /**< Offset from the top of the line to the bitmap */
+    int             advance;
+    Uint8*          alpha;              /**< width * height coverage values */
+} BakedGlyph;
+
+/**************************************************************************
+** Baking
+**************************************************************************/
+
+// Render one glyph and crop it to the pixels it covers. The offsets are measured from the
+// pen position and the top of the line, like TTF_AddAtlasTextUTF8 places glyphs.
+static int
+bakeGlyph( TTF_Font* font, Uint32 codepoint, BakedGlyph* glyph )
+{
+    int minx, maxx, miny, maxy;
+    SDL_zerop( glyph );
+    if( TTF_GlyphMetrics32( font, codepoint, &minx, &maxx, &miny, &maxy, &glyph->advance ) < 0 )
+    {
+        return -1;
+    }
+
+    const SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+    SDL_Surface* rendered = TTF_RenderGlyph32_Blended( font, codepoint, white );
+    if( rendered == NULL )
+    {
+        // Blank glyphs (the space) render to nothing, they only advance the pen.
+        return 0;
+    }
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat( rendered, SDL_PIXELFORMAT_ARGB8888, 0 );
+    SDL_FreeSurface( rendered );
+    if( surface == NULL )
+    {
+        return -1;
+    }
+
+    int left = surface->w, right = -1, top = surface->h, bottom = -1;
+    for( int y = 0; y < surface->h; y++ )
+    {
+        const Uint32* row = (const Uint32*) ( (const Uint8*) surface->pixels + y * surface->pitch );
+        for( int x = 0; x < surface->w; x++ )
+        {
+            if( row[ x ] >> 24 )
+            {
+                left = x < left ? x : left;
+                right = x > right ? x : right;
+                top = y < top ? y : top;
+                bottom = y > bottom ? y : bottom;
+            }
+        }
+    }
+
+    // SDL_ttf shifts the pen right by a negative left bearing, and down by how far the
+    // glyph reaches above the ascent, so nothing is drawn outside the surface.
+    const int pen_x = minx < 0 ? -minx : 0;
+    const int pen_y = maxy > TTF_FontAscent( font ) ? maxy - TTF_FontAscent( font ) : 0;
+    if( right >= left )
+    {
+        glyph->left = left - pen_x;
+        glyph->top = top - pen_y;
+        glyph->width = right - left + 1;
+        glyph->height = bottom - top + 1;
+        glyph->alpha = malloc( (size_t) glyph->width * glyph->height );
+        for( int y = 0; y < glyph->height; y++ )
+        {
+            const Uint32* row = (const Uint32*) ( (const Uint8*) surface->pixels + ( top + y ) * surface->pitch );
+            for( int x = 0; x < glyph->width; x++ )
+            {
+                glyph->alpha[ y * glyph->width + x ] = (Uint8) ( row[ left + x ] >> 24 );
+            }
+        }
+    }
+    SDL_FreeSurface( surface );
+    return 0;
+}
+
+// Shelf packing, glyphs are placed left to right in rows as tall as their tallest glyph,
+// each inside a border of ATLAS_PADDING pixels.
+static int
+packGlyphs( BakedGlyph* glyphs, int count )
+{
+    int x = 0, y = 0, row_height = 0;
+    for( int i = 0; i < count; i++ )
+    {
+        const int width = glyphs[ i ].width + 2 * ATLAS_PADDING;
+        const int height = glyphs[ i ].height + 2 * ATLAS_PADDING;
+        if( x + width > ATLAS_WIDTH )
+        {
+            x = 0;
+            y += row_height;
+            row_height = 0;
+        }
+        glyphs[ i ].x = x + ATLAS_PADDING;
+        glyphs[ i ].y = y + ATLAS_PADDING;
+        x += width;
+        row_height = height > row_height ? height : row_height;
+    }
+    return y + row_height;
+}
+
+static void
+writeHeader( FILE* out, const char* font_path, int size, int line_height,
+             const BakedGlyph* glyphs, int count, int atlas_height )
+{
+    const char* font_name = SDL_strrchr( font_path, '/' );
+    font_name = font_name != NULL ? font_name + 1 : font_path;
+    fprintf( out, "//\n// Generated by tetris_font_bake from %s at %d px, do not edit.\n//\n\n", font_name, size );
+    fprintf( out, "#ifndef HUD_FONT_DATA_H\n#define HUD_FONT_DATA_H\n\n" );
+    fprintf( out, "#define HUD_FONT_LINE_HEIGHT    %d\n", line_height );
+    fprintf( out, "#define HUD_FONT_ATLAS_WIDTH    %d\n", ATLAS_WIDTH );
+    fprintf( out, "#define HUD_FONT_ATLAS_HEIGHT   %d\n", atlas_height );
+    fprintf( out, "#define HUD_FONT_GLYPH_COUNT    %d\n\n", count );
+
+    fprintf( out, "/* codepoint, x, y, width, height, left, top, advance */\n" );
+    fprintf( out, "static const HudGlyph HUD_FONT_GLYPHS[ HUD_FONT_GLYPH_COUNT ] =\n{\n" );
+    for( int i = 0; i < count; i++ )
+    {
+        const BakedGlyph* g = &glyphs[ i ];
+        fprintf( out, "    { '%s%c', %3d, %3d, %2d, %2d, %2d, %2d, %2d },\n",
+                 GLYPHS[ i ] == '\'' || GLYPHS[ i ] == '\\' ? "\\" : "", GLYPHS[ i ],
+                 g->x, g->y, g->width, g->height, g->left, g->top, g->advance );
+    }
+    fprintf( out, "};\n\n" );
+
+    // The atlas is mostly empty space, so it is stored as the glyph bitmaps back to
+    // back in glyph order and placed into the texture when the font is created.
+    fprintf( out, "static const unsigned char HUD_FONT_BITMAPS[] =\n{" );
+    int written = 0;
+    for( int i = 0; i < count; i++ )
+    {
+        for( int p = 0; p < glyphs[ i ].width * glyphs[ i ].height; p++ )
+        {
+            fprintf( out, "%s%d,", written % BYTES_PER_LINE == 0 ? "\n    " : "", glyphs[ i ].alpha[ p ] );
+            written++;
+        }
+    }
+    fprintf( out, "\n};\n\n#endif //HUD_FONT_DATA_H\n" );
+}
+
+/**************************************************************************
+** Main
+**************************************************************************/
+
+int
+main( int argc, char* argv[] )
+{
+    if( argc != 4 )
+    {
+        printf( "Usage: %s FONT.ttf PIXEL_SIZE OUTPUT.h\n", argv[ 0 ] );
+        return 1;
+    }
+
+    const int size = atoi( argv[ 2 ] );
+    if( TTF_Init() < 0 )
+    {
+        printf( "Could not initialize SDL_TTF: %s\n", TTF_GetError() );
+        return 1;
+    }
+    TTF_Font* font = TTF_OpenFont( argv[ 1 ], size );
+    if( font == NULL )
+    {
+        printf( "TTF_OpenFont: %s\n", TTF_GetError() );
+        return 1;
+    }
+
+    const int count = (int) SDL_strlen( GLYPHS );
+    BakedGlyph glyphs[ sizeof( GLYPHS ) ];
+    for( int i = 0; i < count; i++ )
+    {
+        if( bakeGlyph( font, (Uint8) GLYPHS[ i ], &glyphs[ i ] ) < 0 )
+        {
+            printf( "Could not render '%c': %s\n", GLYPHS[ i ], TTF_GetError() );
+            return 1;
+        }
+    }
+    const int atlas_height = packGlyphs( glyphs, count );
+
+    FILE* out = fopen( argv[ 3 ], "w" );
+    if( out == NULL )
+    {
+        printf( "Could not write %s\n", argv[ 3 ] );
+        return 1;
+    }
+    writeHeader( out, argv[ 1 ], size, TTF_FontHeight( font ), glyphs, count, atlas_height );
+    fclose( out );
+
+    for( int i = 0; i < count; i++ )
+    {
+        free( glyphs[ i ].alpha );
+    }
+    TTF_CloseFont( font );
+    TTF_Quit();
+    return 0;
+}
@@ -0,0 +1,281 @@
+#include "game.h"
+
+#include <stddef.h>
+#include <string.h>
+
+RESULT
+initGameState( GameState* game_state, uint32_t seed )
+{
+    if( game_state == NULL )
+    {
+        return RESULT_ERROR ;
+    }
+    game_state->running = true;
+    game_state->game_over = false;
+    game_state->score = 0;
+    game_state->rng_state = seed != 0 ? seed : 0x9E3779B9u;   // xorshift state must not be 0
+    game_state->active_shape = randomShape( game_state );
+    game_state->active_shape_rot = randomRotation( game_state );
+    game_state->active_shape_x = SHAPE_SPAWN_X;
+    game_state->active_shape_y = SHAPE_SPAWN_Y;
+    game_state->board = matrixMake( BOARD_WIDTH, BOARD_HEIGHT );
+
+    game_state->next_pieces.head = 0;
+    for( int i = 0; i < PIECE_QUEUE_SIZE; i++ )
+    {
+        game_state->next_pieces.shapes[ i ] = randomShape( game_state );
+        game_state->next_pieces.rots[ i ] = randomRotation( game_state );
+    }
+
+    for ( int i = 0; i < BOARD_WIDTH; i++ )
+    {
+        for ( int j = 0; j < BOARD_HEIGHT; j++ )
+        {
+            matrixSet( game_state->board, i, j, 0 );
+        }
+    }
+
+    return RESULT_SUCCESS;
+}
+
+void
+freeGameState( GameState* game_state )
+{
+    matrixFree( game_state->board );
+    game_state->board = NULL;
+}
+
+// Copy a game into dst, which must already have a board (from initGameState). Does not
+// allocate, so searches can copy games as often as they like.
+void
+copyGameState( GameState* dst, const GameState* src )
+{
+    Matrix* board = dst->board;
+    *dst = *src;
+    dst->board = board;
+    memcpy( board->content, src->board->content, sizeof( int ) * BOARD_WIDTH * BOARD_HEIGHT );
+}
+
+// Validate if new shape position and rotation is within bounds of the board and
+// not colliding with shapes that were already dropped.
+bool
+validateShape( GameState* game_state, int x, int y, TETRIS_ROT tetris_rot )
+{
+    int cells[ 4 ][ 2 ];
+    getShapeCells( game_state->active_shape, x, y, tetris_rot, cells );
+
+    for( int cell = 0; cell < 4; cell++ )
+    {
+        const int new_x = cells[ cell ][ 0 ];
+        const int new_y = cells[ cell ][ 1 ];
+
+        // Check collision with board bounds. y < 0 is allowed for
+        // spawned blocks.
+        if( new_x < 0                   ||
+            new_x > BOARD_WIDTH - 1     ||
+            new_y > BOARD_HEIGHT - 1 )
+        {
+            return false;
+        }
+
+        // Check for collision with board elements (but only when y >= 0 to prevent out
+        // of bounds matrixGet)
+        if( new_y >= 0 && matrixGet( game_state->board, new_x, new_y) > 0 )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Rotate active piece by 90 deg clockwise (if it does not collide).
+void
+rotateShape( GameState* game_state )
+{
+    TETRIS_ROT target_rot;
+    if ( game_state->active_shape_rot < 3 )
+    {
+        target_rot = game_state->active_shape_rot + 1;
+    } else
+    {
+        target_rot = 0;
+    }
+
+    if( !validateShape( game_state, game_state->active_shape_x, game_state->active_shape_y, target_rot ) )
+    {
+        return;
+    }
+
+    game_state->active_shape_rot = target_rot;
+}
+
+// Move shape along dx or dy (if it does not collide). Returns 0 on success
+// and -1 on failure (collision).
+int
+moveShape( GameState* game_state, int dx, int dy )
+{
+    const int target_x = game_state->active_shape_x + dx;
+    const int target_y = game_state->active_shape_y + dy;
+
+    if( !validateShape( game_state, target_x, target_y, game_state->active_shape_rot ) )
+    {
+        return -1;
+    }
+    game_state->active_shape_x = target_x;
+    game_state->active_shape_y = target_y;
+    return 0;
+}
+
+// Spawn the next shape from the queue and queue a new random one. The game is over
+// when the spawned shape collides right away.
+void
+spawnShape( GameState* game_state )
+{
+    PieceQueue* queue = &game_state->next_pieces;
+
+    game_state->active_shape = queue->shapes[ queue->head ];
+    game_state->active_shape_rot = queue->rots[ queue->head ];
+    queue->shapes[ queue->head ] = randomShape( game_state );
+    queue->rots[ queue->head ] = randomRotation( game_state );
+    queue->head = ( queue->head + 1 ) % PIECE_QUEUE_SIZE;
+
+    game_state->active_shape_x = SHAPE_SPAWN_X;
+    game_state->active_shape_y = SHAPE_SPAWN_Y;
+
+    if( !validateShape( game_state, SHAPE_SPAWN_X, SHAPE_SPAWN_Y, game_state->active_shape_rot ) )
+    {
+        game_state->game_over = true;
+    }
+}
+
+// Get the shape that spawns index shapes from now (0 is the next one). index must be
+// below PIECE_QUEUE_SIZE.
+void
+peekShape( const GameState* game_state, int index, TETRIS_SHAPE* shape, TETRIS_ROT* rot )
+{
+    const int slot = ( game_state->next_pieces.head + index ) % PIECE_QUEUE_SIZE;
+    *shape = game_state->next_pieces.shapes[ slot ];
+    *rot = game_state->next_pieces.rots[ slot ];
+}
+
+// Freeze shape in place on the board. Cells that stick out above the board end
+// the game.
+void
+freezeShape( GameState* game_state )
+{
+    int cells[ 4 ][ 2 ];
+    getShapeCells( game_state->active_shape,
+                   game_state->active_shape_x,
+                   game_state->active_shape_y,
+                   game_state->active_shape_rot,
+                   cells );
+
+    for( int cell = 0; cell < 4; cell++ )
+    {
+        const int x = cells[ cell ][ 0 ];
+        const int y = cells[ cell ][ 1 ];
+        if( y < 0 )
+        {
+            game_state->game_over = true;
+            continue;
+        }
+        matrixSet( game_state->board, x, y, 1 );
+    }
+}
+
+// Find full rows, clear them and add to the score.
+void
+clearFullRows( GameState* game_state)
+{
+    // Loop over all board rows from bottom to top.
+    int row = BOARD_HEIGHT - 1;
+    while ( row >= 0 )
+    {
+        bool is_row_full = true;
+        for( int col = 0; col < BOARD_WIDTH; col++ )
+        {
+            if ( matrixGet( game_state->board, col, row ) == 0 )
+            {
+                is_row_full = false;
+                break;
+            }
+        }
+
+        if (is_row_full)
+        {
+            // Clear this line
+            for( int col = 0; col < BOARD_WIDTH; col++ )
+            {
+                matrixSet( game_state->board, col, row, 0 );
+            }
+
+            // Move all lines above 1 row downward, the top line becomes empty
+            for( int i = row; i > 0; i-- )
+            {
+                for( int j = 0; j < BOARD_WIDTH; j++ )
+                {
+                    matrixSet( game_state->board, j, i, matrixGet( game_state->board, j, i - 1 ) );
+                }
+            }
+            for( int j = 0; j < BOARD_WIDTH; j++ )
+            {
+                matrixSet( game_state->board, j, 0, 0 );
+            }
+
+            // Add score
+            game_state->score += SCORE_PER_ROW;
+
+            // All rows moved down, so the loop should check this row again
+        } else
+        {
+            // Loop should check next row (1 up)
+            row--;
+        }
+    }
+}
+
+void
+logicTick( GameState* game_state )
+{
+    // Gravity
+    int result = moveShape( game_state, 0, 1 );
+
+    // Spawn new shape if shape cannot move. Rows are cleared first, so the new
+    // shape is checked against the board it will actually fall into.
+    if( result < 0 )
+    {
+        freezeShape( game_state );
+        clearFullRows( game_state );
+        spawnShape( game_state );
+    }
+}
+
+/**************************************************************************
+** Seeded shape generator. Every game owns its own state, so games with the
+** same seed get the same shapes, also when many of them run in parallel.
+**************************************************************************/
+
+// Generate a random number between min and max
+int
+randomInt( GameState* game_state, int min, int max )
+{
+    uint32_t x = game_state->rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    game_state->rng_state = x;
+    return (int) ( x % (uint32_t) ( max - min + 1 ) ) + min;
+}
+
+TETRIS_SHAPE
+randomShape( GameState* game_state )
+{
+    return randomInt( game_state, 0, 6 );
+}
+
+TETRIS_ROT
+randomRotation( GameState* game_state )
+{
+    return randomInt( game_state, 0, 3 );
+}
@@ -0,0 +1,70 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "matrix.h"
+#include "tetris_shape.h"
+
+/**************************************************************************
+** Board config (shared between the game and the bot modules)
+**************************************************************************/
+#define BOARD_WIDTH             10
+#define BOARD_HEIGHT            20
+#define SCORE_PER_ROW           100
+#define SHAPE_SPAWN_X           5
+#define SHAPE_SPAWN_Y           (-1)
+#define PIECE_QUEUE_SIZE        4       /**< Upcoming shapes known in advance */
+
+/**************************************************************************
+** Structs
+**************************************************************************/
+
+/**
+ * Ring buffer of the shapes that spawn next. It is always full: spawning takes the
+ * shape at head and refills its slot from the seeded generator.
+ */
+typedef struct PieceQueue
+{
+    TETRIS_SHAPE    shapes[ PIECE_QUEUE_SIZE ];
+    TETRIS_ROT      rots[ PIECE_QUEUE_SIZE ];
+    int             head;               /**< Slot of the shape that spawns next */
+} PieceQueue;
+
+typedef struct GameState
+{
+    bool            running;            /**< Game will exit if running is set to false */
+    bool            game_over;          /**< Set when a shape freezes above the board or cannot spawn */
+    Matrix*         board;              /**< Pieces on the board (with exception of player-controlled shape */
+    TETRIS_SHAPE    active_shape;       /**< Shape that is controlled by player */
+    TETRIS_ROT      active_shape_rot;   /**< Shape rotation */
+    int             active_shape_x;     /**< x-position of shape pivot point on board */
+    int             active_shape_y;     /**< yposition of shape pivot point on board */
+    int             score;              /**< Total player score */
+    PieceQueue      next_pieces;        /**< Shapes that spawn after the active one */
+    uint32_t        rng_state;          /**< State of the seeded shape generator */
+} GameState;
+
+typedef int             RESULT;
+#define RESULT_SUCCESS  0
+#define RESULT_ERROR    (-1)
+
+/**************************************************************************
+** Game rules. These do not touch SDL, so they can run without a window.
+**************************************************************************/
+RESULT          initGameState( GameState* game_state, uint32_t seed );
+void            freeGameState( GameState* game_state );
+void            copyGameState( GameState* dst, const GameState* src );
+bool            validateShape( GameState* game_state, int x, int y, TETRIS_ROT tetris_rot );
+void            rotateShape( GameState* game_state );
+int             moveShape( GameState* game_state, int dx, int dy );
+void            spawnShape( GameState* game_state );
+void            peekShape( const GameState* game_state, int index, TETRIS_SHAPE* shape, TETRIS_ROT* rot );
+void            freezeShape( GameState* game_state );
+void            clearFullRows( GameState* game_state );
+void            logicTick( GameState* game_state );
+int             randomInt( GameState* game_state, int min, int max );
+TETRIS_SHAPE    randomShape( GameState* game_state );
+TETRIS_ROT      randomRotation( GameState* game_state );
+
+#endif //GAME_H
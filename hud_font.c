@@ -0,0 +1,169 @@
+#include "hud_font.h"
+
+#ifdef HUD_FONT_DATA
+#include HUD_FONT_DATA                  /* Baked by the build from TETRIS_FONT_FILE */
+#else
+#include "hud_font_data.h"
+#endif
+
+// Places the glyph bitmaps, stored back to back, at their atlas positions.
+static SDL_Texture*
+createAtlas( SDL_Renderer* renderer )
+{
+    Uint32* pixels = SDL_calloc( (size_t) HUD_FONT_ATLAS_WIDTH * HUD_FONT_ATLAS_HEIGHT, sizeof( Uint32 ) );
+    if( pixels == NULL )
+    {
+        return NULL;
+    }
+
+    const unsigned char* alpha = HUD_FONT_BITMAPS;
+    for( int i = 0; i < HUD_FONT_GLYPH_COUNT; i++ )
+    {
+        const HudGlyph* glyph = &HUD_FONT_GLYPHS[ i ];
+        for( int y = 0; y < glyph->height; y++ )
+        {
+            for( int x = 0; x < glyph->width; x++ )
+            {
+                pixels[ ( glyph->y + y ) * HUD_FONT_ATLAS_WIDTH + glyph->x + x ] = (Uint32) *alpha++ << 24 | 0xFFFFFF;
+            }
+        }
+    }
+
+    SDL_Texture* atlas = SDL_CreateTexture( renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+                                            HUD_FONT_ATLAS_WIDTH, HUD_FONT_ATLAS_HEIGHT );
+    if( atlas != NULL )
+    {
+        SDL_UpdateTexture( atlas, NULL, pixels, HUD_FONT_ATLAS_WIDTH * (int) sizeof( Uint32 ) );
+        SDL_SetTextureBlendMode( atlas, SDL_BLENDMODE_BLEND );
+    }
+    SDL_free( pixels );
+    return atlas;
+}
+
+static const HudGlyph*
+findGlyph( const HudFont* font, char codepoint )
+{
+    const int c = SDL_toupper( (unsigned char) codepoint );
+    return c < 128 ? font->glyphs[ c ] : NULL;
+}
+
+HudFont*
+hudFontCreate( SDL_Renderer* renderer )
+{
+    HudFont* font = SDL_calloc( 1, sizeof( HudFont ) );
+    if( font == NULL )
+    {
+        return NULL;
+    }
+
+    font->renderer = renderer;
+    font->atlas = createAtlas( renderer );
+    if( font->atlas == NULL )
+    {
+        hudFontDestroy( font );
+        return NULL;
+    }
+
+    for( int i = 0; i < HUD_FONT_GLYPH_COUNT; i++ )
+    {
+        font->glyphs[ (unsigned char) HUD_FONT_GLYPHS[ i ].codepoint ] = &HUD_FONT_GLYPHS[ i ];
+    }
+    for( int quad = 0; quad < HUD_FONT_MAX_QUADS; quad++ )
+    {
+        int* triangles = &font->indices[ quad * 6 ];
+        triangles[ 0 ] = quad * 4;
+        triangles[ 1 ] = quad * 4 + 1;
+        triangles[ 2 ] = quad * 4 + 2;
+        triangles[ 3 ] = quad * 4;
+        triangles[ 4 ] = quad * 4 + 2;
+        triangles[ 5 ] = quad * 4 + 3;
+    }
+    return font;
+}
+
+void
+hudFontDestroy( HudFont* font )
+{
+    if( font == NULL )
+    {
+        return;
+    }
+    if( font->atlas != NULL )
+    {
+        SDL_DestroyTexture( font->atlas );
+    }
+    SDL_free( font );
+}
+
+/*
+ * Queue text, stretched over dstrect like TTF_AddAtlasTextUTF8. Lowercase letters are
+ * drawn as uppercase and characters that were not baked are skipped. Returns -1 when
+ * the queue is full, the glyphs that fit are still drawn.
+ */
+int
+hudFontAddText( HudFont* font, const char* text, const SDL_FRect* dstrect, SDL_Color color )
+{
+    int width = 0;
+    for( const char* c = text; *c != '\0'; c++ )
+    {
+        const HudGlyph* glyph = findGlyph( font, *c );
+        width += glyph != NULL ? glyph->advance : 0;
+    }
+    if( width == 0 )
+    {
+        return 0;
+    }
+
+    const float scale_x = dstrect->w / (float) width;
+    const float scale_y = dstrect->h / (float) HUD_FONT_LINE_HEIGHT;
+    int pen = 0;
+    for( const char* c = text; *c != '\0'; c++ )
+    {
+        const HudGlyph* glyph = findGlyph( font, *c );
+        if( glyph == NULL )
+        {
+            continue;
+        }
+        if( glyph->width > 0 )
+        {
+            if( font->quads == HUD_FONT_MAX_QUADS )
+            {
+                return -1;
+            }
+
+            const float left = dstrect->x + (float) ( pen + glyph->left ) * scale_x;
+            const float top = dstrect->y + (float) glyph->top * scale_y;
+            const float right = left + (float) glyph->width * scale_x;
+            const float bottom = top + (float) glyph->height * scale_y;
+            const float u0 = (float) glyph->x / HUD_FONT_ATLAS_WIDTH;
+            const float v0 = (float) glyph->y / HUD_FONT_ATLAS_HEIGHT;
+            const float u1 = (float) ( glyph->x + glyph->width ) / HUD_FONT_ATLAS_WIDTH;
+            const float v1 = (float) ( glyph->y + glyph->height ) / HUD_FONT_ATLAS_HEIGHT;
+
+            SDL_Vertex* quad = &font->vertices[ font->quads * 4 ];
+            quad[ 0 ] = (SDL_Vertex){ { left, top }, color, { u0, v0 } };
+            quad[ 1 ] = (SDL_Vertex){ { right, top }, color, { u1, v0 } };
+            quad[ 2 ] = (SDL_Vertex){ { right, bottom }, color, { u1, v1 } };
+            quad[ 3 ] = (SDL_Vertex){ { left, bottom }, color, { u0, v1 } };
+            font->quads++;
+        }
+        pen += glyph->advance;
+    }
+    return 0;
+}
+
+/*
+ * Draw the queued text as one geometry command and empty the queue.
+ */
+int
+hudFontRender( HudFont* font )
+{
+    if( font->quads == 0 )
+    {
+        return 0;
+    }
+    const int result = SDL_RenderGeometry( font->renderer, font->atlas, font->vertices, font->quads * 4,
+                                           font->indices, font->quads * 6 );
+    font->quads = 0;
+    return result;
+}
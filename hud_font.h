@@ -0,0 +1,50 @@
+#ifndef HUD_FONT_H
+#define HUD_FONT_H
+
+#include <SDL.h>
+
+/**************************************************************************
+** The HUD font, rasterized at build time by tetris_font_bake and compiled
+** into the binary (hud_font_data.h), so startup neither loads FreeType nor
+** opens a font file. Only the glyphs the HUD uses are baked. Text is queued
+** like an SDL_ttf atlas: every string is stretched over its destination and
+** all queued strings are drawn with one SDL_RenderGeometry call.
+**************************************************************************/
+
+#define HUD_FONT_MAX_QUADS      64      /**< Glyphs that can be queued between renders */
+
+typedef struct HudGlyph
+{
+    char            codepoint;
+    Uint16          x;                  /**< Position in the atlas */
+    Uint16          y;
+    Uint8           width;
+    Uint8           height;
+    Sint8           left;               /**< Offset from the pen position to the bitmap */
+    Sint8           top;                /**< Offset from the top of the line to the bitmap */
+    Uint8           advance;
+} HudGlyph;
+
+typedef struct HudFont
+{
+    SDL_Renderer*   renderer;
+    SDL_Texture*    atlas;              /**< White glyphs, coverage in alpha */
+    const HudGlyph* glyphs[ 128 ];      /**< By codepoint, NULL when not baked */
+    int             quads;              /**< Glyphs queued since the last render */
+    SDL_Vertex      vertices[ HUD_FONT_MAX_QUADS * 4 ];
+    int             indices[ HUD_FONT_MAX_QUADS * 6 ];
+} HudFont;
+
+HudFont*
+hudFontCreate( SDL_Renderer* renderer );
+
+void
+hudFontDestroy( HudFont* font );
+
+int
+hudFontAddText( HudFont* font, const char* text, const SDL_FRect* dstrect, SDL_Color color );
+
+int
+hudFontRender( HudFont* font );
+
+#endif //HUD_FONT_H
@@ -0,0 +1,452 @@
+//
+// Generated by tetris_font_bake from DejaVuSans.ttf at 24 px, do not edit.
+//
+
+#ifndef HUD_FONT_DATA_H
+#define HUD_FONT_DATA_H
+
+#define HUD_FONT_LINE_HEIGHT    28
+#define HUD_FONT_ATLAS_WIDTH    256
+#define HUD_FONT_ATLAS_HEIGHT   67
+#define HUD_FONT_GLYPH_COUNT    41
+
+/* codepoint, x, y, width, height, left, top, advance */
+static const HudGlyph HUD_FONT_GLYPHS[ HUD_FONT_GLYPH_COUNT ] =
+{
+    { ' ',   1,   1,  0,  0,  0,  0,  8 },
+    { '-',   3,   1,  7,  2,  1, 15,  9 },
+    { '.',  12,   1,  4,  3,  2, 20,  8 },
+    { '/',  18,   1,  9, 20,  0,  5,  8 },
+    { '0',  29,   1, 13, 18,  1,  5, 15 },
+    { '1',  44,   1, 12, 18,  2,  5, 15 },
+    { '2',  58,   1, 12, 18,  1,  5, 15 },
+    { '3',  72,   1, 13, 18,  1,  5, 15 },
+    { '4',  87,   1, 13, 18,  1,  5, 15 },
+    { '5', 102,   1, 13, 18,  1,  5, 15 },
+    { '6', 117,   1, 13, 18,  1,  5, 15 },
+    { '7', 132,   1, 13, 18,  1,  5, 15 },
+    { '8', 147,   1, 13, 18,  1,  5, 15 },
+    { '9', 162,   1, 13, 18,  1,  5, 15 },
+    { ':', 177,   1,  4, 12,  2, 11,  8 },
+    { 'A', 183,   1, 17, 18,  0,  5, 16 },
+    { 'B', 202,   1, 13, 18,  2,  5, 16 },
+    { 'C', 217,   1, 15, 18,  1,  5, 17 },
+    { 'D', 234,   1, 16, 18,  2,  5, 18 },
+    { 'E',   1,  23, 12, 18,  2,  5, 15 },
+    { 'F',  15,  23, 11, 18,  2,  5, 14 },
+    { 'G',  28,  23, 16, 18,  1,  5, 19 },
+    { 'H',  46,  23, 14, 18,  2,  5, 18 },
+    { 'I',  62,  23,  3, 18,  2,  5,  7 },
+    { 'J',  67,  23,  7, 23, -2,  5,  7 },
+    { 'K',  76,  23, 15, 18,  2,  5, 16 },
+    { 'L',  93,  23, 12, 18,  2,  5, 13 },
+    { 'M', 107,  23, 17, 18,  2,  5, 21 },
+    { 'N', 126,  23, 14, 18,  2,  5, 18 },
+    { 'O', 142,  23, 17, 18,  1,  5, 19 },
+    { 'P', 161,  23, 12, 18,  2,  5, 14 },
+    { 'Q', 175,  23, 17, 21,  1,  5, 19 },
+    { 'R', 194,  23, 14, 18,  2,  5, 17 },
+    { 'S', 210,  23, 13, 18,  1,  5, 15 },
+    { 'T', 225,  23, 16, 18, -1,  5, 15 },
+    { 'U',   1,  48, 14, 18,  2,  5, 18 },
+    { 'V',  17,  48, 17, 18,  0,  5, 16 },
+    { 'W',  36,  48, 23, 18,  0,  5, 24 },
+    { 'X',  61,  48, 16, 18,  0,  5, 16 },
+    { 'Y',  79,  48, 15, 18,  0,  5, 15 },
+    { 'Z',  96,  48, 15, 18,  1,  5, 16 },
+};
+
+static const unsigned char HUD_FONT_BITMAPS[] =
+{
+    212,255,255,255,255,255,124,212,255,255,255,255,255,124,112,255,255,12,112,255,255,12,112,255,
+    255,12,0,0,0,0,0,19,252,236,3,0,0,0,0,0,94,255,162,0,0,0,0,0,
+    0,172,255,84,0,0,0,0,0,6,242,249,13,0,0,0,0,0,72,255,184,0,0,0,
+    0,0,0,150,255,106,0,0,0,0,0,0,226,255,29,0,0,0,0,0,50,255,206,0,
+    0,0,0,0,0,128,255,128,0,0,0,0,0,0,206,255,50,0,0,0,0,0,28,255,
+    227,0,0,0,0,0,0,106,255,150,0,0,0,0,0,0,184,255,72,0,0,0,0,0,
+    12,248,243,7,0,0,0,0,0,84,255,172,0,0,0,0,0,0,162,255,94,0,0,0,
+    0,0,3,236,252,19,0,0,0,0,0,62,255,194,0,0,0,0,0,0,140,255,116,0,
+    0,0,0,0,0,217,255,38,0,0,0,0,0,0,0,0,0,29,150,223,248,232,173,57,
+    0,0,0,0,0,55,239,255,255,255,255,255,252,102,0,0,0,13,231,255,214,61,8,38,
+    171,255,252,52,0,0,124,255,243,29,0,0,0,2,199,255,185,0,0,215,255,150,0,0,
+    0,0,0,79,255,253,22,24,255,255,77,0,0,0,0,0,11,251,255,86,66,255,255,33,
+    0,0,0,0,0,0,218,255,128,91,255,255,6,0,0,0,0,0,0,191,255,153,102,255,
+    252,0,0,0,0,0,0,0,181,255,165,103,255,251,0,0,0,0,0,0,0,181,255,165,
+    91,255,255,6,0,0,0,0,0,0,191,255,153,66,255,255,33,0,0,0,0,0,0,218,
+    255,128,24,255,255,77,0,0,0,0,0,10,251,255,86,0,215,255,150,0,0,0,0,0,
+    79,255,253,23,0,126,255,243,29,0,0,0,2,198,255,186,0,0,15,233,255,214,61,8,
+    37,171,255,252,54,0,0,0,57,241,255,255,255,255,255,253,105,0,0,0,0,0,30,152,
+    224,249,234,174,58,0,0,0,3,52,113,174,234,255,255,48,0,0,0,0,92,255,255,255,
+    255,255,255,48,0,0,0,0,88,204,143,82,61,255,255,48,0,0,0,0,0,0,0,0,
+    40,255,255,48,0,0,0,0,0,0,0,0,40,255,255,48,0,0,0,0,0,0,0,0,
+    40,255,255,48,0,0,0,0,0,0,0,0,40,255,255,48,0,0,0,0,0,0,0,0,
+    40,255,255,48,0,0,0,0,0,0,0,0,40,255,255,48,0,0,0,0,0,0,0,0,
+    40,255,255,48,0,0,0,0,0,0,0,0,40,255,255,48,0,0,0,0,0,0,0,0,
+    40,255,255,48,0,0,0,0,0,0,0,0,40,255,255,48,0,0,0,0,0,0,0,0,
+    40,255,255,48,0,0,0,0,0,0,0,0,40,255,255,48,0,0,0,0,0,0,0,0,
+    40,255,255,48,0,0,0,0,4,255,255,255,255,255,255,255,255,255,255,16,4,255,255,255,
+    255,255,255,255,255,255,255,16,0,44,116,183,218,245,244,211,140,30,0,0,32,255,255,255,
+    255,255,255,255,255,242,74,0,31,211,138,70,37,10,26,94,231,255,246,32,0,0,0,0,
+    0,0,0,0,46,248,255,137,0,0,0,0,0,0,0,0,0,190,255,186,0,0,0,0,
+    0,0,0,0,0,167,255,188,0,0,0,0,0,0,0,0,2,225,255,143,0,0,0,0,
+    0,0,0,0,103,255,253,46,0,0,0,0,0,0,0,44,244,255,146,0,0,0,0,0,
+    0,0,26,222,255,201,7,0,0,0,0,0,0,20,213,255,210,18,0,0,0,0,0,0,
+    17,207,255,217,23,0,0,0,0,0,0,14,202,255,223,28,0,0,0,0,0,0,12,198,
+    255,228,33,0,0,0,0,0,0,9,192,255,232,38,0,0,0,0,0,0,7,185,255,235,
+    43,0,0,0,0,0,0,0,60,255,255,255,255,255,255,255,255,255,255,224,60,255,255,255,
+    255,255,255,255,255,255,255,224,0,15,86,162,209,238,249,225,166,60,0,0,0,0,164,255,
+    255,255,255,255,255,255,255,133,0,0,0,145,155,84,43,12,20,66,194,255,255,85,0,0,
+    0,0,0,0,0,0,0,8,213,255,190,0,0,0,0,0,0,0,0,0,0,134,255,230,
+    0,0,0,0,0,0,0,0,0,0,129,255,214,0,0,0,0,0,0,0,0,0,4,204,
+    255,149,0,0,0,0,0,0,0,15,57,180,255,225,25,0,0,0,0,36,255,255,255,255,
+    249,154,26,0,0,0,0,0,36,255,255,255,255,255,208,89,0,0,0,0,0,0,0,0,
+    18,53,153,253,255,116,0,0,0,0,0,0,0,0,0,0,113,255,246,20,0,0,0,0,
+    0,0,0,0,0,15,255,255,68,0,0,0,0,0,0,0,0,0,19,255,255,73,0,0,
+    0,0,0,0,0,0,0,123,255,253,25,42,195,106,50,24,4,15,60,157,255,255,161,0,
+    44,255,255,255,255,255,255,255,255,255,176,10,0,1,54,134,198,228,251,243,214,160,68,0,
+    0,0,0,0,0,0,0,0,6,214,255,255,108,0,0,0,0,0,0,0,0,125,255,255,
+    255,108,0,0,0,0,0,0,0,37,247,217,240,255,108,0,0,0,0,0,0,0,189,255,
+    69,236,255,108,0,0,0,0,0,0,95,255,169,0,236,255,108,0,0,0,0,0,19,235,
+    242,26,0,236,255,108,0,0,0,0,0,160,255,113,0,0,236,255,108,0,0,0,0,65,
+    255,209,4,0,0,236,255,108,0,0,0,7,217,254,58,0,0,0,236,255,108,0,0,0,
+    130,255,157,0,0,0,0,236,255,108,0,0,40,249,237,20,0,0,0,0,236,255,108,0,
+    0,182,255,101,0,0,0,0,0,236,255,108,0,0,212,255,255,255,255,255,255,255,255,255,
+    255,255,236,212,255,255,255,255,255,255,255,255,255,255,255,236,0,0,0,0,0,0,0,0,
+    236,255,108,0,0,0,0,0,0,0,0,0,0,236,255,108,0,0,0,0,0,0,0,0,
+    0,0,236,255,108,0,0,0,0,0,0,0,0,0,0,236,255,108,0,0,0,104,255,255,
+    255,255,255,255,255,255,228,0,0,0,104,255,255,255,255,255,255,255,255,228,0,0,0,104,
+    255,196,0,0,0,0,0,0,0,0,0,0,104,255,196,0,0,0,0,0,0,0,0,0,
+    0,104,255,196,0,0,0,0,0,0,0,0,0,0,104,255,196,0,0,0,0,0,0,0,
+    0,0,0,104,255,236,211,247,242,210,139,29,0,0,0,0,104,255,255,255,255,255,255,255,
+    242,78,0,0,0,94,153,71,31,6,28,102,231,255,248,48,0,0,0,0,0,0,0,0,
+    0,29,233,255,179,0,0,0,0,0,0,0,0,0,0,117,255,248,7,0,0,0,0,0,
+    0,0,0,0,59,255,255,33,0,0,0,0,0,0,0,0,0,59,255,255,32,0,0,0,
+    0,0,0,0,0,0,117,255,248,7,0,0,0,0,0,0,0,0,28,232,255,181,0,35,
+    199,111,51,24,5,27,100,230,255,248,50,0,36,255,255,255,255,255,255,255,255,241,79,0,
+    0,0,52,134,199,229,250,239,201,130,25,0,0,0,0,0,0,0,36,144,215,244,235,197,
+    114,19,0,0,0,0,101,247,255,255,255,255,255,255,160,0,0,0,92,254,255,168,58,12,
+    9,50,138,139,0,0,24,240,255,134,0,0,0,0,0,0,0,0,0,131,255,219,4,0,
+    0,0,0,0,0,0,0,0,222,255,124,0,0,0,0,0,0,0,0,0,23,255,255,62,
+    59,181,238,246,214,137,21,0,0,60,255,255,119,252,255,255,255,255,255,229,43,0,76,255,
+    255,251,223,77,10,16,96,241,255,217,5,78,255,255,252,44,0,0,0,0,84,255,255,89,
+    66,255,255,179,0,0,0,0,0,0,220,255,157,40,255,255,137,0,0,0,0,0,0,178,
+    255,186,4,248,255,137,0,0,0,0,0,0,179,255,185,0,185,255,179,0,0,0,0,0,
+    0,220,255,154,0,92,255,252,44,0,0,0,0,84,255,255,81,0,2,206,255,223,76,10,
+    15,95,240,255,205,2,0,0,30,223,255,255,255,255,255,255,218,31,0,0,0,0,13,129,
+    212,245,244,207,123,13,0,0,8,255,255,255,255,255,255,255,255,255,255,255,56,8,255,255,
+    255,255,255,255,255,255,255,255,248,18,0,0,0,0,0,0,0,0,0,208,255,171,0,0,
+    0,0,0,0,0,0,0,47,255,255,75,0,0,0,0,0,0,0,0,0,144,255,231,3,
+    0,0,0,0,0,0,0,0,5,234,255,140,0,0,0,0,0,0,0,0,0,79,255,255,
+    44,0,0,0,0,0,0,0,0,0,175,255,204,0,0,0,0,0,0,0,0,0,20,250,
+    255,109,0,0,0,0,0,0,0,0,0,111,255,249,19,0,0,0,0,0,0,0,0,0,
+    206,255,173,0,0,0,0,0,0,0,0,0,45,255,255,77,0,0,0,0,0,0,0,0,
+    0,142,255,233,4,0,0,0,0,0,0,0,0,4,232,255,142,0,0,0,0,0,0,0,
+    0,0,77,255,255,46,0,0,0,0,0,0,0,0,0,173,255,207,0,0,0,0,0,0,
+    0,0,0,19,249,255,111,0,0,0,0,0,0,0,0,0,108,255,250,21,0,0,0,0,
+    0,0,0,0,0,82,181,233,251,240,200,116,9,0,0,0,2,164,255,255,255,255,255,255,
+    255,212,22,0,0,105,255,255,168,46,10,33,127,251,255,172,0,0,202,255,197,1,0,0,
+    0,0,133,255,252,16,0,236,255,121,0,0,0,0,0,54,255,255,48,0,217,255,120,0,
+    0,0,0,0,54,255,255,28,0,150,255,196,1,0,0,0,0,132,255,217,1,0,26,225,
+    255,166,44,9,31,124,251,249,71,0,0,0,26,154,249,255,255,255,255,186,58,0,0,0,
+    0,83,204,255,255,255,255,255,227,124,3,0,0,112,255,251,135,39,9,29,99,230,255,175,
+    0,21,245,255,118,0,0,0,0,0,50,252,255,74,73,255,255,28,0,0,0,0,0,0,
+    213,255,136,86,255,255,28,0,0,0,0,0,0,213,255,149,46,255,255,118,0,0,0,0,
+    0,50,252,255,109,0,202,255,251,134,39,8,28,98,230,255,242,22,0,36,224,255,255,255,
+    255,255,255,255,244,75,0,0,0,13,118,196,238,252,243,210,141,32,0,0,0,0,1,87,
+    187,237,248,223,153,35,0,0,0,0,4,170,255,255,255,255,255,255,244,69,0,0,0,134,
+    255,254,134,29,6,49,187,255,242,27,0,17,246,255,149,0,0,0,0,6,221,255,153,0,
+    82,255,255,31,0,0,0,0,0,109,255,241,6,114,255,245,0,0,0,0,0,0,66,255,
+    255,59,115,255,244,0,0,0,0,0,0,67,255,255,102,87,255,255,30,0,0,0,0,0,
+    108,255,255,128,24,251,255,147,0,0,0,0,6,220,255,255,141,0,155,255,254,132,28,5,
+    48,185,255,251,255,139,0,11,195,255,255,255,255,255,255,156,216,255,123,0,0,5,107,199,
+    242,246,203,97,5,247,255,86,0,0,0,0,0,0,0,0,0,57,255,255,30,0,0,0,
+    0,0,0,0,0,0,159,255,195,0,0,0,0,0,0,0,0,0,72,253,255,74,0,0,
+    84,163,68,25,7,39,131,248,255,157,0,0,0,92,255,255,255,255,255,255,255,158,3,0,
+    0,0,6,88,181,226,248,227,168,67,0,0,0,0,48,255,255,72,48,255,255,72,48,255,
+    255,72,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,48,255,255,72,48,255,255,72,48,255,255,72,0,0,0,0,0,0,80,255,255,186,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,175,255,255,253,28,0,0,0,0,0,0,
+    0,0,0,0,0,19,250,255,237,255,120,0,0,0,0,0,0,0,0,0,0,0,109,255,
+    223,121,255,215,0,0,0,0,0,0,0,0,0,0,0,204,255,137,33,255,255,54,0,0,
+    0,0,0,0,0,0,0,43,255,255,50,0,202,255,149,0,0,0,0,0,0,0,0,0,
+    138,255,220,0,0,115,255,237,6,0,0,0,0,0,0,0,3,230,255,133,0,0,29,254,
+    255,83,0,0,0,0,0,0,0,73,255,255,46,0,0,0,197,255,178,0,0,0,0,0,
+    0,0,168,255,216,0,0,0,0,110,255,251,21,0,0,0,0,0,15,247,255,129,0,0,
+    0,0,25,253,255,111,0,0,0,0,0,102,255,255,43,0,0,0,0,0,192,255,206,0,
+    0,0,0,0,197,255,255,255,255,255,255,255,255,255,255,255,45,0,0,0,36,255,255,255,
+    255,255,255,255,255,255,255,255,255,140,0,0,0,131,255,251,25,0,0,0,0,0,0,0,
+    162,255,231,3,0,1,224,255,174,0,0,0,0,0,0,0,0,60,255,255,74,0,65,255,
+    255,72,0,0,0,0,0,0,0,0,0,213,255,169,0,160,255,224,2,0,0,0,0,0,
+    0,0,0,0,111,255,248,16,164,255,255,255,255,255,253,236,190,101,3,0,0,164,255,255,
+    255,255,255,255,255,255,255,192,10,0,164,255,184,0,0,0,9,43,154,255,255,135,0,164,
+    255,184,0,0,0,0,0,0,181,255,226,0,164,255,184,0,0,0,0,0,0,109,255,255,
+    5,164,255,184,0,0,0,0,0,0,109,255,245,0,164,255,184,0,0,0,0,0,0,179,
+    255,196,0,164,255,184,0,0,0,8,42,150,255,252,73,0,164,255,255,255,255,255,255,255,
+    255,194,70,0,0,164,255,255,255,255,255,255,255,255,241,150,11,0,164,255,184,0,0,0,
+    3,28,87,218,255,202,4,164,255,184,0,0,0,0,0,0,36,250,255,102,164,255,184,0,
+    0,0,0,0,0,0,210,255,165,164,255,184,0,0,0,0,0,0,0,211,255,187,164,255,
+    184,0,0,0,0,0,0,37,250,255,153,164,255,184,0,0,0,3,27,87,218,255,254,56,
+    164,255,255,255,255,255,255,255,255,255,252,112,0,164,255,255,255,255,255,255,245,213,151,46,
+    0,0,0,0,0,0,11,108,181,226,247,242,213,150,50,0,0,0,0,0,82,233,255,255,
+    255,255,255,255,255,255,167,18,0,0,103,254,255,226,111,41,11,10,37,100,200,255,116,0,
+    52,250,255,186,12,0,0,0,0,0,0,0,84,97,0,187,255,227,15,0,0,0,0,0,
+    0,0,0,0,0,34,255,255,114,0,0,0,0,0,0,0,0,0,0,0,99,255,255,33,
+    0,0,0,0,0,0,0,0,0,0,0,140,255,241,0,0,0,0,0,0,0,0,0,0,
+    0,0,159,255,223,0,0,0,0,0,0,0,0,0,0,0,0,159,255,223,0,0,0,0,
+    0,0,0,0,0,0,0,0,140,255,241,0,0,0,0,0,0,0,0,0,0,0,0,99,
+    255,255,33,0,0,0,0,0,0,0,0,0,0,0,35,255,255,114,0,0,0,0,0,0,
+    0,0,0,0,0,0,188,255,227,15,0,0,0,0,0,0,0,0,0,0,0,54,250,255,
+    186,12,0,0,0,0,0,0,0,83,97,0,0,106,254,255,225,111,39,10,9,37,99,200,
+    255,116,0,0,0,85,235,255,255,255,255,255,255,255,255,166,17,0,0,0,0,12,109,183,
+    228,248,243,213,149,48,0,0,164,255,255,255,255,251,236,219,174,119,29,0,0,0,0,0,
+    164,255,255,255,255,255,255,255,255,255,252,161,15,0,0,0,164,255,184,0,0,1,15,41,
+    98,197,255,255,219,20,0,0,164,255,184,0,0,0,0,0,0,0,103,253,255,185,0,0,
+    164,255,184,0,0,0,0,0,0,0,0,133,255,255,61,0,164,255,184,0,0,0,0,0,
+    0,0,0,15,244,255,152,0,164,255,184,0,0,0,0,0,0,0,0,0,184,255,213,0,
+    164,255,184,0,0,0,0,0,0,0,0,0,137,255,245,0,164,255,184,0,0,0,0,0,
+    0,0,0,0,119,255,255,7,164,255,184,0,0,0,0,0,0,0,0,0,121,255,255,6,
+    164,255,184,0,0,0,0,0,0,0,0,0,138,255,244,0,164,255,184,0,0,0,0,0,
+    0,0,0,0,185,255,211,0,164,255,184,0,0,0,0,0,0,0,0,16,244,255,150,0,
+    164,255,184,0,0,0,0,0,0,0,0,134,255,255,60,0,164,255,184,0,0,0,0,0,
+    0,0,102,253,255,184,0,0,164,255,184,0,0,1,14,41,98,196,255,255,219,20,0,0,
+    164,255,255,255,255,255,255,255,255,255,253,162,16,0,0,0,164,255,255,255,255,251,238,220,
+    175,119,29,0,0,0,0,0,164,255,255,255,255,255,255,255,255,255,255,108,164,255,255,255,
+    255,255,255,255,255,255,255,108,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,
+    0,0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,
+    0,0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,
+    0,0,0,0,0,0,0,0,164,255,255,255,255,255,255,255,255,255,255,16,164,255,255,255,
+    255,255,255,255,255,255,255,16,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,
+    0,0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,
+    0,0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,
+    0,0,0,0,0,0,0,0,164,255,255,255,255,255,255,255,255,255,255,160,164,255,255,255,
+    255,255,255,255,255,255,255,160,164,255,255,255,255,255,255,255,255,255,104,164,255,255,255,255,
+    255,255,255,255,255,104,164,255,184,0,0,0,0,0,0,0,0,164,255,184,0,0,0,0,
+    0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,
+    0,0,164,255,184,0,0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,
+    164,255,255,255,255,255,255,255,255,168,0,164,255,255,255,255,255,255,255,255,168,0,164,255,
+    184,0,0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,164,255,184,0,
+    0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,164,255,184,0,0,0,
+    0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,
+    0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,0,0,0,10,103,175,224,244,247,
+    226,175,103,12,0,0,0,0,0,82,232,255,255,255,255,255,255,255,255,240,108,2,0,0,
+    106,254,255,228,117,47,15,6,25,73,145,240,255,44,0,56,251,255,185,13,0,0,0,0,
+    0,0,0,13,145,41,0,190,255,224,14,0,0,0,0,0,0,0,0,0,0,0,36,255,
+    255,110,0,0,0,0,0,0,0,0,0,0,0,0,100,255,255,32,0,0,0,0,0,0,
+    0,0,0,0,0,0,141,255,241,0,0,0,0,0,0,0,0,0,0,0,0,0,159,255,
+    223,0,0,0,0,0,0,148,255,255,255,255,255,160,159,255,223,0,0,0,0,0,0,148,
+    255,255,255,255,255,160,141,255,241,0,0,0,0,0,0,0,0,0,0,184,255,160,100,255,
+    255,31,0,0,0,0,0,0,0,0,0,184,255,160,36,255,255,110,0,0,0,0,0,0,
+    0,0,0,184,255,160,0,190,255,223,13,0,0,0,0,0,0,0,0,184,255,160,0,56,
+    251,255,182,12,0,0,0,0,0,0,0,184,255,160,0,0,106,254,255,226,116,46,14,3,
+    19,66,162,248,255,159,0,0,0,82,233,255,255,255,255,255,255,255,255,253,166,25,0,0,
+    0,0,10,104,176,224,245,248,230,188,126,33,0,0,164,255,184,0,0,0,0,0,0,0,
+    0,172,255,176,164,255,184,0,0,0,0,0,0,0,0,172,255,176,164,255,184,0,0,0,
+    0,0,0,0,0,172,255,176,164,255,184,0,0,0,0,0,0,0,0,172,255,176,164,255,
+    184,0,0,0,0,0,0,0,0,172,255,176,164,255,184,0,0,0,0,0,0,0,0,172,
+    255,176,164,255,184,0,0,0,0,0,0,0,0,172,255,176,164,255,184,0,0,0,0,0,
+    0,0,0,172,255,176,164,255,255,255,255,255,255,255,255,255,255,255,255,176,164,255,255,255,
+    255,255,255,255,255,255,255,255,255,176,164,255,184,0,0,0,0,0,0,0,0,172,255,176,
+    164,255,184,0,0,0,0,0,0,0,0,172,255,176,164,255,184,0,0,0,0,0,0,0,
+    0,172,255,176,164,255,184,0,0,0,0,0,0,0,0,172,255,176,164,255,184,0,0,0,
+    0,0,0,0,0,172,255,176,164,255,184,0,0,0,0,0,0,0,0,172,255,176,164,255,
+    184,0,0,0,0,0,0,0,0,172,255,176,164,255,184,0,0,0,0,0,0,0,0,172,
+    255,176,164,255,184,164,255,184,164,255,184,164,255,184,164,255,184,164,255,184,164,255,184,164,
+    255,184,164,255,184,164,255,184,164,255,184,164,255,184,164,255,184,164,255,184,164,255,184,164,
+    255,184,164,255,184,164,255,184,0,0,0,0,164,255,184,0,0,0,0,164,255,184,0,0,
+    0,0,164,255,184,0,0,0,0,164,255,184,0,0,0,0,164,255,184,0,0,0,0,164,
+    255,184,0,0,0,0,164,255,184,0,0,0,0,164,255,184,0,0,0,0,164,255,184,0,
+    0,0,0,164,255,184,0,0,0,0,164,255,184,0,0,0,0,164,255,184,0,0,0,0,
+    164,255,184,0,0,0,0,164,255,184,0,0,0,0,164,255,184,0,0,0,0,164,255,184,
+    0,0,0,0,164,255,183,0,0,0,0,170,255,174,0,0,0,0,195,255,154,0,0,0,
+    13,245,255,108,0,5,44,186,255,251,28,64,255,255,255,255,123,0,64,254,240,192,86,0,
+    0,164,255,184,0,0,0,0,0,0,25,214,255,235,48,0,164,255,184,0,0,0,0,0,
+    29,219,255,231,42,0,0,164,255,184,0,0,0,0,33,223,255,227,38,0,0,0,164,255,
+    184,0,0,0,37,227,255,223,33,0,0,0,0,164,255,184,0,0,42,231,255,218,28,0,
+    0,0,0,0,164,255,184,0,47,234,255,213,24,0,0,0,0,0,0,164,255,184,52,238,
+    255,208,21,0,0,0,0,0,0,0,164,255,221,240,255,202,17,0,0,0,0,0,0,0,
+    0,164,255,255,255,255,51,0,0,0,0,0,0,0,0,0,164,255,218,238,255,226,32,0,
+    0,0,0,0,0,0,0,164,255,184,52,241,255,222,28,0,0,0,0,0,0,0,164,255,
+    184,0,58,243,255,218,24,0,0,0,0,0,0,164,255,184,0,0,63,245,255,213,21,0,
+    0,0,0,0,164,255,184,0,0,0,69,248,255,208,18,0,0,0,0,164,255,184,0,0,
+    0,0,75,249,255,203,15,0,0,0,164,255,184,0,0,0,0,0,81,251,255,198,12,0,
+    0,164,255,184,0,0,0,0,0,0,87,252,255,193,10,0,164,255,184,0,0,0,0,0,
+    0,0,94,253,255,187,8,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,0,
+    0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,0,
+    0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,0,
+    0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,0,
+    0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,0,
+    0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,0,
+    0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,0,
+    0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,0,
+    0,0,0,0,0,0,0,164,255,255,255,255,255,255,255,255,255,255,64,164,255,255,255,255,
+    255,255,255,255,255,255,64,164,255,255,251,21,0,0,0,0,0,0,0,86,255,255,255,92,
+    164,255,255,255,107,0,0,0,0,0,0,0,177,255,255,255,92,164,255,231,255,197,0,0,
+    0,0,0,0,18,249,241,245,255,92,164,255,170,229,254,32,0,0,0,0,0,103,255,159,
+    240,255,92,164,255,168,141,255,121,0,0,0,0,0,194,255,68,240,255,92,164,255,168,51,
+    255,211,0,0,0,0,30,254,231,3,240,255,92,164,255,168,0,215,255,46,0,0,0,120,
+    255,143,0,240,255,92,164,255,168,0,125,255,136,0,0,0,211,255,52,0,240,255,92,164,
+    255,168,0,35,255,224,1,0,47,255,217,0,0,240,255,92,164,255,168,0,0,199,255,60,
+    0,138,255,126,0,0,240,255,92,164,255,168,0,0,109,255,150,1,227,255,36,0,0,240,
+    255,92,164,255,168,0,0,22,251,235,69,255,201,0,0,0,240,255,92,164,255,168,0,0,
+    0,183,255,218,255,110,0,0,0,240,255,92,164,255,168,0,0,0,92,255,255,252,23,0,
+    0,0,240,255,92,164,255,168,0,0,0,12,245,255,185,0,0,0,0,240,255,92,164,255,
+    168,0,0,0,0,0,0,0,0,0,0,0,240,255,92,164,255,168,0,0,0,0,0,0,
+    0,0,0,0,0,240,255,92,164,255,168,0,0,0,0,0,0,0,0,0,0,0,240,255,
+    92,164,255,255,204,0,0,0,0,0,0,0,180,255,152,164,255,255,255,81,0,0,0,0,
+    0,0,180,255,152,164,255,255,255,210,1,0,0,0,0,0,180,255,152,164,255,192,246,255,
+    88,0,0,0,0,0,180,255,152,164,255,168,139,255,216,3,0,0,0,0,180,255,152,164,
+    255,168,20,242,255,96,0,0,0,0,180,255,152,164,255,168,0,131,255,222,5,0,0,0,
+    180,255,152,164,255,168,0,16,239,255,103,0,0,0,180,255,152,164,255,168,0,0,124,255,
+    227,7,0,0,180,255,152,164,255,168,0,0,12,235,255,111,0,0,180,255,152,164,255,168,
+    0,0,0,116,255,232,10,0,180,255,152,164,255,168,0,0,0,9,231,255,118,0,180,255,
+    152,164,255,168,0,0,0,0,109,255,236,13,180,255,152,164,255,168,0,0,0,0,6,225,
+    255,126,180,255,152,164,255,168,0,0,0,0,0,101,255,240,197,255,152,164,255,168,0,0,
+    0,0,0,4,220,255,255,255,152,164,255,168,0,0,0,0,0,0,94,255,255,255,152,164,
+    255,168,0,0,0,0,0,0,2,214,255,255,152,0,0,0,0,22,125,198,233,249,231,192,
+    117,15,0,0,0,0,0,0,0,99,242,255,255,255,255,255,255,255,235,79,0,0,0,0,
+    0,114,255,255,216,92,25,6,29,102,227,255,252,89,0,0,0,57,252,255,184,8,0,0,
+    0,0,0,16,204,255,243,36,0,0,190,255,230,16,0,0,0,0,0,0,0,31,244,255,
+    161,0,36,255,255,118,0,0,0,0,0,0,0,0,0,147,255,250,13,100,255,255,36,0,
+    0,0,0,0,0,0,0,0,64,255,255,70,141,255,242,0,0,0,0,0,0,0,0,0,
+    0,16,255,255,111,159,255,223,0,0,0,0,0,0,0,0,0,0,0,251,255,130,160,255,
+    223,0,0,0,0,0,0,0,0,0,0,0,251,255,130,141,255,242,0,0,0,0,0,0,
+    0,0,0,0,16,255,255,112,100,255,255,35,0,0,0,0,0,0,0,0,0,64,255,255,
+    70,37,255,255,117,0,0,0,0,0,0,0,0,0,147,255,250,13,0,192,255,229,15,0,
+    0,0,0,0,0,0,30,243,255,161,0,0,59,252,255,181,7,0,0,0,0,0,15,201,
+    255,245,37,0,0,0,118,255,255,214,91,24,6,28,100,225,255,253,92,0,0,0,0,0,
+    102,243,255,255,255,255,255,255,255,236,82,0,0,0,0,0,0,0,23,126,199,235,250,233,
+    194,118,16,0,0,0,0,164,255,255,255,255,255,243,213,149,40,0,0,164,255,255,255,255,
+    255,255,255,255,249,89,0,164,255,184,0,0,1,28,97,233,255,247,29,164,255,184,0,0,
+    0,0,0,65,255,255,117,164,255,184,0,0,0,0,0,0,238,255,157,164,255,184,0,0,
+    0,0,0,0,238,255,156,164,255,184,0,0,0,0,0,65,255,255,117,164,255,184,0,0,
+    1,27,97,233,255,248,30,164,255,255,255,255,255,255,255,255,250,92,0,164,255,255,255,255,
+    255,245,214,151,42,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,0,
+    0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,0,
+    0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,0,
+    0,0,0,0,0,0,0,164,255,184,0,0,0,0,0,0,0,0,0,164,255,184,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,22,125,198,233,249,232,193,118,15,0,0,0,0,
+    0,0,0,99,242,255,255,255,255,255,255,255,236,81,0,0,0,0,0,114,255,255,216,92,
+    25,6,29,102,227,255,253,92,0,0,0,57,252,255,184,8,0,0,0,0,0,16,204,255,
+    245,38,0,0,190,255,230,16,0,0,0,0,0,0,0,31,244,255,163,0,36,255,255,118,
+    0,0,0,0,0,0,0,0,0,147,255,250,14,100,255,255,36,0,0,0,0,0,0,0,
+    0,0,64,255,255,71,141,255,242,0,0,0,0,0,0,0,0,0,0,16,255,255,112,159,
+    255,223,0,0,0,0,0,0,0,0,0,0,0,251,255,130,160,255,223,0,0,0,0,0,
+    0,0,0,0,0,0,251,255,132,141,255,242,0,0,0,0,0,0,0,0,0,0,16,255,
+    255,114,100,255,255,35,0,0,0,0,0,0,0,0,0,64,255,255,72,36,255,255,117,0,
+    0,0,0,0,0,0,0,0,147,255,247,11,0,191,255,229,15,0,0,0,0,0,0,0,
+    30,243,255,160,0,0,59,252,255,181,7,0,0,0,0,0,15,201,255,243,32,0,0,0,
+    118,255,255,214,91,24,6,28,100,225,255,252,81,0,0,0,0,0,102,243,255,255,255,255,
+    255,255,255,228,68,0,0,0,0,0,0,0,23,126,199,235,253,255,255,245,28,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,47,242,255,193,6,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,72,251,255,159,0,0,0,0,0,0,0,0,0,0,0,0,0,0,103,255,
+    255,120,0,0,164,255,255,255,255,255,244,216,156,50,0,0,0,0,164,255,255,255,255,255,
+    255,255,255,252,105,0,0,0,164,255,184,0,0,1,26,90,227,255,251,36,0,0,164,255,
+    184,0,0,0,0,0,56,255,255,121,0,0,164,255,184,0,0,0,0,0,0,236,255,158,
+    0,0,164,255,184,0,0,0,0,0,0,238,255,150,0,0,164,255,184,0,0,0,0,0,
+    59,255,255,105,0,0,164,255,184,0,0,1,25,91,228,255,230,12,0,0,164,255,255,255,
+    255,255,255,255,255,202,39,0,0,0,164,255,255,255,255,255,255,255,240,72,0,0,0,0,
+    164,255,184,0,0,8,47,171,255,250,60,0,0,0,164,255,184,0,0,0,0,1,182,255,
+    220,5,0,0,164,255,184,0,0,0,0,0,35,251,255,104,0,0,164,255,184,0,0,0,
+    0,0,0,161,255,223,4,0,164,255,184,0,0,0,0,0,0,45,255,255,90,0,164,255,
+    184,0,0,0,0,0,0,0,183,255,209,0,164,255,184,0,0,0,0,0,0,0,65,255,
+    255,72,164,255,184,0,0,0,0,0,0,0,0,202,255,192,0,0,5,101,186,233,250,235,
+    210,169,97,25,0,0,22,206,255,255,255,255,255,255,255,255,216,0,0,189,255,248,137,45,
+    13,14,42,81,155,189,0,46,255,255,90,0,0,0,0,0,0,0,0,0,95,255,254,5,
+    0,0,0,0,0,0,0,0,0,99,255,255,21,0,0,0,0,0,0,0,0,0,57,255,
+    255,161,8,0,0,0,0,0,0,0,0,1,202,255,255,237,165,108,52,4,0,0,0,0,
+    0,27,199,255,255,255,255,255,244,170,56,0,0,0,0,1,76,165,229,255,255,255,255,255,
+    126,0,0,0,0,0,0,0,28,83,162,250,255,255,76,0,0,0,0,0,0,0,0,0,
+    59,250,255,181,0,0,0,0,0,0,0,0,0,0,178,255,222,0,0,0,0,0,0,0,
+    0,0,0,160,255,218,0,0,0,0,0,0,0,0,0,18,233,255,171,83,198,129,67,39,
+    15,8,34,101,218,255,255,63,88,255,255,255,255,255,255,255,255,255,250,108,0,3,56,123,
+    184,215,240,251,238,202,138,37,0,0,20,255,255,255,255,255,255,255,255,255,255,255,255,255,
+    255,188,20,255,255,255,255,255,255,255,255,255,255,255,255,255,255,188,0,0,0,0,0,0,
+    0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,0,0,220,255,132,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,0,0,220,255,132,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,0,0,220,255,132,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,0,0,220,255,132,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,0,0,220,255,132,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,220,255,132,0,0,0,0,0,0,232,255,120,0,0,0,0,0,0,0,0,228,255,124,
+    232,255,120,0,0,0,0,0,0,0,0,228,255,124,232,255,120,0,0,0,0,0,0,0,
+    0,228,255,124,232,255,120,0,0,0,0,0,0,0,0,228,255,124,232,255,120,0,0,0,
+    0,0,0,0,0,228,255,124,232,255,120,0,0,0,0,0,0,0,0,228,255,124,232,255,
+    120,0,0,0,0,0,0,0,0,228,255,124,232,255,120,0,0,0,0,0,0,0,0,228,
+    255,124,232,255,120,0,0,0,0,0,0,0,0,228,255,124,232,255,120,0,0,0,0,0,
+    0,0,0,228,255,124,232,255,120,0,0,0,0,0,0,0,0,228,255,123,224,255,129,0,
+    0,0,0,0,0,0,0,239,255,114,204,255,157,0,0,0,0,0,0,0,12,254,255,94,
+    154,255,218,0,0,0,0,0,0,0,72,255,255,44,71,255,255,85,0,0,0,0,0,3,
+    193,255,216,1,1,192,255,248,123,35,5,12,64,188,255,255,82,0,0,23,202,255,255,255,
+    255,255,255,255,253,116,0,0,0,0,4,95,182,231,250,244,215,152,44,0,0,0,161,255,
+    214,0,0,0,0,0,0,0,0,0,0,107,255,248,16,65,255,255,52,0,0,0,0,0,
+    0,0,0,0,201,255,169,0,1,224,255,146,0,0,0,0,0,0,0,0,39,255,255,74,
+    0,0,131,255,234,4,0,0,0,0,0,0,0,133,255,231,3,0,0,36,255,255,77,0,
+    0,0,0,0,0,1,225,255,140,0,0,0,0,197,255,171,0,0,0,0,0,0,65,255,
+    255,45,0,0,0,0,102,255,248,16,0,0,0,0,0,159,255,206,0,0,0,0,0,15,
+    247,255,102,0,0,0,0,10,242,255,111,0,0,0,0,0,0,168,255,196,0,0,0,0,
+    91,255,251,22,0,0,0,0,0,0,73,255,255,34,0,0,0,185,255,178,0,0,0,0,
+    0,0,0,3,230,255,127,0,0,25,252,255,83,0,0,0,0,0,0,0,0,138,255,220,
+    0,0,117,255,237,6,0,0,0,0,0,0,0,0,43,255,255,58,0,210,255,149,0,0,
+    0,0,0,0,0,0,0,0,204,255,152,49,255,255,54,0,0,0,0,0,0,0,0,0,
+    0,109,255,238,150,255,215,0,0,0,0,0,0,0,0,0,0,0,20,250,255,253,255,120,
+    0,0,0,0,0,0,0,0,0,0,0,0,175,255,255,253,28,0,0,0,0,0,0,0,
+    0,0,0,0,0,80,255,255,187,0,0,0,0,0,0,0,22,255,255,78,0,0,0,0,
+    0,0,151,255,255,82,0,0,0,0,0,0,147,255,212,0,215,255,141,0,0,0,0,0,
+    0,213,255,255,144,0,0,0,0,0,0,209,255,149,0,152,255,203,0,0,0,0,0,19,
+    254,232,255,206,0,0,0,0,0,16,253,255,86,0,90,255,252,12,0,0,0,0,80,255,
+    158,216,253,14,0,0,0,0,77,255,255,24,0,27,255,255,71,0,0,0,0,141,255,97,
+    156,255,73,0,0,0,0,138,255,217,0,0,0,221,255,133,0,0,0,0,203,255,36,95,
+    255,135,0,0,0,0,200,255,154,0,0,0,158,255,195,0,0,0,12,251,231,0,35,255,
+    197,0,0,0,10,250,255,92,0,0,0,96,255,248,8,0,0,70,255,170,0,0,230,249,
+    9,0,0,68,255,255,29,0,0,0,34,255,255,63,0,0,131,255,108,0,0,170,255,64,
+    0,0,129,255,222,0,0,0,0,0,227,255,125,0,0,193,255,47,0,0,110,255,126,0,
+    0,191,255,160,0,0,0,0,0,165,255,187,0,6,247,240,2,0,0,49,255,188,0,6,
+    246,255,97,0,0,0,0,0,102,255,244,4,60,255,181,0,0,0,3,241,245,5,59,255,
+    255,34,0,0,0,0,0,40,255,255,55,121,255,120,0,0,0,0,185,255,55,120,255,228,
+    0,0,0,0,0,0,0,232,255,117,183,255,58,0,0,0,0,124,255,117,182,255,165,0,
+    0,0,0,0,0,0,171,255,181,241,247,6,0,0,0,0,64,255,181,240,255,102,0,0,
+    0,0,0,0,0,108,255,253,255,192,0,0,0,0,0,9,249,253,255,255,40,0,0,0,
+    0,0,0,0,46,255,255,255,131,0,0,0,0,0,0,199,255,255,233,0,0,0,0,0,
+    0,0,0,1,237,255,255,70,0,0,0,0,0,0,138,255,255,171,0,0,0,0,0,46,
+    250,255,98,0,0,0,0,0,0,0,146,255,231,18,0,0,132,255,239,24,0,0,0,0,
+    0,62,254,255,79,0,0,0,7,214,255,173,0,0,0,0,10,220,255,163,0,0,0,0,
+    0,58,253,255,82,0,0,0,146,255,230,17,0,0,0,0,0,0,147,255,231,16,0,62,
+    254,255,77,0,0,0,0,0,0,0,12,224,255,157,11,220,255,161,0,0,0,0,0,0,
+    0,0,0,71,255,255,191,255,229,16,0,0,0,0,0,0,0,0,0,0,162,255,255,255,
+    75,0,0,0,0,0,0,0,0,0,0,0,31,255,255,194,0,0,0,0,0,0,0,0,
+    0,0,0,0,152,255,255,253,55,0,0,0,0,0,0,0,0,0,0,67,254,255,211,255,
+    211,5,0,0,0,0,0,0,0,0,13,224,255,157,27,241,255,126,0,0,0,0,0,0,
+    0,0,154,255,227,15,0,103,255,249,42,0,0,0,0,0,0,69,255,255,71,0,0,1,
+    193,255,198,2,0,0,0,0,14,226,255,155,0,0,0,0,38,247,255,109,0,0,0,0,
+    156,255,225,14,0,0,0,0,0,120,255,243,31,0,0,71,255,255,69,0,0,0,0,0,
+    0,4,207,255,183,0,15,227,255,153,0,0,0,0,0,0,0,0,50,252,255,93,183,255,
+    206,4,0,0,0,0,0,0,0,48,251,255,95,29,242,255,122,0,0,0,0,0,0,4,
+    205,255,183,0,0,104,255,248,41,0,0,0,0,0,120,255,241,29,0,0,1,190,255,199,
+    2,0,0,0,38,247,255,103,0,0,0,0,34,245,255,113,0,0,1,194,255,190,1,0,
+    0,0,0,0,112,255,245,34,0,107,255,245,34,0,0,0,0,0,0,2,197,255,190,31,
+    243,255,111,0,0,0,0,0,0,0,0,39,247,255,228,255,197,2,0,0,0,0,0,0,
+    0,0,0,119,255,255,247,39,0,0,0,0,0,0,0,0,0,0,3,231,255,146,0,0,
+    0,0,0,0,0,0,0,0,0,0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,
+    0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,0,220,255,132,0,0,0,0,0,
+    0,0,0,0,0,0,0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,0,220,255,
+    132,0,0,0,0,0,0,0,0,0,0,0,0,220,255,132,0,0,0,0,0,0,0,0,
+    0,0,0,0,220,255,132,0,0,0,0,0,0,0,0,0,0,0,0,220,255,132,0,0,
+    0,0,0,0,168,255,255,255,255,255,255,255,255,255,255,255,255,255,24,168,255,255,255,255,
+    255,255,255,255,255,255,255,255,255,22,0,0,0,0,0,0,0,0,0,0,67,252,255,151,
+    0,0,0,0,0,0,0,0,0,0,29,235,255,200,6,0,0,0,0,0,0,0,0,0,
+    6,201,255,234,28,0,0,0,0,0,0,0,0,0,0,153,255,252,66,0,0,0,0,0,
+    0,0,0,0,0,97,255,255,118,0,0,0,0,0,0,0,0,0,0,50,247,255,173,0,
+    0,0,0,0,0,0,0,0,0,18,223,255,216,13,0,0,0,0,0,0,0,0,0,2,
+    183,255,243,42,0,0,0,0,0,0,0,0,0,0,131,255,255,85,0,0,0,0,0,0,
+    0,0,0,0,76,254,255,141,0,0,0,0,0,0,0,0,0,0,35,239,255,192,4,0,
+    0,0,0,0,0,0,0,0,10,209,255,229,23,0,0,0,0,0,0,0,0,0,0,163,
+    255,250,57,0,0,0,0,0,0,0,0,0,0,108,255,255,108,0,0,0,0,0,0,0,
+    0,0,0,0,234,255,255,255,255,255,255,255,255,255,255,255,255,255,92,236,255,255,255,255,
+    255,255,255,255,255,255,255,255,255,92,
+};
+
+#endif //HUD_FONT_DATA_H
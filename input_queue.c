@@ -0,0 +1,85 @@
+#include "input_queue.h"
+
+bool
+inputQueueInit( InputQueue* queue )
+{
+    SDL_zerop( queue );
+    queue->ready = SDL_CreateSemaphore( 0 );
+    return queue->ready != NULL;
+}
+
+void
+inputQueueDestroy( InputQueue* queue )
+{
+    SDL_DestroySemaphore( queue->ready );
+    queue->ready = NULL;
+}
+
+/*
+ * Main thread: queue an action and wake the logic thread. A timestamp older than the
+ * previous action's (SDL stamps events in whole ms) is moved up to it. Returns false and
+ * drops the action when the logic thread is a whole ring behind.
+ */
+bool
+inputQueuePush( InputQueue* queue, InputAction action, Uint64 timestamp )
+{
+    const int head = SDL_AtomicGet( &queue->head );
+    if( head - SDL_AtomicGet( &queue->tail ) >= INPUT_QUEUE_SIZE )
+    {
+        SDL_AtomicAdd( &queue->dropped, 1 );
+        return false;
+    }
+
+    InputEvent* event = &queue->events[ head & ( INPUT_QUEUE_SIZE - 1 ) ];
+    queue->last = timestamp > queue->last ? timestamp : queue->last;
+    event->timestamp = queue->last;
+    event->action = action;
+
+    // Publish the action only after it is fully written.
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet( &queue->head, head + 1 );
+    SDL_SemPost( queue->ready );
+    return true;
+}
+
+/*
+ * Logic thread: the oldest queued action, or NULL when there is none. It stays valid
+ * until inputQueuePop.
+ */
+const InputEvent*
+inputQueuePeek( InputQueue* queue )
+{
+    const int tail = SDL_AtomicGet( &queue->tail );
+    if( SDL_AtomicGet( &queue->head ) == tail )
+    {
+        return NULL;
+    }
+    SDL_MemoryBarrierAcquire();
+    return &queue->events[ tail & ( INPUT_QUEUE_SIZE - 1 ) ];
+}
+
+void
+inputQueuePop( InputQueue* queue )
+{
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicAdd( &queue->tail, 1 );
+}
+
+/*
+ * Logic thread: sleep until an action is queued or the performance counter reaches
+ * deadline, whichever comes first. Returns right away when actions are waiting.
+ */
+void
+inputQueueWait( InputQueue* queue, Uint64 deadline )
+{
+    const Uint64 now = SDL_GetPerformanceCounter();
+    if( inputQueuePeek( queue ) != NULL || now >= deadline )
+    {
+        return;
+    }
+
+    // Round up, waking before the deadline would only mean another wait.
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    const Uint32 timeout_ms = (Uint32) ( ( ( deadline - now ) * 1000 + frequency - 1 ) / frequency );
+    SDL_SemWaitTimeout( queue->ready, timeout_ms );
+}
@@ -0,0 +1,62 @@
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include <stdbool.h>
+#include <SDL.h>
+
+/**************************************************************************
+** Player actions, handed from the main thread to the logic thread. The
+** main thread turns key presses into actions stamped with the performance
+** counter time SDL queued them at, and pushes them into a
+** single-producer/single-consumer ring. It is the only producer and a push
+** never goes back in time, so the ring is in timestamp order.
+**************************************************************************/
+
+#define INPUT_QUEUE_SIZE        64      /**< Actions in flight, must be a power of 2 */
+
+typedef enum InputAction
+{
+    INPUT_ACTION_LEFT,
+    INPUT_ACTION_RIGHT,
+    INPUT_ACTION_SOFT_DROP,
+    INPUT_ACTION_ROTATE
+} InputAction;
+
+typedef struct InputEvent
+{
+    Uint64          timestamp;          /**< SDL_GetPerformanceCounter when the key was seen */
+    InputAction     action;
+} InputEvent;
+
+/**
+ * The main thread only writes head and last, the logic thread only writes tail.
+ */
+typedef struct InputQueue
+{
+    InputEvent      events[ INPUT_QUEUE_SIZE ];
+    _Alignas( 64 ) SDL_atomic_t head;
+    _Alignas( 64 ) SDL_atomic_t tail;
+    Uint64          last;               /**< Timestamp of the newest pushed action */
+    SDL_atomic_t    dropped;            /**< Actions lost because the ring was full */
+    SDL_sem*        ready;              /**< Posted for every pushed action */
+} InputQueue;
+
+bool
+inputQueueInit( InputQueue* queue );
+
+void
+inputQueueDestroy( InputQueue* queue );
+
+bool
+inputQueuePush( InputQueue* queue, InputAction action, Uint64 timestamp );
+
+const InputEvent*
+inputQueuePeek( InputQueue* queue );
+
+void
+inputQueuePop( InputQueue* queue );
+
+void
+inputQueueWait( InputQueue* queue, Uint64 deadline );
+
+#endif //INPUT_QUEUE_H
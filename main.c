@@ -7,8 +7,21 @@
 #include <SDL_ttf.h>
 #include <stdbool.h>
 #include <sys/time.h>
+#include <time.h>
+#include "alloc_prof.h"
+#include "board_mesh.h"
+#include "board_texture.h"
+#include "bot.h"
+#include "game.h"
+#include "hud_font.h"
+#include "input_queue.h"
 #include "matrix.h"
+#include "mcts.h"
+#include "nn_eval.h"
+#include "recorder.h"
+#include "snapshot.h"
 #include "tetris_shape.h"
+#include "trace.h"
 
 /**************************************************************************
 ** Structs
@@ -20,17 +33,6 @@ typedef struct Window
     SDL_Renderer*   renderer;
 } Window;
 
-typedef struct GameState
-{
-    bool            running;            /**< Game will exit if running is set to false */
-    Matrix*         board;              /**< Pieces on the board (with exception of player-controlled shape */
-    TETRIS_SHAPE    active_shape;       /**< Shape that is controlled by player */
-    TETRIS_ROT      active_shape_rot;   /**< Shape rotation */
-    int             active_shape_x;     /**< x-position of shape pivot point on board */
-    int             active_shape_y;     /**< yposition of shape pivot point on board */
-    int             score;              /**< Total player score */
-} GameState;
-
 typedef struct Color
 {
     uint8_t     r;
@@ -39,32 +41,35 @@ typedef struct Color
     uint8_t     a;
 } Color;
 
-typedef int             RESULT;
-#define RESULT_SUCCESS  0
-#define RESULT_ERROR    (-1)
-
 /**************************************************************************
 ** Config
 **************************************************************************/
 #define WINDOW_TITLE            "Tetris"
 #define WINDOW_WIDTH            600
 #define WINDOW_HEIGHT           900
-#define GAME_LOOP_SLEEP_MS      0
 #define LOGIC_LOOP_TICK_MS      700
 #define RENDER_LOOP_TICK_MS     20
-#define INPUT_LOOP_TICK_MS      50
+#define INPUT_LOOP_TICK_MS      50                      /**< Held keys repeat this often */
+#define INPUT_IDLE_WAIT_MS      100                     /**< Longest wait for events while no key is held */
 #define PRINT_FPS               false
-#define BOARD_WIDTH             10
-#define BOARD_HEIGHT            20
-#define SCORE_PER_ROW           100
+#define PRINT_EVENT_STATS       false                   /**< Print event queue counters on exit */
 #define CELL_SIZE_PX            20
 #define CELL_PADDING_PX         1
 #define BOARD_POS_X             20
 #define BOARD_POS_Y             20
-#define SHAPE_SPAWN_X           5
-#define SHAPE_SPAWN_Y           (-1)
-#define FONT_PATH               "/Library/Fonts/Arial Unicode.ttf"
+#define PREVIEW_CELL_X          ( BOARD_WIDTH + 4 )     /**< Preview position, in board cells */
+#define PREVIEW_CELL_Y          6
+#define PREVIEW_SPACING         4                       /**< Cells between previewed shapes */
+#define FONT_ENV                "TETRIS_FONT"               /**< Set to a .ttf file to draw the HUD with SDL_ttf */
 #define FONT_SIZE               24
+#define TRACE_ENV               "TETRIS_TRACE"              /**< Set to a file name to write a trace */
+#define RECORD_ENV              "TETRIS_RECORD"             /**< Set to a .y4m (or other) file name to record video */
+#define RECORD_FPS              ( 1000 / RENDER_LOOP_TICK_MS )
+#define BOARD_TEXTURE           false                       /**< Draw the board from a texel per cell texture instead of a mesh */
+#define AUTOPLAY                false                       /**< Let the MCTS bot play */
+#define AUTOPLAY_THREADS        4
+#define AUTOPLAY_BUDGET_MS      ( LOGIC_LOOP_TICK_MS / 4 )  /**< Search time per shape */
+#define NETWORK_ENV             "TETRIS_NETWORK"            /**< Set to a weights file (nn_eval.h) for the autoplayer to score boards with */
 
 /**************************************************************************
 ** Colors
@@ -80,27 +85,47 @@ Color COLOR_BLUE    = { 0,      121,    255,    0xFF };
 ** Forward references
 **************************************************************************/
 RESULT          initWindow();
-RESULT          initGameState( GameState* game_state );
 void            destroyWindow();
-void            loop( Window* window, GameState* game_state );
-int             randomInt( int min, int max );
+void            loop( Window* window );
 typedef struct  Chrono Chrono;
 Chrono*         chronoStart();
 int             chronoGet(Chrono* chrono);
 bool            chronoTick(Chrono* chrono, int delta_ms);
 void            chronoReset(Chrono* chrono);
-void            eventTick( GameState* game_state );
-void            inputTick( GameState* game_state );
-void            logicTick( GameState* game_state );
-void            renderTick( GameState* game_state, Window* window );
-TETRIS_SHAPE    randomShape();
-TETRIS_ROT      randomRotation();
+Uint64          msToCounter( int ms );
+int             counterToMs( Uint64 counter );
+void            eventTick( SDL_Event* event );
+int             inputTick();
+void            renderTick( const GameSnapshot* snapshot, Window* window );
+RESULT          initRenderer( Window* window );
+void            destroyRenderer( Window* window );
+RESULT          startLogicThread( GameState* game_state );
+void            stopLogicThread();
+void            autoplayTick( GameState* game_state );
+void            initEventFilter();
+void            printEventStats();
 
 /**************************************************************************
 ** Global variables
 **************************************************************************/
-TTF_Font* Font;
+TTF_Font* Font;                     /**< Only opened when FONT_ENV is set */
+TTF_Atlas* TextAtlas;               /**< Glyphs of Font, packed once into textures */
+HudFont* HudText;                   /**< Built in font, used when there is no Font */
+BoardMesh* BoardCells;              /**< Board and active shape, drawn in one call */
+BoardTexture* BoardTexels;          /**< The same, drawn from a texture when BOARD_TEXTURE is set */
+Mcts* Autoplayer;
+NnModel* Network;                   /**< Only loaded when NETWORK_ENV is set */
 Color SHAPE_COLORS[ 7 ];
+SDL_atomic_t EventsEnqueued;        /**< Events the filter let into the queue */
+SDL_atomic_t EventsFiltered;        /**< Events the filter dropped */
+int EventsConsumed;                 /**< Events eventTick took out of the queue */
+int EventsMaxBacklog;               /**< Most events waiting when the main thread woke up */
+bool Running = true;                /**< Cleared by the main thread on quit */
+InputQueue Inputs;                  /**< Actions handed from the main thread to the logic thread */
+Uint64 KeyRepeatAt[ 3 ];            /**< When each held key (see HELD_KEYS) repeats next */
+SDL_Thread* LogicThread;
+SDL_atomic_t LogicQuit;
+SnapshotBuffer Snapshots;           /**< Game state handed from the logic thread to the main thread */
 
 /**************************************************************************
 ** Main
@@ -108,6 +133,8 @@ Color SHAPE_COLORS[ 7 ];
 int
 main()
 {
+    ALLOC_PROF_INSTALL();
+
     SHAPE_COLORS[ TETRIS_SHAPE_SQUARE ]   = COLOR_YELLOW;
     SHAPE_COLORS[ TETRIS_SHAPE_T ]        = COLOR_RED;
     SHAPE_COLORS[ TETRIS_SHAPE_LONG ]     = COLOR_GREEN;
@@ -120,422 +147,667 @@ main()
     GameState*  game_state     = malloc( sizeof( GameState ) );
 
     if( initWindow( window ) < 0 )                  return RESULT_ERROR;
-    if( initGameState( game_state ) < 0)        return RESULT_ERROR;
+    initEventFilter();
+    if( initGameState( game_state, (uint32_t) time( NULL ) ) < 0 ) return RESULT_ERROR;
+
+    const char* trace_path = SDL_getenv( TRACE_ENV );
+    if( trace_path != NULL )
+    {
+        traceStart( trace_path );
+    }
+
+    snapshotInit( &Snapshots, game_state );
+    if( initRenderer( window ) < 0 )                return RESULT_ERROR;
+
+    if( AUTOPLAY )
+    {
+        botInit();
+        Autoplayer = mctsCreate( AUTOPLAY_THREADS, MCTS_DEFAULT_NODES );
+        if( Autoplayer == NULL )
+        {
+            printf( "Could not create the autoplayer, the shapes fall on their own. SDL_Error: %s\n", SDL_GetError() );
+        }
 
-    loop( window, game_state );
+        const char* network_path = SDL_getenv( NETWORK_ENV );
+        if( network_path != NULL && Autoplayer != NULL )
+        {
+            Network = nnLoad( network_path );
+            mctsSetNetwork( Autoplayer, Network );
+        }
+    }
 
+    if( startLogicThread( game_state ) < 0 )        return RESULT_ERROR;
+    loop( window );
+    stopLogicThread();
+    destroyRenderer( window );
+    if( AUTOPLAY )
+    {
+        mctsDestroy( Autoplayer );
+        nnFree( Network );
+    }
+    traceStop();
     destroyWindow( window );
-    matrixFree( game_state->board );
+    freeGameState( game_state );
     free( window );
     free( game_state );
 
+    if( PRINT_EVENT_STATS )
+    {
+        printEventStats();
+    }
+    ALLOC_PROF_REPORT();
     return RESULT_SUCCESS;
 }
 
 
 /**
- * Main game loop. Triggers event, logic and render ticks at specific frequencies.
+ * Main loop. SDL wants events pumped and the renderer driven on the thread that opened
+ * the window, so this thread does both: it turns key presses into timestamped actions
+ * for the logic thread and draws the newest snapshot every RENDER_LOOP_TICK_MS. Sleeps
+ * in between, waking up for events, held keys and frames.
  */
 void
-loop( Window* window, GameState* game_state )
+loop( Window* window )
 {
     Chrono* chronoFps           = chronoStart();
     Chrono* chronoFpsSampler    = chronoStart();
-    Chrono* chronoLogicTick     = chronoStart();
-    Chrono* chronoRenderTick    = chronoStart();
-    Chrono* chronoInputTick     = chronoStart();
+    const Uint64 frame          = msToCounter( RENDER_LOOP_TICK_MS );
+    Uint64 next_frame           = SDL_GetPerformanceCounter();
 
     do
     {
-        if ( PRINT_FPS )
+        const Uint64 now = SDL_GetPerformanceCounter();
+        const int frame_wait = next_frame > now ? counterToMs( next_frame - now ) : 0;
+        const int input_wait = inputTick();
+
+        SDL_Event event;
+        if( SDL_WaitEventTimeout( &event, SDL_min( frame_wait, input_wait ) ) != 0 )
         {
-            int delta_ms = chronoGet( chronoFps );
-            if( chronoTick( chronoFpsSampler, 1000 ) )
+            const int backlog = SDL_AtomicGet( &EventsEnqueued ) - EventsConsumed;
+            if( backlog > EventsMaxBacklog )
             {
-                printf( "Tick time: %d ms. FPS: %f \n", delta_ms, (float) 1000 / delta_ms );
+                EventsMaxBacklog = backlog;
             }
-            chronoReset( chronoFps );
-        }
 
-        eventTick( game_state );
-        if( chronoTick( chronoInputTick, INPUT_LOOP_TICK_MS ) )     inputTick(  game_state );
-        if( chronoTick( chronoLogicTick, LOGIC_LOOP_TICK_MS ) )     logicTick(  game_state );
-        if( chronoTick( chronoRenderTick, RENDER_LOOP_TICK_MS ) )   renderTick( game_state, window );
+            TRACE_BEGIN( "eventTick" );
+            ALLOC_PROF_PHASE( "eventTick" );
+            do
+            {
+                eventTick( &event );
+            } while( SDL_PollEvent( &event ) != 0 );
+            TRACE_END( "eventTick" );
+            ALLOC_PROF_PHASE( NULL );
+        }
 
-        SDL_Delay(GAME_LOOP_SLEEP_MS);
+        if( SDL_GetPerformanceCounter() >= next_frame )
+        {
+            if ( PRINT_FPS )
+            {
+                int delta_ms = chronoGet( chronoFps );
+                if( chronoTick( chronoFpsSampler, 1000 ) )
+                {
+                    printf( "Tick time: %d ms. FPS: %f \n", delta_ms, (float) 1000 / delta_ms );
+                }
+                chronoReset( chronoFps );
+            }
 
-    } while ( game_state->running == true );
+            TRACE_BEGIN( "renderTick" );
+            ALLOC_PROF_PHASE( "renderTick" );
+            renderTick( snapshotAcquire( &Snapshots ), window );
+            TRACE_END( "renderTick" );
+            ALLOC_PROF_PHASE( NULL );
+            ALLOC_PROF_FRAME();
+
+            // A slow frame (present, vsync) pushes the next one back instead of
+            // queueing a burst. Gravity runs on the logic thread and is not delayed.
+            next_frame += frame;
+            if( next_frame <= SDL_GetPerformanceCounter() )
+            {
+                next_frame = SDL_GetPerformanceCounter() + frame;
+            }
+        }
+    } while ( Running == true );
 
     free( chronoFps );
-    free( chronoLogicTick );
     free( chronoFpsSampler );
-    free( chronoRenderTick );
-    free( chronoInputTick );
 }
 
 
-RESULT
-initGameState( GameState* game_state )
+// Draws a cell in the board at i (height) and j (width) at color
+void
+drawCell( Window* window, int i, int j, Color color )
 {
-    if( game_state == NULL )
-    {
-        return RESULT_ERROR ;
-    }
-    game_state->running = true;
-    game_state->score = 0;
-    game_state->active_shape = randomShape();
-    game_state->active_shape_rot = randomRotation();
-    game_state->active_shape_x = SHAPE_SPAWN_X;
-    game_state->active_shape_y = SHAPE_SPAWN_Y;
-    game_state->board = matrixMake( BOARD_WIDTH, BOARD_HEIGHT );
+    SDL_Rect fillRect = {   BOARD_POS_X + i * CELL_PADDING_PX + i * CELL_SIZE_PX,
+                            BOARD_POS_Y + j * CELL_PADDING_PX + j * CELL_SIZE_PX,
+                            CELL_SIZE_PX,
+                            CELL_SIZE_PX };
+
+    SDL_SetRenderDrawColor( window->renderer, color.r, color.g, color.b, color.a );
+    SDL_RenderFillRect( window->renderer, &fillRect );
+}
 
-    for ( int i = 0; i < BOARD_WIDTH; i++ )
+// Draws a tetris shape in the board at i (height) and j (width) and rotation (tetris_rot).
+void
+drawTetrisShape( Window* window, int tetris_shape, int i, int j, TETRIS_ROT tetris_rot )
+{
+    int cells[ 4 ][ 2 ];
+    getShapeCells( tetris_shape, i, j, tetris_rot, cells );
+
+    for( int coord = 0; coord < 4; coord++ )
     {
-        for ( int j = 0; j < BOARD_HEIGHT; j++ )
+        const int x = cells[ coord ][ 0 ];
+        const int y = cells[ coord ][ 1 ];
+
+        if ( y < 0 )
         {
-            matrixSet( game_state->board, i, j, 0 );
+            return;
         }
+        drawCell( window,
+                x,
+                y,
+                SHAPE_COLORS[ tetris_shape ] );
     }
+}
 
-    return RESULT_SUCCESS;
+SDL_Color
+toSDLColor( const Color color )
+{
+    return (SDL_Color){ color.r, color.g, color.b, color.a };
 }
 
-// Validate if new shape position and rotation is within bounds of the board and
-// not colliding with shapes that were already dropped.
-bool
-validateShape( GameState* game_state, int x, int y, TETRIS_ROT tetris_rot )
+// Colors a board cell in whichever board renderer is in use.
+void
+setBoardCell( int i, int j, Color color )
+{
+    if( BOARD_TEXTURE ) boardTextureSetCell( BoardTexels, i, j, toSDLColor( color ) );
+    else                boardMeshSetCell( BoardCells, i, j, toSDLColor( color ) );
+}
+
+void
+drawScore( int score )
 {
-    bool valid = true;
-    Matrix* coords = getLocalShapeCells( game_state->active_shape, x, y, tetris_rot );
+    char score_string[7];
+    sprintf( score_string, "%06d", score );
+
+    const SDL_FRect title_message_rect = { 250, 20, 80, 30 };
+    const SDL_FRect score_message_rect = { 250, 60, 80, 30 };
 
-    for( int coord = 0; coord < coords->rows; coord++ )
+    // Glyphs come from an atlas, so this neither allocates a surface nor uploads a texture.
+    if( TextAtlas != NULL )
     {
-        const int new_x = matrixGet( coords, coord, 0 );
-        const int new_y = matrixGet( coords, coord, 1 );
+        TTF_AddAtlasTextUTF8( TextAtlas, "SCORE:", &title_message_rect, toSDLColor( COLOR_YELLOW ) );
+        TTF_AddAtlasTextUTF8( TextAtlas, score_string, &score_message_rect, toSDLColor( COLOR_YELLOW ) );
+        TTF_RenderAtlas( TextAtlas );
+    } else
+    {
+        hudFontAddText( HudText, "SCORE:", &title_message_rect, toSDLColor( COLOR_YELLOW ) );
+        hudFontAddText( HudText, score_string, &score_message_rect, toSDLColor( COLOR_YELLOW ) );
+        hudFontRender( HudText );
+    }
+}
 
-        // Check collision with board bounds. y < 0 is allowed for
-        // spawned blocks.
-        if( new_x < 0                   ||
-            new_x > BOARD_WIDTH - 1     ||
-            new_y > BOARD_HEIGHT - 1 )
-        {
-            valid = false;
-            break;
-        }
+// Draws the queued shapes next to the board, next shape on top.
+void
+drawPreview( Window* window, const GameSnapshot* snapshot )
+{
+    for( int i = 0; i < PIECE_QUEUE_SIZE; i++ )
+    {
+        drawTetrisShape( window,
+                         snapshot->next_shapes[ i ],
+                         PREVIEW_CELL_X,
+                         PREVIEW_CELL_Y + i * PREVIEW_SPACING,
+                         snapshot->next_rots[ i ] );
+    }
+}
 
-        // Check for collision with board elements (but only when y > 0 to prevent out
-        // of bounds matrixGet)
-        if( new_y > 0 && matrixGet( game_state->board, new_x, new_y) > 0 )
+void
+renderTick( const GameSnapshot* snapshot, Window* window )
+{
+    SDL_SetRenderDrawColor( window->renderer,
+                            COLOR_DARK.r,
+                            COLOR_DARK.g,
+                            COLOR_DARK.b,
+                            COLOR_DARK.a);
+    SDL_RenderClear( window->renderer );
+
+    // Draw board, with the active (player-controlled) shape on top, as one mesh or
+    // texture. Only the cells whose color changed since the last frame are rewritten.
+    TRACE_BEGIN( "drawBoard" );
+    for( int i = 0; i < BOARD_WIDTH; i++ )
+    {
+        for( int j = 0; j < BOARD_HEIGHT; j++ )
         {
-            valid = false;
-            break;
+            setBoardCell( i, j, snapshot->cells[ i ][ j ] == 0 ? COLOR_BLACK : COLOR_YELLOW );
         }
     }
 
-    free( coords );
-    return valid;
+    int cells[ 4 ][ 2 ];
+    getShapeCells( snapshot->active_shape,
+                   snapshot->active_shape_x,
+                   snapshot->active_shape_y,
+                   snapshot->active_shape_rot,
+                   cells );
+    for( int coord = 0; coord < 4; coord++ )
+    {
+        setBoardCell( cells[ coord ][ 0 ], cells[ coord ][ 1 ], SHAPE_COLORS[ snapshot->active_shape ] );
+    }
+    if( BOARD_TEXTURE ) boardTextureDraw( BoardTexels, window->renderer );
+    else                boardMeshDraw( BoardCells, window->renderer );
+    TRACE_END( "drawBoard" );
+
+    TRACE_BEGIN( "drawScore" );
+    drawScore( snapshot->score );
+    TRACE_END( "drawScore" );
+    drawPreview( window, snapshot );
+
+    if( RecorderEnabled )
+    {
+        TRACE_BEGIN( "recorderBeforePresent" );
+        recorderBeforePresent( window->renderer );
+        TRACE_END( "recorderBeforePresent" );
+    }
+
+    TRACE_BEGIN( "SDL_RenderPresent" );
+    SDL_RenderPresent( window->renderer );
+    TRACE_END( "SDL_RenderPresent" );
+
+    if( RecorderEnabled )
+    {
+        TRACE_BEGIN( "recorderCapture" );
+        recorderCapture();
+        TRACE_END( "recorderCapture" );
+    }
 }
 
-// Rotate active piece by 90 deg clockwise (if it does not collide).
+
+// Let the MCTS bot place the active shape. The search fits in a single logic tick.
 void
-rotateShape( GameState* game_state )
+autoplayTick( GameState* game_state )
 {
-    TETRIS_ROT target_rot;
-    if ( game_state->active_shape_rot < 3 )
+    BotMove move;
+    if( Autoplayer != NULL && mctsSearch( Autoplayer, game_state, AUTOPLAY_BUDGET_MS, &move, NULL ) )
     {
-        target_rot = game_state->active_shape_rot + 1;
+        botApplyMove( game_state, &move );
     } else
     {
-        target_rot = 0;
+        logicTick( game_state );
     }
+}
 
-    if( !validateShape( game_state, game_state->active_shape_x, game_state->active_shape_y, target_rot ) )
-    {
-        return;
-    }
+/**************************************************************************
+** Input, on the main thread. Keys that move the shape act when pressed and
+** then repeat every INPUT_LOOP_TICK_MS while held, rotation acts once per
+** press.
+**************************************************************************/
 
-    game_state->active_shape_rot = target_rot;
+static const SDL_Scancode HELD_KEYS[]       = { SDL_SCANCODE_DOWN, SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT };
+static const InputAction HELD_KEY_ACTIONS[] = { INPUT_ACTION_SOFT_DROP, INPUT_ACTION_LEFT, INPUT_ACTION_RIGHT };
+
+Uint64
+msToCounter( int ms )
+{
+    return SDL_GetPerformanceFrequency() * (Uint64) ms / 1000;
 }
 
-// Move shape along dx or dy (if it does not collide). Returns 0 on success
-// and -1 on failure (collision).
+// Round up, so whatever waits this long is due when the wait ends.
 int
-moveShape( GameState* game_state, int dx, int dy )
+counterToMs( Uint64 counter )
 {
-    const int target_x = game_state->active_shape_x + dx;
-    const int target_y = game_state->active_shape_y + dy;
-
-    if( !validateShape( game_state, target_x, target_y, game_state->active_shape_rot ) )
-    {
-        return -1;
-    }
-    game_state->active_shape_x = target_x;
-    game_state->active_shape_y = target_y;
-    return 0;
+    return (int) ( ( counter * 1000 + SDL_GetPerformanceFrequency() - 1 ) / SDL_GetPerformanceFrequency() );
 }
 
-// Spawn a new shape.
-void
-spawnShape( GameState* game_state )
+// When SDL queued the event, on the performance counter like the rest of the input
+// queue. Events that came in while a frame was drawn are handled after it, but keep
+// their place before the gravity ticks that followed them.
+static Uint64
+eventTime( const SDL_Event* event )
 {
-    game_state->active_shape = randomInt( 0, 6 );
-    game_state->active_shape_rot = randomInt( 0, 3 );
-    game_state->active_shape_x = SHAPE_SPAWN_X;
-    game_state->active_shape_y = SHAPE_SPAWN_Y;
+    const Uint64 now = SDL_GetPerformanceCounter();
+    const Uint64 age = msToCounter( (int) ( SDL_GetTicks() - event->common.timestamp ) );
+    return age < now ? now - age : now;
 }
 
-// Freeze shape in place on the board.
-void
-freezeShape( GameState* game_state )
+/*
+ * Repeat the held keys that are due. Returns how many ms the main thread may sleep
+ * before the next repeat.
+ */
+int
+inputTick()
 {
-    Matrix* coords = getLocalShapeCells( game_state->active_shape,
-                                        game_state->active_shape_x,
-                                        game_state->active_shape_y,
-                                        game_state->active_shape_rot );
+    const uint8_t* keysArray = SDL_GetKeyboardState( NULL );
+    const Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 wait = msToCounter( INPUT_IDLE_WAIT_MS );
 
-    for( int coord = 0; coord < coords->rows; coord++ )
+    TRACE_BEGIN( "inputTick" );
+    for( size_t k = 0; k < SDL_arraysize( HELD_KEYS ); k++ )
     {
-        const int x = matrixGet( coords, coord, 0 );
-        const int y = matrixGet( coords, coord, 1 );
-        matrixSet( game_state->board, x, y, 1 );
+        if( !keysArray[ HELD_KEYS[ k ] ] )
+        {
+            continue;
+        }
+        if( now >= KeyRepeatAt[ k ] )
+        {
+            inputQueuePush( &Inputs, HELD_KEY_ACTIONS[ k ], now );
+            KeyRepeatAt[ k ] = now + msToCounter( INPUT_LOOP_TICK_MS );
+        }
+        if( KeyRepeatAt[ k ] - now < wait )
+        {
+            wait = KeyRepeatAt[ k ] - now;
+        }
     }
+    TRACE_END( "inputTick" );
 
-    free( coords );
+    return counterToMs( wait );
 }
 
-// Find full rows, clear them and add to the score.
 void
-clearFullRows( GameState* game_state)
+eventTick( SDL_Event* event )
 {
-    // Loop over all board rows from bottom to top.
-    int row = BOARD_HEIGHT - 1;
-    while ( row > 0 )
+    const Uint64 now = eventTime( event );
+
+    EventsConsumed++;
+    if( event->type == SDL_QUIT )
     {
-        bool is_row_full = true;
-        for( int col = 0; col < BOARD_WIDTH; col++ )
+        Running = false;
+    }
+    else if( event->type == SDL_KEYDOWN && event->key.repeat == 0 )
+    {
+        switch( event->key.keysym.sym )
         {
-            if ( matrixGet( game_state->board, col, row ) == 0 )
-            {
-                is_row_full = false;
+            case SDLK_ESCAPE:
+                Running = false;
+                break;
+            case SDLK_SPACE:
+                inputQueuePush( &Inputs, INPUT_ACTION_ROTATE, now );
+                break;
+            default:
+                for( size_t k = 0; k < SDL_arraysize( HELD_KEYS ); k++ )
+                {
+                    if( event->key.keysym.scancode == HELD_KEYS[ k ] )
+                    {
+                        inputQueuePush( &Inputs, HELD_KEY_ACTIONS[ k ], now );
+                        KeyRepeatAt[ k ] = now + msToCounter( INPUT_LOOP_TICK_MS );
+                    }
+                }
                 break;
-            }
         }
+    }
+}
+
+/**************************************************************************
+** Logic thread. Owns the game state: applies the queued actions and the
+** gravity ticks and publishes a snapshot for the main thread to draw after
+** every change.
+**************************************************************************/
+
+static void
+applyInput( GameState* game_state, InputAction action )
+{
+    switch( action )
+    {
+        case INPUT_ACTION_LEFT:
+            moveShape( game_state, -1, 0 );
+            break;
+        case INPUT_ACTION_RIGHT:
+            moveShape( game_state, 1, 0 );
+            break;
+        case INPUT_ACTION_SOFT_DROP:
+            moveShape( game_state, 0, 1 );
+            break;
+        case INPUT_ACTION_ROTATE:
+            rotateShape( game_state );
+            break;
+    }
+}
+
+static void
+gravityTick( GameState* game_state )
+{
+    TRACE_BEGIN( "logicTick" );
+    ALLOC_PROF_PHASE( "logicTick" );
+    if( AUTOPLAY )  autoplayTick( game_state );
+    else            logicTick( game_state );
+    TRACE_END( "logicTick" );
+    ALLOC_PROF_PHASE( NULL );
+}
+
+static int
+logicThread( void* data )
+{
+    GameState* game_state = data;
+    const Uint64 tick = msToCounter( LOGIC_LOOP_TICK_MS );
+    Uint64 next_tick = SDL_GetPerformanceCounter() + tick;
 
-        if (is_row_full)
+    while( !SDL_AtomicGet( &LogicQuit ) )
+    {
+        inputQueueWait( &Inputs, next_tick );
+        const Uint64 now = SDL_GetPerformanceCounter();
+        bool changed = false;
+
+        // Replay what happened since the last wake up in the order it happened, so an
+        // action pressed just before a gravity tick lands before it, even when this
+        // thread woke up late.
+        for( const InputEvent* event = inputQueuePeek( &Inputs ); event != NULL; event = inputQueuePeek( &Inputs ) )
         {
-            // Clear this line
-            for( int col = 0; col < BOARD_WIDTH; col++ )
+            if( event->timestamp >= next_tick && next_tick <= now )
             {
-                matrixSet( game_state->board, col, row, 0 );
+                gravityTick( game_state );
+                next_tick += tick;
             }
-
-            // Move all lines above 1 row downward
-            for( int i = row; i > 1; i-- )
+            else
             {
-                for( int j = 0; j < BOARD_WIDTH; j++ )
-                {
-                    matrixSet( game_state->board, j, i, matrixGet( game_state->board, j, i - 1 ) );
-                }
+                TRACE_BEGIN( "applyInput" );
+                applyInput( game_state, event->action );
+                TRACE_END( "applyInput" );
+                inputQueuePop( &Inputs );
             }
+            changed = true;
+        }
+        if( next_tick <= now )
+        {
+            gravityTick( game_state );
+            changed = true;
 
-            // Add score
-            game_state->score += SCORE_PER_ROW;
+            // After a stall (e.g. a long bot search) gravity restarts instead of
+            // catching up with a burst of ticks.
+            next_tick += tick;
+            if( next_tick <= now )
+            {
+                next_tick = now + tick;
+            }
+        }
 
-            // All rows moved down, so the loop should check this row again
-        } else
+        if( changed )
         {
-            // Loop should check next row (1 up)
-            row--;
+            TRACE_BEGIN( "publishSnapshot" );
+            snapshotFromGame( game_state, snapshotBack( &Snapshots ) );
+            snapshotPublish( &Snapshots );
+            TRACE_END( "publishSnapshot" );
         }
     }
+
+    return 0;
 }
 
-void
-logicTick( GameState* game_state )
+RESULT
+startLogicThread( GameState* game_state )
 {
-    // Gravity
-    int result = moveShape( game_state, 0, 1 );
-
-    // Spawn new shape if shape cannot move
-    if( result < 0 )
+    if( !inputQueueInit( &Inputs ) )
     {
-        freezeShape( game_state );
-        spawnShape( game_state );
+        printf( "Could not create the input queue. SDL_Error: %s\n", SDL_GetError() );
+        return RESULT_ERROR;
     }
 
-    clearFullRows( game_state );
+    LogicThread = SDL_CreateThread( logicThread, "logic", game_state );
+    if( LogicThread == NULL )
+    {
+        printf( "Could not start the logic thread. SDL_Error: %s\n", SDL_GetError() );
+        return RESULT_ERROR;
+    }
+    return RESULT_SUCCESS;
 }
 
-// Draws a cell in the board at i (height) and j (width) at color
 void
-drawCell( Window* window, int i, int j, Color color )
+stopLogicThread()
 {
-    SDL_Rect fillRect = {   BOARD_POS_X + i * CELL_PADDING_PX + i * CELL_SIZE_PX,
-                            BOARD_POS_Y + j * CELL_PADDING_PX + j * CELL_SIZE_PX,
-                            CELL_SIZE_PX,
-                            CELL_SIZE_PX };
-
-    SDL_SetRenderDrawColor( window->renderer, color.r, color.g, color.b, color.a );
-    SDL_RenderFillRect( window->renderer, &fillRect );
+    SDL_AtomicSet( &LogicQuit, 1 );
+    SDL_SemPost( Inputs.ready );
+    SDL_WaitThread( LogicThread, NULL );
+    inputQueueDestroy( &Inputs );
 }
 
-// Draws a tetris shape in the board at i (height) and j (width) and rotation (tetris_rot).
-void
-drawTetrisShape( Window* window, int tetris_shape, int i, int j, TETRIS_ROT tetris_rot )
+/**************************************************************************
+** Renderer. Created, driven and destroyed on the main thread, like SDL
+** requires, together with everything drawn with it (the text atlas, the
+** board, the recorder).
+**************************************************************************/
+
+RESULT
+initRenderer( Window* window )
 {
-    Matrix* m = getLocalShapeCells( tetris_shape, i, j, tetris_rot );
+    // Lets the recorder encode a presented frame while the next one renders. Must be set
+    // before the renderer creates the window framebuffer.
+    const char* record_path = SDL_getenv( RECORD_ENV );
+    if( record_path != NULL )
+    {
+        SDL_SetHint( SDL_HINT_VIDEO_OFFSCREEN_DOUBLE_BUFFER, "1" );
+    }
 
-    for( int coord = 0; coord < m->rows; coord++ )
+    window->renderer = SDL_CreateRenderer( window->window_instance, -1, SDL_RENDERER_ACCELERATED );
+
+    if( window->renderer == NULL )
     {
-        const int x = matrixGet( m, coord, 0 );
-        const int y = matrixGet( m, coord, 1 );
+        printf( "Could not initialize renderer. SDL_Error: %s\n", SDL_GetError() );
+        return RESULT_ERROR;
+    }
 
-        if ( y < 0 )
+    if( Font != NULL )
+    {
+        TextAtlas = TTF_CreateAtlas( window->renderer, Font, 0 );
+        if( TextAtlas == NULL )
         {
-            return;
+            printf( "Could not create text atlas. TTF_Error: %s\n", TTF_GetError() );
+            SDL_DestroyRenderer( window->renderer );
+            return RESULT_ERROR;
+        }
+    } else
+    {
+        HudText = hudFontCreate( window->renderer );
+        if( HudText == NULL )
+        {
+            printf( "Could not create the HUD font. SDL_Error: %s\n", SDL_GetError() );
+            SDL_DestroyRenderer( window->renderer );
+            return RESULT_ERROR;
         }
-        drawCell( window,
-                x,
-                y,
-                SHAPE_COLORS[ tetris_shape ] );
     }
 
-    free( m );
-}
+    if( BOARD_TEXTURE )
+    {
+        BoardTexels = boardTextureCreate( window->renderer, BOARD_WIDTH, BOARD_HEIGHT, BOARD_POS_X, BOARD_POS_Y,
+                                          CELL_SIZE_PX, CELL_PADDING_PX, toSDLColor( COLOR_DARK ) );
+    } else
+    {
+        BoardCells = boardMeshCreate( BOARD_WIDTH, BOARD_HEIGHT, BOARD_POS_X, BOARD_POS_Y, CELL_SIZE_PX, CELL_PADDING_PX );
+    }
+    if( BoardCells == NULL && BoardTexels == NULL )
+    {
+        printf( "Could not create the board renderer. SDL_Error: %s\n", SDL_GetError() );
+        TTF_DestroyAtlas( TextAtlas );
+        hudFontDestroy( HudText );
+        SDL_DestroyRenderer( window->renderer );
+        return RESULT_ERROR;
+    }
 
-SDL_Color
-toSDLColor( const Color color )
-{
-    return (SDL_Color){ color.r, color.g, color.b };
+    if( record_path != NULL )
+    {
+        recorderStart( window->renderer, record_path, RECORD_FPS );
+    }
+    return RESULT_SUCCESS;
 }
 
 void
-drawScore( Window* window, int score )
+destroyRenderer( Window* window )
 {
-    char score_string[7];
-    sprintf( score_string, "%06d", score );
-
-    SDL_Surface* title_message_surface = TTF_RenderText_Shaded(
-        Font,
-    "SCORE:",
-    toSDLColor( COLOR_YELLOW ),
-    toSDLColor( COLOR_DARK ) );
-
-    SDL_Surface* score_message_surface = TTF_RenderText_Shaded(
-        Font,
-        score_string,
-        toSDLColor( COLOR_YELLOW ),
-        toSDLColor( COLOR_DARK ) );
-
-    SDL_Texture* title_message = SDL_CreateTextureFromSurface( window->renderer, title_message_surface );
-    SDL_Texture* score_message = SDL_CreateTextureFromSurface( window->renderer, score_message_surface );
-
-    SDL_Rect title_message_rect;
-    title_message_rect.x = 250;
-    title_message_rect.y = 20;
-    title_message_rect.w = 80;
-    title_message_rect.h = 30;
-
-    SDL_Rect score_message_rect;
-    score_message_rect.x = 250;
-    score_message_rect.y = 60;
-    score_message_rect.w = 80;
-    score_message_rect.h = 30;
-
-    SDL_RenderCopy( window->renderer, title_message, NULL, &title_message_rect );
-    SDL_RenderCopy( window->renderer, score_message, NULL, &score_message_rect );
-
-    SDL_FreeSurface( title_message_surface );
-    SDL_FreeSurface( score_message_surface );
-
-    SDL_DestroyTexture( title_message );
-    SDL_DestroyTexture( score_message );
+    recorderStop();
+    boardMeshDestroy( BoardCells );
+    boardTextureDestroy( BoardTexels );
+    TTF_DestroyAtlas( TextAtlas );
+    hudFontDestroy( HudText );
+    SDL_DestroyRenderer( window->renderer );
 }
 
-void
-renderTick( GameState* game_state, Window* window )
-{
-    SDL_SetRenderDrawColor( window->renderer,
-                            COLOR_DARK.r,
-                            COLOR_DARK.g,
-                            COLOR_DARK.b,
-                            COLOR_DARK.a);
-    SDL_RenderClear( window->renderer );
+/**************************************************************************
+** Event filtering. Only the events eventTick handles (plus the window and
+** render events SDL's renderer watches) make it into the event queue.
+**************************************************************************/
 
-    // Draw board
-    for( int i = 0; i < BOARD_WIDTH; i++ )
+/*
+ * Runs on the thread that generated the event, before it takes the queue lock.
+ */
+static int SDLCALL
+eventFilter( void* userdata, SDL_Event* event )
+{
+    (void) userdata;
+    switch( event->type )
     {
-        for( int j = 0; j < BOARD_HEIGHT; j++ )
-        {
-            if ( matrixGet( game_state->board, i, j ) == 0)
+        // SDL_PollEvent pushes this marker on every call to tell where its pump began.
+        // It is SDL's own bookkeeping and never reaches eventTick, so it is not counted.
+        case SDL_POLLSENTINEL:
+            return 1;
+        // eventTick ignores key repeats, held keys repeat on the input tick instead.
+        case SDL_KEYDOWN:
+            if( event->key.repeat != 0 )
             {
-                // Empty board cell
-                drawCell( window, i, j, COLOR_BLACK );
-            } else
-            {
-                // Board cell containing frozen shape
-                drawCell( window, i, j, COLOR_YELLOW );
+                SDL_AtomicAdd( &EventsFiltered, 1 );
+                return 0;
             }
-        }
+            SDL_AtomicAdd( &EventsEnqueued, 1 );
+            return 1;
+        case SDL_QUIT:
+        case SDL_WINDOWEVENT:
+        case SDL_RENDER_TARGETS_RESET:
+        case SDL_RENDER_DEVICE_RESET:
+            SDL_AtomicAdd( &EventsEnqueued, 1 );
+            return 1;
+        default:
+            SDL_AtomicAdd( &EventsFiltered, 1 );
+            return 0;
     }
-
-    drawScore( window, game_state->score );
-
-    // Draw active (player-controlled) shape
-    drawTetrisShape(    window,
-                        game_state->active_shape,
-                        game_state->active_shape_x,
-                        game_state->active_shape_y,
-                        game_state->active_shape_rot );
-
-    SDL_RenderPresent( window->renderer );
 }
 
-
-
+/*
+ * Turn off the event types the game never reads, so SDL does not even build them, and
+ * filter whatever is left. Held keys are read with SDL_GetKeyboardState, which SDL
+ * keeps up to date without key up events.
+ */
 void
-inputTick( GameState* game_state )
+initEventFilter()
 {
-    const uint8_t* keysArray = SDL_GetKeyboardState( NULL );
-    if ( keysArray[SDL_SCANCODE_DOWN] )
+    static const Uint32 ignored[] =
     {
-        moveShape( game_state, 0 , 1 );
-    }
-    if( keysArray[SDL_SCANCODE_LEFT] )
-    {
-        moveShape( game_state, -1, 0 );
-    }
-    if( keysArray[SDL_SCANCODE_RIGHT] )
+        SDL_KEYUP, SDL_TEXTEDITING, SDL_TEXTINPUT, SDL_KEYMAPCHANGED,
+        SDL_MOUSEMOTION, SDL_MOUSEBUTTONDOWN, SDL_MOUSEBUTTONUP, SDL_MOUSEWHEEL,
+        SDL_FINGERDOWN, SDL_FINGERUP, SDL_FINGERMOTION, SDL_MULTIGESTURE,
+        SDL_DOLLARGESTURE, SDL_DOLLARRECORD, SDL_CLIPBOARDUPDATE,
+        SDL_DROPFILE, SDL_DROPTEXT, SDL_DROPBEGIN, SDL_DROPCOMPLETE,
+    };
+
+    SDL_StopTextInput();
+    for( size_t i = 0; i < SDL_arraysize( ignored ); i++ )
     {
-        moveShape( game_state, 1, 0 );
+        SDL_EventState( ignored[ i ], SDL_IGNORE );
     }
+    SDL_SetEventFilter( eventFilter, NULL );
 }
 
 void
-eventTick( GameState* game_state )
+printEventStats()
 {
-    SDL_Event event;
-    while( SDL_PollEvent( &event ) != 0 )
-    {
-        if( event.type == SDL_QUIT )
-        {
-            game_state->running = false;
-        }
-        else if( event.type == SDL_KEYDOWN )
-        {
-            switch( event.key.keysym.sym )
-            {
-                case SDLK_ESCAPE:
-                    game_state->running = false;
-                    break;
-                case SDLK_SPACE:
-                    rotateShape( game_state );
-                    break;
-                default:
-                    break;
-            }
-        }
-    }
+    printf( "Events: %d enqueued, %d consumed, %d filtered, at most %d waiting\n",
+            SDL_AtomicGet( &EventsEnqueued ),
+            EventsConsumed,
+            SDL_AtomicGet( &EventsFiltered ),
+            EventsMaxBacklog );
 }
 
 /**************************************************************************
@@ -621,12 +893,12 @@ initWindow(Window* window)
         return RESULT_ERROR;
     }
 
-    window->renderer = SDL_CreateRenderer( window->window_instance, -1, SDL_RENDERER_ACCELERATED );
-
-    if( window->renderer == NULL )
+    // The HUD is drawn from the built in font unless a font file is given, only then
+    // FreeType is loaded.
+    const char* font_path = SDL_getenv( FONT_ENV );
+    if( font_path == NULL )
     {
-        printf( "Could not initialize renderer. SDL_Error: %s\n", SDL_GetError() );
-        return RESULT_ERROR;
+        return RESULT_SUCCESS;
     }
 
     if( TTF_Init() == RESULT_ERROR )
@@ -636,7 +908,7 @@ initWindow(Window* window)
     }
 
     //this opens a font style and sets a size
-    Font = TTF_OpenFont(FONT_PATH, FONT_SIZE);
+    Font = TTF_OpenFont(font_path, FONT_SIZE);
     if (!Font) {
         printf("TTF_OpenFont: %s\n", TTF_GetError());
         return RESULT_ERROR;
@@ -652,21 +924,3 @@ destroyWindow( Window* window )
     SDL_DestroyWindow( window->window_instance );
     SDL_Quit();
 }
-
-// Generate a random number between min and max
-int randomInt( int min, int max )
-{
-    return rand() % (max - min + 1) + min;
-}
-
-TETRIS_SHAPE
-randomShape()
-{
-    return randomInt( 0, 6 );
-}
-
-TETRIS_ROT
-randomRotation()
-{
-    return randomInt( 0, 3 );
-}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "alloc_prof.h"
 
 Matrix*
 matrixMake( const int rows, const int cols )
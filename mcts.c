@@ -0,0 +1,455 @@
+#include "mcts.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <SDL.h>
+
+/**************************************************************************
+** Config
+**************************************************************************/
+#define MCTS_MAX_DEPTH          3           /**< Placements made in the tree before the rollout */
+#define MCTS_ROLLOUT_PIECES     2           /**< Placements made by the default policy */
+#define MCTS_EXPLORATION        0.7f        /**< UCT exploration constant */
+#define MCTS_VALUE_SCALE        1024        /**< Fixed-point scale of the shared value sums */
+#define MCTS_REWARD_SCALE       2.0f        /**< Rows cleared that map to a reward of ~0.73 */
+#define MCTS_EVAL_WEIGHT        0.05f       /**< Rows a point of board evaluation is worth */
+#define MCTS_SPAWN_OUTCOMES     ( 7 * 4 )   /**< A new shape spawns with one of 7 shapes and 4 rotations */
+
+#define NODE_UNEXPANDED         0
+#define NODE_EXPANDING          1
+#define NODE_EXPANDED           2
+
+/**************************************************************************
+** Structs
+**************************************************************************/
+
+/**
+ * The tree alternates between two kinds of nodes. A decision node has one child per
+ * move for the active shape. The child of a move is a spawn node, with one child per
+ * shape and rotation that can spawn next. Both only hold shared statistics, the game
+ * itself is replayed from the root on every iteration.
+ *
+ * The root's piece queue is copied along, so for the first PIECE_QUEUE_SIZE plies the
+ * shape that spawns is known and a spawn node gets a single child. Only deeper plies
+ * branch over all MCTS_SPAWN_OUTCOMES random shapes.
+ */
+typedef struct MctsNode
+{
+    SDL_atomic_t    visits;         /**< Counted on the way down, so in-flight visits act as virtual loss */
+    SDL_atomic_t    value;          /**< Sum of rewards in [0, 1], times MCTS_VALUE_SCALE */
+    SDL_atomic_t    state;          /**< NODE_UNEXPANDED, NODE_EXPANDING or NODE_EXPANDED */
+    int             first_child;    /**< Valid once state is NODE_EXPANDED */
+    int             child_count;
+    BotMove         move;           /**< Move that leads to this node (spawn nodes only) */
+} MctsNode;
+
+typedef struct MctsWorker
+{
+    Mcts*           mcts;
+    GameState       game_state;     /**< Scratch game the iterations are played on */
+    uint32_t        rng_state;      /**< Picks the shapes spawned during an iteration */
+    SDL_Thread*     thread;
+} MctsWorker;
+
+struct Mcts
+{
+    MctsNode*           nodes;
+    int                 node_capacity;
+    SDL_atomic_t        node_count;
+    MctsWorker*         workers;        /**< workers[ 0 ] runs on the thread calling mctsSearch */
+    int                 worker_count;
+    SDL_sem*            start;
+    SDL_sem*            done;
+    bool                quit;
+    const GameState*    root_state;
+    const NnModel*      network;        /**< Scores boards instead of BOT_DEFAULT_WEIGHTS.eval when set */
+    Uint64              deadline;
+    SDL_atomic_t        iterations;
+};
+
+/**************************************************************************
+** Tree
+**************************************************************************/
+
+// Take count nodes from the arena. Returns -1 when the arena is full.
+static int
+allocNodes( Mcts* mcts, int count )
+{
+    const int first = SDL_AtomicAdd( &mcts->node_count, count );
+    if( first + count > mcts->node_capacity )
+    {
+        return -1;
+    }
+
+    for( int i = first; i < first + count; i++ )
+    {
+        MctsNode* node = &mcts->nodes[ i ];
+        SDL_AtomicSet( &node->visits, 0 );
+        SDL_AtomicSet( &node->value, 0 );
+        SDL_AtomicSet( &node->state, NODE_UNEXPANDED );
+        node->first_child = 0;
+        node->child_count = 0;
+    }
+    return first;
+}
+
+// Make sure the children of node exist. Only one worker expands a node, the others
+// see false and roll out from there instead of waiting. A spawn node whose shape is
+// known from the queue gets one child, otherwise one per shape and rotation.
+static bool
+expandNode( Mcts* mcts, MctsNode* node, const GameState* game_state, bool decision, bool spawn_known )
+{
+    BotMove moves[ BOT_MAX_MOVES ];
+
+    if( SDL_AtomicGet( &node->state ) == NODE_EXPANDED )
+    {
+        return true;
+    }
+    if( !SDL_AtomicCAS( &node->state, NODE_UNEXPANDED, NODE_EXPANDING ) )
+    {
+        return false;
+    }
+
+    const int count = decision ? botListMoves( game_state, moves ) : spawn_known ? 1 : MCTS_SPAWN_OUTCOMES;
+    const int first = count > 0 ? allocNodes( mcts, count ) : 0;
+    if( first < 0 )
+    {
+        SDL_AtomicCAS( &node->state, NODE_EXPANDING, NODE_UNEXPANDED );
+        return false;
+    }
+
+    for( int i = 0; decision && i < count; i++ )
+    {
+        mcts->nodes[ first + i ].move = moves[ i ];
+    }
+    node->first_child = first;
+    node->child_count = count;
+
+    // The CAS is a full barrier, so the children are visible before the state is.
+    SDL_AtomicCAS( &node->state, NODE_EXPANDING, NODE_EXPANDED );
+    return true;
+}
+
+// Pick the child with the highest UCT value. Unvisited children come first.
+static int
+selectChild( Mcts* mcts, MctsNode* node )
+{
+    const float log_visits = logf( (float) SDL_AtomicGet( &node->visits ) + 1 );
+    int best = node->first_child;
+    float best_uct = -1;
+
+    for( int i = node->first_child; i < node->first_child + node->child_count; i++ )
+    {
+        MctsNode* child = &mcts->nodes[ i ];
+        const int visits = SDL_AtomicGet( &child->visits );
+        if( visits == 0 )
+        {
+            return i;
+        }
+
+        const float mean = (float) SDL_AtomicGet( &child->value ) / ( (float) visits * MCTS_VALUE_SCALE );
+        const float uct = mean + MCTS_EXPLORATION * sqrtf( log_visits / (float) visits );
+        if( uct > best_uct )
+        {
+            best = i;
+            best_uct = uct;
+        }
+    }
+    return best;
+}
+
+/**************************************************************************
+** Iterations
+**************************************************************************/
+
+static uint32_t
+nextRandom( MctsWorker* worker )
+{
+    uint32_t x = worker->rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    worker->rng_state = x;
+    return x;
+}
+
+// Play a few shapes with the greedy bot and turn the result into a reward in [0, 1].
+// Rows cleared since the root count, plus the evaluation of the board left behind.
+static float
+rollout( const Mcts* mcts, GameState* game_state, int root_score )
+{
+    BotMove move;
+    PackedBoard board;
+    float eval;
+
+    for( int piece = 0; piece < MCTS_ROLLOUT_PIECES && !game_state->game_over; piece++ )
+    {
+        if( !botFindMoveWith( game_state, &BOT_DEFAULT_WEIGHTS, mcts->network, &move ) )
+        {
+            return 0;
+        }
+        botApplyMove( game_state, &move );
+    }
+
+    if( game_state->game_over )
+    {
+        return 0;
+    }
+
+    packBoard( game_state->board, &board );
+    if( mcts->network != NULL )
+    {
+        nnEvalBoards( mcts->network, &board, 1, &eval );
+    } else
+    {
+        evalBoards( &board, 1, &BOT_DEFAULT_WEIGHTS.eval, &eval );
+    }
+
+    const float rows = (float) ( game_state->score - root_score ) / SCORE_PER_ROW;
+    return 1.0f / ( 1.0f + expf( -( rows + MCTS_EVAL_WEIGHT * eval ) / MCTS_REWARD_SCALE ) );
+}
+
+static void
+runIteration( MctsWorker* worker )
+{
+    Mcts* mcts = worker->mcts;
+    GameState* game_state = &worker->game_state;
+    int path[ 2 * MCTS_MAX_DEPTH + 1 ];
+    int depth = 0;
+    int index = 0;
+    float reward;
+
+    copyGameState( game_state, mcts->root_state );
+    game_state->rng_state = nextRandom( worker );
+
+    SDL_AtomicAdd( &mcts->nodes[ index ].visits, 1 );
+    path[ depth++ ] = index;
+
+    for( int ply = 0; ply < MCTS_MAX_DEPTH && !game_state->game_over; ply++ )
+    {
+        // Decision node: pick a move and play it with the game's own rules, which also
+        // freezes the shape, clears rows and spawns the next shape.
+        MctsNode* node = &mcts->nodes[ index ];
+        if( !expandNode( mcts, node, game_state, true, false ) )
+        {
+            break;
+        }
+        if( node->child_count == 0 )
+        {
+            game_state->game_over = true;
+            break;
+        }
+
+        index = selectChild( mcts, node );
+        SDL_AtomicAdd( &mcts->nodes[ index ].visits, 1 );
+        path[ depth++ ] = index;
+        botApplyMove( game_state, &mcts->nodes[ index ].move );
+
+        // Spawn node: follow the shape that actually spawned. The shapes of the first
+        // plies come from the root's queue, the same in every iteration.
+        node = &mcts->nodes[ index ];
+        if( game_state->game_over || !expandNode( mcts, node, game_state, false, ply < PIECE_QUEUE_SIZE ) )
+        {
+            break;
+        }
+
+        index = node->first_child;
+        if( node->child_count > 1 )
+        {
+            index += game_state->active_shape * 4 + game_state->active_shape_rot;
+        }
+        SDL_AtomicAdd( &mcts->nodes[ index ].visits, 1 );
+        path[ depth++ ] = index;
+    }
+
+    reward = game_state->game_over ? 0 : rollout( mcts, game_state, mcts->root_state->score );
+
+    const int value = (int) ( reward * MCTS_VALUE_SCALE );
+    for( int i = 0; i < depth; i++ )
+    {
+        SDL_AtomicAdd( &mcts->nodes[ path[ i ] ].value, value );
+    }
+    SDL_AtomicAdd( &mcts->iterations, 1 );
+}
+
+static void
+runUntilDeadline( MctsWorker* worker )
+{
+    do
+    {
+        runIteration( worker );
+    } while( SDL_GetPerformanceCounter() < worker->mcts->deadline );
+}
+
+static int
+workerThread( void* data )
+{
+    MctsWorker* worker = data;
+    Mcts* mcts = worker->mcts;
+
+    for( ;; )
+    {
+        SDL_SemWait( mcts->start );
+        if( mcts->quit )
+        {
+            break;
+        }
+        runUntilDeadline( worker );
+        SDL_SemPost( mcts->done );
+    }
+    return 0;
+}
+
+/**************************************************************************
+** API
+**************************************************************************/
+
+/*
+ * Create a search with threads workers (including the caller of mctsSearch) and a node
+ * arena of node_capacity nodes. botInit must have been called. Returns NULL when the
+ * arena or the workers cannot be allocated. Workers whose thread fails to start are left
+ * out, the search then runs on fewer threads.
+ */
+Mcts*
+mctsCreate( int threads, int node_capacity )
+{
+    Mcts* mcts = SDL_calloc( 1, sizeof( Mcts ) );
+    if( mcts == NULL )
+    {
+        return NULL;
+    }
+
+    const int worker_count = threads > 0 ? threads : 1;
+    mcts->node_capacity = node_capacity;
+    mcts->nodes = SDL_calloc( node_capacity, sizeof( MctsNode ) );
+    mcts->workers = SDL_calloc( worker_count, sizeof( MctsWorker ) );
+    mcts->start = SDL_CreateSemaphore( 0 );
+    mcts->done = SDL_CreateSemaphore( 0 );
+    if( mcts->nodes == NULL || mcts->workers == NULL || mcts->start == NULL || mcts->done == NULL )
+    {
+        mctsDestroy( mcts );
+        return NULL;
+    }
+
+    // worker_count only counts workers that are ready, so mctsSearch never waits on a
+    // thread that does not exist and mctsDestroy only frees what was set up.
+    for( int i = 0; i < worker_count; i++ )
+    {
+        MctsWorker* worker = &mcts->workers[ i ];
+        worker->mcts = mcts;
+        worker->rng_state = 0x9E3779B9u * ( i + 1 );
+        initGameState( &worker->game_state, worker->rng_state );
+        if( i > 0 )
+        {
+            worker->thread = SDL_CreateThread( workerThread, "mcts", worker );
+            if( worker->thread == NULL )
+            {
+                printf( "Could only start %d of %d search threads. SDL_Error: %s\n", i, worker_count, SDL_GetError() );
+                freeGameState( &worker->game_state );
+                break;
+            }
+        }
+        mcts->worker_count++;
+    }
+
+    return mcts;
+}
+
+void
+mctsDestroy( Mcts* mcts )
+{
+    if( mcts == NULL )
+    {
+        return;
+    }
+
+    mcts->quit = true;
+    for( int i = 1; i < mcts->worker_count; i++ )
+    {
+        SDL_SemPost( mcts->start );
+    }
+    for( int i = 0; i < mcts->worker_count; i++ )
+    {
+        if( mcts->workers[ i ].thread != NULL )
+        {
+            SDL_WaitThread( mcts->workers[ i ].thread, NULL );
+        }
+        freeGameState( &mcts->workers[ i ].game_state );
+    }
+
+    SDL_DestroySemaphore( mcts->start );
+    SDL_DestroySemaphore( mcts->done );
+    SDL_free( mcts->workers );
+    SDL_free( mcts->nodes );
+    SDL_free( mcts );
+}
+
+/*
+ * Score boards with network (nn_eval.h) instead of the heuristic evaluation, or with the
+ * heuristic again when network is NULL. Its outputs should be on the heuristic's scale.
+ * Must not be called during a search, the network must outlive its use.
+ */
+void
+mctsSetNetwork( Mcts* mcts, const NnModel* network )
+{
+    mcts->network = network;
+}
+
+/*
+ * Search for the best move for the active shape of game_state for budget_ms on all
+ * workers. The tree is rebuilt for every search. Returns false when no move avoids
+ * game over. iterations (may be NULL) receives the number of playouts, so different
+ * searches can be compared at the same budget.
+ */
+bool
+mctsSearch( Mcts* mcts, const GameState* game_state, int budget_ms, BotMove* move, int* iterations )
+{
+    BotMove moves[ BOT_MAX_MOVES ];
+    if( botListMoves( game_state, moves ) == 0 )
+    {
+        return false;
+    }
+
+    SDL_AtomicSet( &mcts->node_count, 0 );
+    SDL_AtomicSet( &mcts->iterations, 0 );
+    allocNodes( mcts, 1 );
+    mcts->root_state = game_state;
+    mcts->deadline = SDL_GetPerformanceCounter() + SDL_GetPerformanceFrequency() * budget_ms / 1000;
+
+    for( int i = 1; i < mcts->worker_count; i++ )
+    {
+        SDL_SemPost( mcts->start );
+    }
+    runUntilDeadline( &mcts->workers[ 0 ] );
+    for( int i = 1; i < mcts->worker_count; i++ )
+    {
+        SDL_SemWait( mcts->done );
+    }
+
+    // The most visited move is the most robust choice. A tree that never got past the
+    // root (arena too small) falls back to the greedy bot.
+    const MctsNode* root = &mcts->nodes[ 0 ];
+    if( root->child_count == 0 )
+    {
+        return botFindMoveWith( game_state, &BOT_DEFAULT_WEIGHTS, mcts->network, move );
+    }
+
+    int best = root->first_child;
+    for( int i = root->first_child; i < root->first_child + root->child_count; i++ )
+    {
+        if( SDL_AtomicGet( &mcts->nodes[ i ].visits ) > SDL_AtomicGet( &mcts->nodes[ best ].visits ) )
+        {
+            best = i;
+        }
+    }
+
+    const int visits = SDL_AtomicGet( &mcts->nodes[ best ].visits );
+    *move = mcts->nodes[ best ].move;
+    move->score = visits > 0 ? (float) SDL_AtomicGet( &mcts->nodes[ best ].value ) / ( (float) visits * MCTS_VALUE_SCALE ) : 0;
+
+    if( iterations != NULL )
+    {
+        *iterations = SDL_AtomicGet( &mcts->iterations );
+    }
+    return true;
+}
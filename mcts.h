@@ -0,0 +1,29 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <stdbool.h>
+#include "bot.h"
+#include "game.h"
+
+/**************************************************************************
+** Monte Carlo tree search autoplayer. Workers share one tree whose nodes
+** come from a fixed arena, so a search never allocates nodes.
+**************************************************************************/
+
+#define MCTS_DEFAULT_NODES      ( 1 << 18 )
+
+typedef struct Mcts Mcts;
+
+Mcts*
+mctsCreate( int threads, int node_capacity );
+
+void
+mctsDestroy( Mcts* mcts );
+
+void
+mctsSetNetwork( Mcts* mcts, const NnModel* network );
+
+bool
+mctsSearch( Mcts* mcts, const GameState* game_state, int budget_ms, BotMove* move, int* iterations );
+
+#endif //MCTS_H
@@ -0,0 +1,434 @@
+#include "nn_eval.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <SDL.h>
+#include <SDL_bits.h>
+
+#ifdef _WIN32
+#define NN_MMAP 0
+#else
+#define NN_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define NN_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(NN_X86) && ( defined(__GNUC__) || defined(__clang__) )
+#define NN_TARGET( isa ) __attribute__(( target( isa ) ))
+#else
+#define NN_TARGET( isa )
+#endif
+
+#define NN_INPUTS   ( BOARD_WIDTH * BOARD_HEIGHT )
+
+/**************************************************************************
+** Structs
+**************************************************************************/
+
+typedef struct NnLayer
+{
+    int             type;               /**< NN_LAYER_F32 or NN_LAYER_I8 */
+    int             inputs;
+    int             outputs;
+    int             activation;
+    float           scale;              /**< Dequantization scale of int8 weights */
+    const void*     weights;            /**< inputs x outputs, points into the mapped file */
+    const float*    bias;
+} NnLayer;
+
+struct NnModel
+{
+    void*           data;               /**< Mapped weights file */
+    size_t          size;
+    int             layer_count;
+    NnLayer         layers[ NN_MAX_LAYERS ];
+    bool            use_avx2;
+};
+
+/**************************************************************************
+** Loading
+**************************************************************************/
+
+static void*
+mapFile( const char* path, size_t* size )
+{
+#if NN_MMAP
+    struct stat st;
+    const int fd = open( path, O_RDONLY );
+    if( fd < 0 )
+    {
+        return NULL;
+    }
+    if( fstat( fd, &st ) < 0 || st.st_size == 0 )
+    {
+        close( fd );
+        return NULL;
+    }
+
+    void* data = mmap( NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if( data == MAP_FAILED )
+    {
+        return NULL;
+    }
+    *size = (size_t) st.st_size;
+    return data;
+#else
+    return SDL_LoadFile( path, size );
+#endif
+}
+
+static void
+unmapFile( void* data, size_t size )
+{
+#if NN_MMAP
+    munmap( data, size );
+#else
+    (void) size;
+    SDL_free( data );
+#endif
+}
+
+// Read a 32-bit value at *offset and advance it. Returns false past the end of the file.
+static bool
+readU32( const NnModel* model, size_t* offset, uint32_t* value )
+{
+    if( *offset + 4 > model->size )
+    {
+        return false;
+    }
+    memcpy( value, (const uint8_t*) model->data + *offset, 4 );
+    *offset += 4;
+    return true;
+}
+
+static bool
+parseLayers( NnModel* model )
+{
+    size_t offset = 4;
+    uint32_t layer_count;
+
+    if( model->size < 4 || memcmp( model->data, "TNN1", 4 ) != 0 )
+    {
+        printf( "Not a network weights file\n" );
+        return false;
+    }
+    if( !readU32( model, &offset, &layer_count ) || layer_count == 0 || layer_count > NN_MAX_LAYERS )
+    {
+        printf( "Unsupported layer count\n" );
+        return false;
+    }
+
+    int inputs = NN_INPUTS;
+    for( uint32_t l = 0; l < layer_count; l++ )
+    {
+        NnLayer* layer = &model->layers[ l ];
+        uint32_t type, layer_inputs, outputs, activation, scale;
+
+        if( !readU32( model, &offset, &type )           ||
+            !readU32( model, &offset, &layer_inputs )   ||
+            !readU32( model, &offset, &outputs )        ||
+            !readU32( model, &offset, &activation )     ||
+            !readU32( model, &offset, &scale ) )
+        {
+            printf( "Truncated layer %u\n", l );
+            return false;
+        }
+        if( ( type != NN_LAYER_F32 && type != NN_LAYER_I8 ) ||
+            (int) layer_inputs != inputs                    ||
+            outputs == 0 || outputs > NN_MAX_WIDTH )
+        {
+            printf( "Layer %u does not fit the network\n", l );
+            return false;
+        }
+        if( activation != NN_ACTIVATION_NONE && activation != NN_ACTIVATION_RELU )
+        {
+            printf( "Layer %u has unknown activation %u\n", l, activation );
+            return false;
+        }
+
+        const size_t weight_size = (size_t) layer_inputs * outputs * ( type == NN_LAYER_F32 ? 4 : 1 );
+        const size_t weight_padded = ( weight_size + 3 ) & ~(size_t) 3;
+        if( offset + weight_padded + outputs * sizeof( float ) > model->size )
+        {
+            printf( "Truncated layer %u\n", l );
+            return false;
+        }
+
+        layer->type = (int) type;
+        layer->inputs = (int) layer_inputs;
+        layer->outputs = (int) outputs;
+        layer->activation = (int) activation;
+        memcpy( &layer->scale, &scale, sizeof( float ) );
+        layer->weights = (const uint8_t*) model->data + offset;
+        layer->bias = (const float*) ( (const uint8_t*) model->data + offset + weight_padded );
+        offset += weight_padded + outputs * sizeof( float );
+        inputs = (int) outputs;
+    }
+
+    if( inputs != 1 )
+    {
+        printf( "The last layer must have a single output\n" );
+        return false;
+    }
+
+    model->layer_count = (int) layer_count;
+    return true;
+}
+
+/*
+ * Map a weights file. The weights are used in place and stay mapped until nnFree.
+ * Returns NULL when the file cannot be read or does not describe a board evaluator.
+ */
+NnModel*
+nnLoad( const char* path )
+{
+    NnModel* model = SDL_calloc( 1, sizeof( NnModel ) );
+    if( model == NULL )
+    {
+        return NULL;
+    }
+
+    model->data = mapFile( path, &model->size );
+    if( model->data == NULL )
+    {
+        printf( "Could not map %s\n", path );
+        SDL_free( model );
+        return NULL;
+    }
+
+    if( !parseLayers( model ) )
+    {
+        nnFree( model );
+        return NULL;
+    }
+
+#ifdef NN_X86
+    model->use_avx2 = SDL_HasAVX2();
+#endif
+    return model;
+}
+
+void
+nnFree( NnModel* model )
+{
+    if( model == NULL )
+    {
+        return;
+    }
+    unmapFile( model->data, model->size );
+    SDL_free( model );
+}
+
+/**************************************************************************
+** Kernels. All of them compute out += a * row (int8 rows also times the
+** layer scale) in the same order, so the AVX2 and scalar paths match exactly.
+**************************************************************************/
+
+static void
+axpyF32( float* out, float a, const float* row, int n )
+{
+    for( int o = 0; o < n; o++ )
+    {
+        out[ o ] += a * row[ o ];
+    }
+}
+
+static void
+axpyI8( float* out, float a, const int8_t* row, int n )
+{
+    for( int o = 0; o < n; o++ )
+    {
+        out[ o ] += a * (float) row[ o ];
+    }
+}
+
+#ifdef NN_X86
+
+NN_TARGET( "avx2" ) static void
+axpyF32AVX2( float* out, float a, const float* row, int n )
+{
+    const __m256 va = _mm256_set1_ps( a );
+    int o = 0;
+    for( ; o + 8 <= n; o += 8 )
+    {
+        const __m256 sum = _mm256_add_ps( _mm256_loadu_ps( &out[ o ] ),
+                                          _mm256_mul_ps( va, _mm256_loadu_ps( &row[ o ] ) ) );
+        _mm256_storeu_ps( &out[ o ], sum );
+    }
+    axpyF32( &out[ o ], a, &row[ o ], n - o );
+}
+
+NN_TARGET( "avx2" ) static void
+axpyI8AVX2( float* out, float a, const int8_t* row, int n )
+{
+    const __m256 va = _mm256_set1_ps( a );
+    int o = 0;
+    for( ; o + 8 <= n; o += 8 )
+    {
+        const __m256i w32 = _mm256_cvtepi8_epi32( _mm_loadl_epi64( (const __m128i*) &row[ o ] ) );
+        const __m256 sum = _mm256_add_ps( _mm256_loadu_ps( &out[ o ] ),
+                                          _mm256_mul_ps( va, _mm256_cvtepi32_ps( w32 ) ) );
+        _mm256_storeu_ps( &out[ o ], sum );
+    }
+    axpyI8( &out[ o ], a, &row[ o ], n - o );
+}
+
+#endif // NN_X86
+
+// out += a * (row input of the layer's weights).
+static void
+addWeightRow( const NnLayer* layer, int input, float a, float* out, bool avx2 )
+{
+    const int n = layer->outputs;
+
+    if( layer->type == NN_LAYER_F32 )
+    {
+        const float* row = (const float*) layer->weights + (size_t) input * n;
+#ifdef NN_X86
+        if( avx2 )
+        {
+            axpyF32AVX2( out, a, row, n );
+            return;
+        }
+#endif
+        axpyF32( out, a, row, n );
+    } else
+    {
+        const int8_t* row = (const int8_t*) layer->weights + (size_t) input * n;
+#ifdef NN_X86
+        if( avx2 )
+        {
+            axpyI8AVX2( out, a * layer->scale, row, n );
+            return;
+        }
+#endif
+        axpyI8( out, a * layer->scale, row, n );
+    }
+}
+
+static void
+activate( const NnLayer* layer, float* values )
+{
+    if( layer->activation != NN_ACTIVATION_RELU )
+    {
+        return;
+    }
+    for( int o = 0; o < layer->outputs; o++ )
+    {
+        values[ o ] = values[ o ] > 0 ? values[ o ] : 0;
+    }
+}
+
+/**************************************************************************
+** Evaluation
+**************************************************************************/
+
+// Push up to NN_BATCH boards through the network. In every layer each weight row is
+// loaded once and applied to every board in the batch before moving on to the next one.
+static void
+evalBatch( const NnModel* model, const PackedBoard* boards, int count, float* scores, bool avx2 )
+{
+    float buffers[ 2 ][ NN_BATCH ][ NN_MAX_WIDTH ];
+    float ( *in )[ NN_MAX_WIDTH ] = buffers[ 0 ];
+    float ( *out )[ NN_MAX_WIDTH ] = buffers[ 1 ];
+
+    // First layer: the inputs are the board bits, so a cell's row is only added to the
+    // boards that have it filled, and the rows of cells no board has are skipped.
+    const NnLayer* first = &model->layers[ 0 ];
+    for( int b = 0; b < count; b++ )
+    {
+        memcpy( in[ b ], first->bias, sizeof( float ) * first->outputs );
+    }
+    for( int x = 0; x < BOARD_WIDTH; x++ )
+    {
+        uint32_t any = 0;
+        for( int b = 0; b < count; b++ )
+        {
+            any |= boards[ b ].cols[ x ];
+        }
+        while( any != 0 )
+        {
+            const int y = SDL_MostSignificantBitIndex32( any );
+            for( int b = 0; b < count; b++ )
+            {
+                if( boards[ b ].cols[ x ] & ( 1u << y ) )
+                {
+                    addWeightRow( first, x * BOARD_HEIGHT + y, 1.0f, in[ b ], avx2 );
+                }
+            }
+            any &= ~( 1u << y );
+        }
+    }
+    for( int b = 0; b < count; b++ )
+    {
+        activate( first, in[ b ] );
+    }
+
+    for( int l = 1; l < model->layer_count; l++ )
+    {
+        const NnLayer* layer = &model->layers[ l ];
+
+        for( int b = 0; b < count; b++ )
+        {
+            memcpy( out[ b ], layer->bias, sizeof( float ) * layer->outputs );
+        }
+        for( int i = 0; i < layer->inputs; i++ )
+        {
+            for( int b = 0; b < count; b++ )
+            {
+                if( in[ b ][ i ] != 0 )
+                {
+                    addWeightRow( layer, i, in[ b ][ i ], out[ b ], avx2 );
+                }
+            }
+        }
+        for( int b = 0; b < count; b++ )
+        {
+            activate( layer, out[ b ] );
+        }
+
+        float ( *swap )[ NN_MAX_WIDTH ] = in;
+        in = out;
+        out = swap;
+    }
+
+    for( int b = 0; b < count; b++ )
+    {
+        scores[ b ] = in[ b ][ 0 ];
+    }
+}
+
+/*
+ * Score count boards with the network, using AVX2 when the CPU has it. Safe to call from
+ * several threads on the same model.
+ */
+void
+nnEvalBoards( const NnModel* model, const PackedBoard* boards, int count, float* scores )
+{
+    for( int i = 0; i < count; i += NN_BATCH )
+    {
+        const int batch = count - i < NN_BATCH ? count - i : NN_BATCH;
+        evalBatch( model, &boards[ i ], batch, &scores[ i ], model->use_avx2 );
+    }
+}
+
+/*
+ * Reference path without SIMD, gives the same results as nnEvalBoards.
+ */
+void
+nnEvalBoardsScalar( const NnModel* model, const PackedBoard* boards, int count, float* scores )
+{
+    for( int i = 0; i < count; i += NN_BATCH )
+    {
+        const int batch = count - i < NN_BATCH ? count - i : NN_BATCH;
+        evalBatch( model, &boards[ i ], batch, &scores[ i ], false );
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef NN_EVAL_H
+#define NN_EVAL_H
+
+#include "board_eval.h"
+
+/**************************************************************************
+** Learned board evaluator. A small dense network, run on the CPU, that
+** scores packed boards in batches.
+**
+** Weights file (little endian, every block padded to 4 bytes):
+**   char[4]    "TNN1"
+**   uint32     layer count
+**   per layer:
+**     uint32   type            NN_LAYER_F32 or NN_LAYER_I8
+**     uint32   inputs
+**     uint32   outputs
+**     uint32   activation      NN_ACTIVATION_NONE or NN_ACTIVATION_RELU
+**     float    scale           multiplies int8 weights (ignored for float32)
+**     weights  inputs x outputs, input-major (all weights of input 0 first)
+**     float    bias[ outputs ]
+**
+** The first layer takes the board cells (BOARD_WIDTH * BOARD_HEIGHT inputs,
+** cell (x, y) at input x * BOARD_HEIGHT + y), the last layer has one output.
+**************************************************************************/
+
+#define NN_LAYER_F32            0
+#define NN_LAYER_I8             1
+#define NN_ACTIVATION_NONE      0
+#define NN_ACTIVATION_RELU      1
+#define NN_MAX_LAYERS           8
+#define NN_MAX_WIDTH            256     /**< Widest layer supported */
+#define NN_BATCH                16      /**< Boards pushed through the network together */
+
+typedef struct NnModel NnModel;
+
+NnModel*
+nnLoad( const char* path );
+
+void
+nnFree( NnModel* model );
+
+void
+nnEvalBoards( const NnModel* model, const PackedBoard* boards, int count, float* scores );
+
+void
+nnEvalBoardsScalar( const NnModel* model, const PackedBoard* boards, int count, float* scores );
+
+#endif //NN_EVAL_H
@@ -0,0 +1,397 @@
+#include "obs_encoder.h"
+
+#include <string.h>
+#include <SDL.h>
+#include <SDL_bits.h>
+#include "board_eval.h"
+#include "env_shm.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define OBS_X86 1
+#include <immintrin.h>
+#endif
+
+// MSVC allows intrinsics for any instruction set, GCC and Clang need the function
+// to be compiled for the target first.
+#if defined(OBS_X86) && ( defined(__GNUC__) || defined(__clang__) )
+#define OBS_TARGET( isa ) __attribute__(( target( isa ) ))
+#else
+#define OBS_TARGET( isa )
+#endif
+
+#define ROW_MASK        ( ( 1u << BOARD_WIDTH ) - 1 )
+#define STREAM_WORDS    ( ( OBS_BOARD_SIZE + 31 ) / 32 )
+
+typedef void ( *EncodeBoardsFunc )( const EnvObservation*, int, uint16_t*, uint8_t* );
+
+/**************************************************************************
+** Packing
+**************************************************************************/
+
+/*
+ * Fill observation from a game. steps is not part of the game and is left to the caller.
+ */
+void
+obsFromGame( const GameState* game_state, EnvObservation* observation )
+{
+    packBoard( game_state->board, (PackedBoard*) observation->board );
+    observation->shape = game_state->active_shape;
+    observation->rot = game_state->active_shape_rot;
+    observation->x = game_state->active_shape_x;
+    observation->y = game_state->active_shape_y;
+    for( int i = 0; i < PIECE_QUEUE_SIZE; i++ )
+    {
+        TETRIS_SHAPE shape;
+        TETRIS_ROT rot;
+        peekShape( game_state, i, &shape, &rot );
+        observation->next_shapes[ i ] = shape;
+        observation->next_rots[ i ] = rot;
+    }
+    observation->score = game_state->score;
+}
+
+// Concatenate the rows into one row-major bit stream, bit y * BOARD_WIDTH + x is cell
+// (x, y). Expanding the stream bit by bit gives the cell tensor. Inline, so the SIMD
+// kernels do not call plain SSE code with their upper register halves dirty.
+static inline void
+rowsToStream( const uint16_t* rows, uint32_t* words )
+{
+    memset( words, 0, sizeof( uint32_t ) * STREAM_WORDS );
+    for( int y = 0; y < BOARD_HEIGHT; y++ )
+    {
+        const int bit = y * BOARD_WIDTH;
+        const int shift = bit & 31;
+        words[ bit >> 5 ] |= (uint32_t) rows[ y ] << shift;
+        if( shift + BOARD_WIDTH > 32 )
+        {
+            words[ ( bit >> 5 ) + 1 ] |= (uint32_t) rows[ y ] >> ( 32 - shift );
+        }
+    }
+}
+
+static inline void
+expandBitsScalar( const uint32_t* words, int first_bit, uint8_t* cells )
+{
+    for( int bit = first_bit; bit < OBS_BOARD_SIZE; bit++ )
+    {
+        cells[ bit ] = (uint8_t) ( ( words[ bit >> 5 ] >> ( bit & 31 ) ) & 1u );
+    }
+}
+
+/**************************************************************************
+** Scalar reference path
+**************************************************************************/
+
+static void
+encodeBoardsScalar( const EnvObservation* observations, int count, uint16_t* board_bits, uint8_t* board )
+{
+    for( int i = 0; i < count; i++ )
+    {
+        const uint32_t* cols = observations[ i ].board;
+        for( int y = 0; y < BOARD_HEIGHT; y++ )
+        {
+            uint16_t row = 0;
+            for( int x = 0; x < BOARD_WIDTH; x++ )
+            {
+                const uint8_t cell = (uint8_t) ( ( cols[ x ] >> y ) & 1u );
+                row |= (uint16_t) ( cell << x );
+                if( board != NULL )
+                {
+                    board[ (size_t) i * OBS_BOARD_SIZE + y * BOARD_WIDTH + x ] = cell;
+                }
+            }
+            if( board_bits != NULL )
+            {
+                board_bits[ (size_t) i * OBS_BOARD_BITS_SIZE + y ] = row;
+            }
+        }
+    }
+}
+
+/**************************************************************************
+** SIMD kernels. The columns are transposed into rows by shifting each row's
+** bit into the sign bit of every lane and collecting the signs with a
+** movemask, then the rows are expanded to one byte per cell 16 or 32 cells
+** at a time.
+**************************************************************************/
+#ifdef OBS_X86
+
+// The column loads run past board[] into the fields after it, those lanes are masked off.
+_Static_assert( sizeof( EnvObservation ) >= 16 * sizeof( uint32_t ), "Column loads stay inside the observation" );
+
+OBS_TARGET( "avx2" ) static void
+encodeBoardsAVX2( const EnvObservation* observations, int count, uint16_t* board_bits, uint8_t* board )
+{
+    const __m256i shuffle = _mm256_setr_epi8( 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                              2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3 );
+    const __m256i bits = _mm256_set1_epi64x( (long long) 0x8040201008040201ull );
+    const __m256i one = _mm256_set1_epi8( 1 );
+
+    for( int i = 0; i < count; i++ )
+    {
+        uint16_t local_rows[ BOARD_HEIGHT ];
+        uint16_t* rows = board_bits != NULL ? board_bits + (size_t) i * OBS_BOARD_BITS_SIZE : local_rows;
+
+        // Put bit BOARD_HEIGHT - 1 in the sign bit, then walk up the board one shift at a time.
+        __m256i lo = _mm256_loadu_si256( (const __m256i*) observations[ i ].board );
+        __m256i hi = _mm256_loadu_si256( (const __m256i*) ( observations[ i ].board + 8 ) );
+        lo = _mm256_slli_epi32( lo, 32 - BOARD_HEIGHT );
+        hi = _mm256_slli_epi32( hi, 32 - BOARD_HEIGHT );
+        for( int y = BOARD_HEIGHT - 1; y >= 0; y-- )
+        {
+            const int row = _mm256_movemask_ps( _mm256_castsi256_ps( lo ) ) |
+                            _mm256_movemask_ps( _mm256_castsi256_ps( hi ) ) << 8;
+            rows[ y ] = (uint16_t) ( row & ROW_MASK );
+            lo = _mm256_slli_epi32( lo, 1 );
+            hi = _mm256_slli_epi32( hi, 1 );
+        }
+
+        if( board == NULL )
+        {
+            continue;
+        }
+
+        uint32_t words[ STREAM_WORDS ];
+        uint8_t* cells = board + (size_t) i * OBS_BOARD_SIZE;
+        rowsToStream( rows, words );
+        for( int w = 0; w < OBS_BOARD_SIZE / 32; w++ )
+        {
+            // Byte k gets stream byte k / 8, then keeps only bit k % 8 of it.
+            __m256i v = _mm256_shuffle_epi8( _mm256_set1_epi32( (int) words[ w ] ), shuffle );
+            v = _mm256_min_epu8( _mm256_and_si256( v, bits ), one );
+            _mm256_storeu_si256( (__m256i*) ( cells + 32 * w ), v );
+        }
+        expandBitsScalar( words, OBS_BOARD_SIZE / 32 * 32, cells );
+    }
+}
+
+OBS_TARGET( "sse2" ) static void
+encodeBoardsSSE2( const EnvObservation* observations, int count, uint16_t* board_bits, uint8_t* board )
+{
+    const __m128i bits = _mm_set1_epi64x( (long long) 0x8040201008040201ull );
+    const __m128i one = _mm_set1_epi8( 1 );
+
+    for( int i = 0; i < count; i++ )
+    {
+        uint16_t local_rows[ BOARD_HEIGHT ];
+        uint16_t* rows = board_bits != NULL ? board_bits + (size_t) i * OBS_BOARD_BITS_SIZE : local_rows;
+
+        __m128i cols[ 4 ];
+        for( int r = 0; r < 4; r++ )
+        {
+            cols[ r ] = _mm_loadu_si128( (const __m128i*) ( observations[ i ].board + 4 * r ) );
+            cols[ r ] = _mm_slli_epi32( cols[ r ], 32 - BOARD_HEIGHT );
+        }
+        for( int y = BOARD_HEIGHT - 1; y >= 0; y-- )
+        {
+            int row = 0;
+            for( int r = 0; r < 4; r++ )
+            {
+                row |= _mm_movemask_ps( _mm_castsi128_ps( cols[ r ] ) ) << ( 4 * r );
+                cols[ r ] = _mm_slli_epi32( cols[ r ], 1 );
+            }
+            rows[ y ] = (uint16_t) ( row & ROW_MASK );
+        }
+
+        if( board == NULL )
+        {
+            continue;
+        }
+
+        uint32_t words[ STREAM_WORDS ];
+        uint8_t* cells = board + (size_t) i * OBS_BOARD_SIZE;
+        rowsToStream( rows, words );
+        for( int h = 0; h < OBS_BOARD_SIZE / 16; h++ )
+        {
+            // Without a byte shuffle, spread the two stream bytes with unpacks: bytes 0-7
+            // get the low one, bytes 8-15 the high one.
+            __m128i v = _mm_cvtsi32_si128( (int) ( ( words[ h >> 1 ] >> ( 16 * ( h & 1 ) ) ) & 0xFFFF ) );
+            v = _mm_unpacklo_epi8( v, v );
+            v = _mm_unpacklo_epi16( v, v );
+            v = _mm_unpacklo_epi32( v, v );
+            v = _mm_min_epu8( _mm_and_si128( v, bits ), one );
+            _mm_storeu_si128( (__m128i*) ( cells + 16 * h ), v );
+        }
+        expandBitsScalar( words, OBS_BOARD_SIZE / 16 * 16, cells );
+    }
+}
+
+#endif // OBS_X86
+
+/**************************************************************************
+** Kernel selection
+**************************************************************************/
+
+static SDL_atomic_t ObsKernel;      /**< 0 = not selected yet, then 1 + index in OBS_KERNELS */
+
+static const struct
+{
+    const char*         name;
+    EncodeBoardsFunc    func;
+} OBS_KERNELS[] =
+{
+    { "scalar", encodeBoardsScalar },
+#ifdef OBS_X86
+    { "sse2",   encodeBoardsSSE2 },
+    { "avx2",   encodeBoardsAVX2 },
+#endif
+};
+
+// The kernels are ordered by width, a CPU that runs one also runs those before it.
+static int
+widestObsKernel()
+{
+#ifdef OBS_X86
+    if( SDL_HasAVX2() )
+    {
+        return 2;
+    }
+    if( SDL_HasSSE2() )
+    {
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+static int
+selectObsKernel()
+{
+    int kernel = SDL_AtomicGet( &ObsKernel );
+    if( kernel > 0 )
+    {
+        return kernel - 1;
+    }
+
+    kernel = widestObsKernel();
+    SDL_AtomicSet( &ObsKernel, kernel + 1 );
+    return kernel;
+}
+
+/**************************************************************************
+** Public
+**************************************************************************/
+
+/*
+ * Buffers that start at game index, to encode a part of a batch.
+ */
+ObsBuffers
+obsBuffersAt( const ObsBuffers* buffers, int index )
+{
+    ObsBuffers at;
+    at.board_bits = buffers->board_bits != NULL ? buffers->board_bits + (size_t) index * OBS_BOARD_BITS_SIZE : NULL;
+    at.board = buffers->board != NULL ? buffers->board + (size_t) index * OBS_BOARD_SIZE : NULL;
+    at.piece = buffers->piece != NULL ? buffers->piece + (size_t) index * OBS_PIECE_SIZE : NULL;
+    at.next_pieces = buffers->next_pieces != NULL ? buffers->next_pieces + (size_t) index * OBS_NEXT_SIZE : NULL;
+    at.position = buffers->position != NULL ? buffers->position + (size_t) index * OBS_POSITION_SIZE : NULL;
+    at.heights = buffers->heights != NULL ? buffers->heights + (size_t) index * OBS_HEIGHTS_SIZE : NULL;
+    return at;
+}
+
+// Everything but the board is a handful of bytes per game and stays scalar.
+static void
+encodePieces( const EnvObservation* observations, int count, const ObsBuffers* buffers )
+{
+    for( int i = 0; i < count; i++ )
+    {
+        const EnvObservation* observation = &observations[ i ];
+
+        if( buffers->piece != NULL )
+        {
+            uint8_t* piece = buffers->piece + (size_t) i * OBS_PIECE_SIZE;
+            memset( piece, 0, OBS_PIECE_SIZE );
+            piece[ observation->shape ] = 1;
+            piece[ OBS_SHAPE_COUNT + observation->rot ] = 1;
+        }
+
+        if( buffers->next_pieces != NULL )
+        {
+            uint8_t* next = buffers->next_pieces + (size_t) i * OBS_NEXT_SIZE;
+            memset( next, 0, OBS_NEXT_SIZE );
+            for( int q = 0; q < PIECE_QUEUE_SIZE; q++ )
+            {
+                next[ q * OBS_SHAPE_COUNT + observation->next_shapes[ q ] ] = 1;
+            }
+        }
+
+        if( buffers->position != NULL )
+        {
+            buffers->position[ (size_t) i * OBS_POSITION_SIZE ] = (int8_t) observation->x;
+            buffers->position[ (size_t) i * OBS_POSITION_SIZE + 1 ] = (int8_t) observation->y;
+        }
+
+        if( buffers->heights != NULL )
+        {
+            // Row 0 is the top, so a column's height follows from its lowest set bit.
+            uint8_t* heights = buffers->heights + (size_t) i * OBS_HEIGHTS_SIZE;
+            for( int x = 0; x < BOARD_WIDTH; x++ )
+            {
+                const uint32_t col = observation->board[ x ];
+                heights[ x ] = col != 0 ? (uint8_t) ( BOARD_HEIGHT - SDL_MostSignificantBitIndex32( col & ( ~col + 1 ) ) ) : 0;
+            }
+        }
+    }
+}
+
+/*
+ * Encode count observations into buffers using the widest kernel the CPU supports.
+ * Results are identical to obsEncodeScalar.
+ */
+void
+obsEncode( const EnvObservation* observations, int count, const ObsBuffers* buffers )
+{
+    if( buffers->board_bits != NULL || buffers->board != NULL )
+    {
+        OBS_KERNELS[ selectObsKernel() ].func( observations, count, buffers->board_bits, buffers->board );
+    }
+    encodePieces( observations, count, buffers );
+}
+
+/*
+ * Encode count observations one cell at a time. This is the reference the SIMD kernels
+ * are verified against.
+ */
+void
+obsEncodeScalar( const EnvObservation* observations, int count, const ObsBuffers* buffers )
+{
+    if( buffers->board_bits != NULL || buffers->board != NULL )
+    {
+        encodeBoardsScalar( observations, count, buffers->board_bits, buffers->board );
+    }
+    encodePieces( observations, count, buffers );
+}
+
+/*
+ * Make obsEncode use the kernel called name ("scalar", "sse2" or "avx2"), or the widest
+ * one the CPU supports again when name is NULL. Returns false, and keeps the current
+ * kernel, when there is no such kernel or the CPU cannot run it.
+ */
+bool
+obsEncodeSetKernel( const char* name )
+{
+    if( name == NULL )
+    {
+        SDL_AtomicSet( &ObsKernel, 0 );
+        return true;
+    }
+
+    const int count = (int) SDL_arraysize( OBS_KERNELS );
+    for( int kernel = 0; kernel < count && kernel <= widestObsKernel(); kernel++ )
+    {
+        if( SDL_strcmp( OBS_KERNELS[ kernel ].name, name ) == 0 )
+        {
+            SDL_AtomicSet( &ObsKernel, kernel + 1 );
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Name of the kernel obsEncode dispatches to.
+ */
+const char*
+obsEncodeKernelName()
+{
+    return OBS_KERNELS[ selectObsKernel() ].name;
+}
@@ -0,0 +1,60 @@
+#ifndef OBS_ENCODER_H
+#define OBS_ENCODER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+
+/**************************************************************************
+** Observation encoder. Turns a batch of EnvObservations (see env_shm.h)
+** into the tensors a network trains on. Every output is batch-major and
+** contiguous: the tensor of game i starts at i times its size per game.
+** Outputs whose pointer is NULL are skipped.
+**
+** The board is unpacked with SIMD when the CPU supports it, the results
+** are identical to the scalar path, tetris_selftest checks that.
+**************************************************************************/
+
+#define OBS_SHAPE_COUNT     7
+#define OBS_ROT_COUNT       4
+
+#define OBS_BOARD_BITS_SIZE ( BOARD_HEIGHT )                    /**< uint16_t per game */
+#define OBS_BOARD_SIZE      ( BOARD_HEIGHT * BOARD_WIDTH )      /**< uint8_t per game */
+#define OBS_PIECE_SIZE      ( OBS_SHAPE_COUNT + OBS_ROT_COUNT )
+#define OBS_NEXT_SIZE       ( PIECE_QUEUE_SIZE * OBS_SHAPE_COUNT )
+#define OBS_POSITION_SIZE   2
+#define OBS_HEIGHTS_SIZE    ( BOARD_WIDTH )
+
+_Static_assert( BOARD_WIDTH <= 16, "Board rows are encoded in 16 bits" );
+
+typedef struct EnvObservation EnvObservation;
+
+typedef struct ObsBuffers
+{
+    uint16_t*   board_bits;     /**< [ BOARD_HEIGHT ] rows, bit x of row y is cell (x, y), row 0 on top */
+    uint8_t*    board;          /**< [ BOARD_HEIGHT ][ BOARD_WIDTH ] cells, 1 when filled */
+    uint8_t*    piece;          /**< One-hot active shape [ 7 ] followed by one-hot rotation [ 4 ] */
+    uint8_t*    next_pieces;    /**< [ PIECE_QUEUE_SIZE ][ 7 ] one-hot upcoming shapes, next one first */
+    int8_t*     position;       /**< x and y of the active shape's pivot point, y is -1 at spawn */
+    uint8_t*    heights;        /**< [ BOARD_WIDTH ] filled height of every column */
+} ObsBuffers;
+
+ObsBuffers
+obsBuffersAt( const ObsBuffers* buffers, int index );
+
+void
+obsFromGame( const GameState* game_state, EnvObservation* observation );
+
+void
+obsEncode( const EnvObservation* observations, int count, const ObsBuffers* buffers );
+
+void
+obsEncodeScalar( const EnvObservation* observations, int count, const ObsBuffers* buffers );
+
+bool
+obsEncodeSetKernel( const char* name );
+
+const char*
+obsEncodeKernelName();
+
+#endif //OBS_ENCODER_H
@@ -0,0 +1,470 @@
+#include "recorder.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**************************************************************************
+** Config
+**************************************************************************/
+#define RECORDER_SLOTS          8       /**< Frames buffered between the game and the writer */
+#define RLE_VERSION             1
+
+/**************************************************************************
+** Structs
+**************************************************************************/
+
+typedef enum RecorderFormat
+{
+    RECORDER_Y4M,
+    RECORDER_RLE
+} RecorderFormat;
+
+/**************************************************************************
+** Global variables
+**************************************************************************/
+bool RecorderEnabled = false;
+
+/**
+ * Single-producer/single-consumer ring of frames. The game thread only writes Head,
+ * the writer thread only writes Tail.
+ */
+static Uint32*          Slots[ RECORDER_SLOTS ];
+static const Uint32*    Frames[ RECORDER_SLOTS ];   /**< Pixels of each captured frame, a slot or a mapped frame */
+static SDL_atomic_t     Head;
+static SDL_atomic_t     Tail;
+static SDL_sem*         Ready;              /**< Posted for every captured frame */
+static SDL_atomic_t     WriterQuit;
+static SDL_Thread*      Writer;
+
+static FILE*            File;
+static const char*      FilePath;
+static RecorderFormat   Format;
+static int              Width;
+static int              Height;
+static Uint32           CaptureFormat;      /**< ARGB8888 or RGB888, whichever needs no conversion */
+static SDL_Window*      Window;
+static bool             ReadBack;           /**< Presented frames cannot be mapped, read the back buffer */
+static bool             DoubleBuffered;     /**< A mapped frame stays intact while the next one renders */
+static int              MappedSeq = -1;     /**< Ring position of the frame the writer reads mapped, or -1 */
+static Uint32           LastFrame;          /**< Number of the last presented frame captured */
+static Uint8*           Encoded;            /**< Writer's buffer for one encoded frame */
+static int              Dropped;            /**< Game thread only */
+static int              Written;            /**< Writer thread only */
+static bool             WriteFailed;        /**< Writer thread only */
+
+/**************************************************************************
+** Encoding
+**************************************************************************/
+
+static void
+writeU32( Uint32 value )
+{
+    value = SDL_SwapLE32( value );
+    fwrite( &value, sizeof( value ), 1, File );
+}
+
+static void
+writeHeader( int fps )
+{
+    if( Format == RECORDER_Y4M )
+    {
+        fprintf( File, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", Width, Height, fps );
+        return;
+    }
+    fwrite( "TRLE", 1, 4, File );
+    writeU32( RLE_VERSION );
+    writeU32( (Uint32) Width );
+    writeU32( (Uint32) Height );
+    writeU32( (Uint32) fps );
+}
+
+// BT.601 limited range, chroma averaged over 2x2 blocks.
+static size_t
+encodeY4M( const Uint32* pixels )
+{
+    const int chroma_w = ( Width + 1 ) / 2;
+    const int chroma_h = ( Height + 1 ) / 2;
+    Uint8* y_plane = Encoded;
+    Uint8* u_plane = y_plane + Width * Height;
+    Uint8* v_plane = u_plane + chroma_w * chroma_h;
+
+    for( int i = 0; i < Width * Height; i++ )
+    {
+        const int r = ( pixels[ i ] >> 16 ) & 0xFF;
+        const int g = ( pixels[ i ] >> 8 ) & 0xFF;
+        const int b = pixels[ i ] & 0xFF;
+        y_plane[ i ] = (Uint8) ( 16 + ( ( 66 * r + 129 * g + 25 * b + 128 ) >> 8 ) );
+    }
+
+    for( int cy = 0; cy < chroma_h; cy++ )
+    {
+        const Uint32* row0 = pixels + 2 * cy * Width;
+        const Uint32* row1 = ( 2 * cy + 1 < Height ) ? row0 + Width : row0;
+        for( int cx = 0; cx < chroma_w; cx++ )
+        {
+            const int x0 = 2 * cx;
+            const int x1 = ( x0 + 1 < Width ) ? x0 + 1 : x0;
+            const Uint32 quad[ 4 ] = { row0[ x0 ], row0[ x1 ], row1[ x0 ], row1[ x1 ] };
+            int r = 0, g = 0, b = 0;
+            for( int q = 0; q < 4; q++ )
+            {
+                r += ( quad[ q ] >> 16 ) & 0xFF;
+                g += ( quad[ q ] >> 8 ) & 0xFF;
+                b += quad[ q ] & 0xFF;
+            }
+            r = ( r + 2 ) / 4;
+            g = ( g + 2 ) / 4;
+            b = ( b + 2 ) / 4;
+            u_plane[ cy * chroma_w + cx ] = (Uint8) ( 128 + ( ( -38 * r - 74 * g + 112 * b + 128 ) >> 8 ) );
+            v_plane[ cy * chroma_w + cx ] = (Uint8) ( 128 + ( ( 112 * r - 94 * g - 18 * b + 128 ) >> 8 ) );
+        }
+    }
+
+    return (size_t) Width * Height + 2 * (size_t) chroma_w * chroma_h;
+}
+
+static size_t
+encodeRLE( const Uint32* pixels )
+{
+    Uint32* out = (Uint32*) Encoded;
+    const int count = Width * Height;
+    Uint32 runs = 0;
+
+    for( int i = 0; i < count; )
+    {
+        // RGB888 leaves the alpha byte undefined.
+        const Uint32 pixel = pixels[ i ] | 0xFF000000;
+        int end = i + 1;
+        while( end < count && ( pixels[ end ] | 0xFF000000 ) == pixel )
+        {
+            end++;
+        }
+        out[ 1 + 2 * runs ] = SDL_SwapLE32( (Uint32) ( end - i ) );
+        out[ 2 + 2 * runs ] = SDL_SwapLE32( pixel );
+        runs++;
+        i = end;
+    }
+    out[ 0 ] = SDL_SwapLE32( runs );
+
+    return ( 1 + 2 * (size_t) runs ) * sizeof( Uint32 );
+}
+
+static void
+writeFrame( const Uint32* pixels )
+{
+    size_t size;
+    if( Format == RECORDER_Y4M )
+    {
+        fputs( "FRAME\n", File );
+        size = encodeY4M( pixels );
+    } else
+    {
+        size = encodeRLE( pixels );
+    }
+
+    if( fwrite( Encoded, 1, size, File ) != size )
+    {
+        WriteFailed = true;
+    }
+    Written++;
+}
+
+static int
+writerThread( void* data )
+{
+    (void) data;
+
+    // Encoding must not take the CPU from the game when it wakes up the writer.
+    SDL_SetThreadPriority( SDL_THREAD_PRIORITY_LOW );
+
+    for( ;; )
+    {
+        SDL_SemWait( Ready );
+
+        // Read the flag first, every frame captured before it was set is then in Head.
+        const bool quit = SDL_AtomicGet( &WriterQuit );
+        const int head = SDL_AtomicGet( &Head );
+        int tail = SDL_AtomicGet( &Tail );
+        SDL_MemoryBarrierAcquire();
+
+        for( ; tail != head; tail++ )
+        {
+            writeFrame( Frames[ tail % RECORDER_SLOTS ] );
+            SDL_MemoryBarrierRelease();
+            SDL_AtomicSet( &Tail, tail + 1 );
+        }
+
+        if( quit )
+        {
+            return 0;
+        }
+    }
+}
+
+/**************************************************************************
+** Public
+**************************************************************************/
+
+static void
+freeBuffers()
+{
+    for( int i = 0; i < RECORDER_SLOTS; i++ )
+    {
+        SDL_free( Slots[ i ] );
+        Slots[ i ] = NULL;
+    }
+    SDL_free( Encoded );
+    Encoded = NULL;
+}
+
+/*
+ * Start recording what renderer draws to path at fps frames per second. Returns false
+ * when the file or the buffers cannot be created.
+ */
+bool
+recorderStart( SDL_Renderer* renderer, const char* path, int fps )
+{
+    if( RecorderEnabled )
+    {
+        return true;
+    }
+
+    if( SDL_GetRendererOutputSize( renderer, &Width, &Height ) < 0 )
+    {
+        printf( "Could not get the renderer size. SDL_Error: %s\n", SDL_GetError() );
+        return false;
+    }
+
+    // Reading back in the window's own format is a plain copy.
+    Window = SDL_RenderGetWindow( renderer );
+    CaptureFormat = SDL_GetWindowPixelFormat( Window );
+    if( CaptureFormat != SDL_PIXELFORMAT_RGB888 )
+    {
+        CaptureFormat = SDL_PIXELFORMAT_ARGB8888;
+    }
+
+    // Presented frames are mapped when the window shows exactly what the renderer draws,
+    // recorderCapture falls back to reading back the first time mapping fails.
+    int window_w, window_h;
+    SDL_GetWindowSizeInPixels( Window, &window_w, &window_h );
+    ReadBack = window_w != Width || window_h != Height;
+    DoubleBuffered = SDL_GetHintBoolean( SDL_HINT_VIDEO_OFFSCREEN_DOUBLE_BUFFER, SDL_FALSE );
+    MappedSeq = -1;
+    LastFrame = 0;
+
+    const size_t length = strlen( path );
+    Format = ( length >= 4 && SDL_strcasecmp( path + length - 4, ".y4m" ) == 0 ) ? RECORDER_Y4M : RECORDER_RLE;
+
+    // Worst case RLE is one run per pixel.
+    const size_t pixels = (size_t) Width * Height;
+    const size_t encoded_size = ( Format == RECORDER_Y4M ) ? 2 * pixels : ( 1 + 2 * pixels ) * sizeof( Uint32 );
+    Encoded = SDL_malloc( encoded_size );
+    bool allocated = Encoded != NULL;
+    for( int i = 0; i < RECORDER_SLOTS; i++ )
+    {
+        Slots[ i ] = SDL_malloc( pixels * sizeof( Uint32 ) );
+        allocated = allocated && Slots[ i ] != NULL;
+        if( Slots[ i ] != NULL )
+        {
+            // Touch the pages now rather than page faulting in the first captures.
+            SDL_memset( Slots[ i ], 0, pixels * sizeof( Uint32 ) );
+        }
+    }
+    if( !allocated )
+    {
+        printf( "Could not allocate the recording buffers\n" );
+        freeBuffers();
+        return false;
+    }
+
+    File = fopen( path, "wb" );
+    if( File == NULL )
+    {
+        printf( "Could not open recording file %s\n", path );
+        freeBuffers();
+        return false;
+    }
+    FilePath = path;
+
+    writeHeader( fps );
+
+    SDL_AtomicSet( &Head, 0 );
+    SDL_AtomicSet( &Tail, 0 );
+    SDL_AtomicSet( &WriterQuit, 0 );
+    Dropped = 0;
+    Written = 0;
+    WriteFailed = false;
+
+    Ready = SDL_CreateSemaphore( 0 );
+    Writer = Ready != NULL ? SDL_CreateThread( writerThread, "recorder", NULL ) : NULL;
+    if( Writer == NULL )
+    {
+        // Without a writer every frame would be dropped, leave no empty recording behind.
+        printf( "Could not start the recording writer. SDL_Error: %s\n", SDL_GetError() );
+        SDL_DestroySemaphore( Ready );
+        Ready = NULL;
+        fclose( File );
+        File = NULL;
+        remove( path );
+        freeBuffers();
+        return false;
+    }
+    RecorderEnabled = true;
+    return true;
+}
+
+// Hand the frame in Slots[ head ] or mapped at head to the writer.
+static void
+publishFrame( int head, const Uint32* pixels )
+{
+    Frames[ head % RECORDER_SLOTS ] = pixels;
+
+    // Publish the frame only after it is fully written.
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet( &Head, head + 1 );
+    SDL_SemPost( Ready );
+}
+
+// Give the mapped frame back to the video driver once the writer has encoded it.
+static void
+releaseMapped()
+{
+    if( MappedSeq < 0 || SDL_AtomicGet( &Tail ) <= MappedSeq )
+    {
+        return;
+    }
+    SDL_UnlockPresentedFrame( Window );
+    MappedSeq = -1;
+}
+
+/*
+ * Call right before SDL_RenderPresent. Releases the presented frame the writer is done
+ * with, so the present can replace it. Where presented frames cannot be mapped, reads
+ * the back buffer back instead, it is undefined after the present.
+ */
+void
+recorderBeforePresent( SDL_Renderer* renderer )
+{
+    releaseMapped();
+    if( !ReadBack )
+    {
+        return;
+    }
+
+    const int head = SDL_AtomicGet( &Head );
+    if( head - SDL_AtomicGet( &Tail ) >= RECORDER_SLOTS )
+    {
+        Dropped++;
+        return;
+    }
+
+    const SDL_Rect rect = { 0, 0, Width, Height };
+    Uint32* slot = Slots[ head % RECORDER_SLOTS ];
+    if( SDL_RenderReadPixels( renderer, &rect, CaptureFormat, slot, Width * (int) sizeof( Uint32 ) ) < 0 )
+    {
+        Dropped++;
+        return;
+    }
+    publishFrame( head, slot );
+}
+
+/*
+ * Call right after SDL_RenderPresent. Maps the frame just presented (see
+ * SDL_LockPresentedFrame). Double buffered, the writer encodes it in place while the
+ * next frame renders and a frame presented before it is done is dropped. Otherwise the
+ * next frame renders into the same pixels and they are copied to the ring first.
+ */
+void
+recorderCapture()
+{
+    if( ReadBack )
+    {
+        return;
+    }
+
+    const int head = SDL_AtomicGet( &Head );
+    if( MappedSeq >= 0 || head - SDL_AtomicGet( &Tail ) >= RECORDER_SLOTS )
+    {
+        Dropped++;
+        return;
+    }
+
+    const void* pixels;
+    int pitch;
+    Uint32 format;
+    Uint32 frame;
+    if( SDL_LockPresentedFrame( Window, &pixels, &pitch, &format, &frame ) < 0 )
+    {
+        // A frame was just presented, so the video driver cannot map any.
+        ReadBack = true;
+        Dropped++;
+        return;
+    }
+    if( frame == LastFrame )
+    {
+        SDL_UnlockPresentedFrame( Window );
+        Dropped++;
+        return;
+    }
+    LastFrame = frame;
+
+    // The encoders read 32-bit pixels in rows of Width and ignore the alpha byte.
+    const bool encodable = ( format == SDL_PIXELFORMAT_RGB888 || format == SDL_PIXELFORMAT_ARGB8888 )
+                           && pitch == Width * (int) sizeof( Uint32 );
+    if( DoubleBuffered && encodable )
+    {
+        MappedSeq = head;
+        publishFrame( head, pixels );
+        return;
+    }
+
+    Uint32* slot = Slots[ head % RECORDER_SLOTS ];
+    const int converted = SDL_ConvertPixels( Width, Height, format, pixels, pitch,
+                                             CaptureFormat, slot, Width * (int) sizeof( Uint32 ) );
+    SDL_UnlockPresentedFrame( Window );
+    if( converted < 0 )
+    {
+        Dropped++;
+        return;
+    }
+    publishFrame( head, slot );
+}
+
+/*
+ * Stop recording, wait for the writer to finish the buffered frames and close the file.
+ */
+void
+recorderStop()
+{
+    if( !RecorderEnabled )
+    {
+        return;
+    }
+    RecorderEnabled = false;
+
+    SDL_AtomicSet( &WriterQuit, 1 );
+    SDL_SemPost( Ready );
+    SDL_WaitThread( Writer, NULL );
+    SDL_DestroySemaphore( Ready );
+
+    // The writer has encoded every frame, including a mapped one.
+    releaseMapped();
+
+    if( fclose( File ) != 0 )
+    {
+        WriteFailed = true;
+    }
+    File = NULL;
+    freeBuffers();
+
+    printf( "Recorded %d frames to %s", Written, FilePath );
+    if( Dropped > 0 )
+    {
+        printf( ", dropped %d", Dropped );
+    }
+    printf( "\n" );
+    if( WriteFailed )
+    {
+        printf( "Writing %s failed, the recording is incomplete\n", FilePath );
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdbool.h>
+#include <SDL.h>
+
+/**************************************************************************
+** Gameplay video recorder. Each presented frame is handed to a background
+** thread that encodes and writes it, so the render loop never waits on the
+** disk. With the offscreen video driver and a software renderer the frame
+** is mapped with SDL_LockPresentedFrame, and with
+** SDL_HINT_VIDEO_OFFSCREEN_DOUBLE_BUFFER it is encoded in place. Otherwise
+** it is copied or read back into a ring of reusable buffers. When the
+** writer falls behind, frames are dropped instead.
+**
+** The format follows the file name:
+**  - ".y4m": uncompressed YUV4MPEG2 4:2:0, plays in ffplay/mpv and
+**    converts with ffmpeg.
+**  - anything else: lossless RLE, see below.
+**
+** RLE file layout, all integers are little-endian Uint32:
+**  header: "TRLE", version (1), width, height, frames per second
+**  frame:  run count, then per run a pixel count and an ARGB8888 pixel.
+**          Runs follow each other in row order and may span rows.
+**************************************************************************/
+
+extern bool RecorderEnabled;
+
+bool
+recorderStart( SDL_Renderer* renderer, const char* path, int fps );
+
+void
+recorderBeforePresent( SDL_Renderer* renderer );
+
+void
+recorderCapture();
+
+void
+recorderStop();
+
+#endif //RECORDER_H
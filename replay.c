@@ -0,0 +1,555 @@
+#include "replay.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <SDL.h>
+
+/**************************************************************************
+** Config
+**************************************************************************/
+#define REPLAY_HEADER_SIZE      4096    /**< The header gets a page of its own */
+#define REPLAY_ALIGN            64
+#define REPLAY_SAMPLE_TRIES     16      /**< Attempts per sample before giving up on it */
+#define REPLAY_FIRST_PRIORITY   1.0f
+
+/**************************************************************************
+** Helpers
+**************************************************************************/
+
+static uint64_t
+alignUp( uint64_t size )
+{
+    return ( size + REPLAY_ALIGN - 1 ) & ~(uint64_t) ( REPLAY_ALIGN - 1 );
+}
+
+static uint64_t
+stateOf( uint32_t lap, uint32_t finished )
+{
+    return (uint64_t) lap << 32 | finished;
+}
+
+// xorshift64*, the caller owns the state so every sampling thread can have its own.
+static uint64_t
+nextRandom( uint64_t* rng )
+{
+    uint64_t x = *rng != 0 ? *rng : 0x9E3779B97F4A7C15ull;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *rng = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+static double
+randomUnit( uint64_t* rng )
+{
+    return (double) ( nextRandom( rng ) >> 11 ) / (double) ( 1ull << 53 );
+}
+
+static void
+atomicAddDouble( _Atomic double* value, double delta )
+{
+    double old = atomic_load_explicit( value, memory_order_relaxed );
+    while( !atomic_compare_exchange_weak( value, &old, old + delta ) )
+    {
+    }
+}
+
+static void
+raiseMaxPriority( ReplayBuffer* buffer, float priority )
+{
+    float old = atomic_load_explicit( &buffer->header->max_priority, memory_order_relaxed );
+    while( priority > old && !atomic_compare_exchange_weak( &buffer->header->max_priority, &old, priority ) )
+    {
+    }
+}
+
+// Add delta to a block's leaf and every node above it.
+static void
+addToTree( ReplayBuffer* buffer, uint64_t block, double delta )
+{
+    for( uint64_t node = buffer->header->tree_leaves + block; node >= 1; node >>= 1 )
+    {
+        atomicAddDouble( &buffer->tree[ node ], delta );
+    }
+}
+
+static bool
+mapFile( ReplayBuffer* buffer, int fd, uint64_t size )
+{
+    void* base = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    if( base == MAP_FAILED )
+    {
+        return false;
+    }
+
+    ReplayHeader* header = base;
+    buffer->header = header;
+    buffer->blocks = header->capacity / header->block_size;
+    buffer->states = (_Atomic uint64_t*) ( (uint8_t*) base + header->states_offset );
+    buffer->transitions = (ReplayTransition*) ( (uint8_t*) base + header->transitions_offset );
+    buffer->priorities = NULL;
+    buffer->tree = NULL;
+    if( header->tree_leaves > 0 )
+    {
+        buffer->priorities = (_Atomic float*) ( (uint8_t*) base + header->priorities_offset );
+        buffer->tree = (_Atomic double*) ( (uint8_t*) base + header->tree_offset );
+    }
+
+    // Sampling reads scattered transitions, read-ahead would only evict useful pages.
+    madvise( buffer->transitions, header->capacity * sizeof( ReplayTransition ), MADV_RANDOM );
+    return true;
+}
+
+/**************************************************************************
+** Buffer
+**************************************************************************/
+
+static bool
+createFile( const char* path, uint64_t capacity, bool prioritized, int* fd_out, uint64_t* size_out )
+{
+    ReplayHeader layout;
+    memset( &layout, 0, sizeof( layout ) );
+    layout.magic = REPLAY_MAGIC;
+    layout.version = REPLAY_VERSION;
+    layout.transition_size = sizeof( ReplayTransition );
+    layout.block_size = REPLAY_BLOCK_SIZE;
+    layout.board_width = BOARD_WIDTH;
+    layout.board_height = BOARD_HEIGHT;
+    layout.capacity = ( capacity + REPLAY_BLOCK_SIZE - 1 ) / REPLAY_BLOCK_SIZE * REPLAY_BLOCK_SIZE;
+
+    const uint64_t blocks = layout.capacity / REPLAY_BLOCK_SIZE;
+    uint64_t offset = REPLAY_HEADER_SIZE;
+    layout.states_offset = offset;
+    offset = alignUp( offset + blocks * sizeof( uint64_t ) );
+    layout.transitions_offset = offset;
+    offset = alignUp( offset + layout.capacity * sizeof( ReplayTransition ) );
+    if( prioritized )
+    {
+        layout.tree_leaves = 1;
+        while( layout.tree_leaves < blocks )
+        {
+            layout.tree_leaves <<= 1;
+        }
+        layout.priorities_offset = offset;
+        offset = alignUp( offset + layout.capacity * sizeof( float ) );
+        layout.tree_offset = offset;
+        offset = alignUp( offset + 2 * layout.tree_leaves * sizeof( double ) );
+    }
+    layout.size = offset;
+    atomic_init( &layout.head, 0 );
+    atomic_init( &layout.max_priority, REPLAY_FIRST_PRIORITY );
+
+    // The file is sparse, disk space is only used as transitions are written.
+    const int fd = open( path, O_RDWR | O_CREAT | O_EXCL, 0644 );
+    if( fd < 0 )
+    {
+        printf( "Could not create replay buffer %s: %s\n", path, strerror( errno ) );
+        return false;
+    }
+    if( ftruncate( fd, (off_t) layout.size ) < 0 ||
+        pwrite( fd, &layout, sizeof( layout ), 0 ) != sizeof( layout ) )
+    {
+        printf( "Could not size replay buffer %s: %s\n", path, strerror( errno ) );
+        close( fd );
+        unlink( path );
+        return false;
+    }
+
+    *fd_out = fd;
+    *size_out = layout.size;
+    return true;
+}
+
+/*
+ * Open the replay buffer in path, or create it with room for capacity transitions when
+ * the file does not exist. An existing file keeps its transitions; capacity 0 accepts any
+ * size, otherwise it and prioritized must match how the file was made. Returns NULL on
+ * failure.
+ */
+ReplayBuffer*
+replayOpen( const char* path, uint64_t capacity, bool prioritized )
+{
+    int fd = open( path, O_RDWR );
+    uint64_t size = 0;
+
+    if( fd >= 0 )
+    {
+        ReplayHeader header;
+        const uint64_t rounded = ( capacity + REPLAY_BLOCK_SIZE - 1 ) / REPLAY_BLOCK_SIZE * REPLAY_BLOCK_SIZE;
+        struct stat st;
+        if( pread( fd, &header, sizeof( header ), 0 ) != sizeof( header ) ||
+            fstat( fd, &st ) < 0 ||
+            header.magic != REPLAY_MAGIC ||
+            header.version != REPLAY_VERSION ||
+            header.transition_size != sizeof( ReplayTransition ) ||
+            header.block_size != REPLAY_BLOCK_SIZE ||
+            header.board_width != BOARD_WIDTH ||
+            header.board_height != BOARD_HEIGHT ||
+            (uint64_t) st.st_size < header.size )
+        {
+            printf( "%s is not a replay buffer of this version\n", path );
+            close( fd );
+            return NULL;
+        }
+        if( capacity != 0 && ( header.capacity != rounded || ( header.tree_leaves > 0 ) != prioritized ) )
+        {
+            printf( "Replay buffer %s holds %llu transitions%s, not the requested size\n",
+                    path, (unsigned long long) header.capacity, header.tree_leaves > 0 ? " with priorities" : "" );
+            close( fd );
+            return NULL;
+        }
+        size = header.size;
+    } else if( errno != ENOENT || capacity == 0 || !createFile( path, capacity, prioritized, &fd, &size ) )
+    {
+        if( capacity == 0 )
+        {
+            printf( "Could not open replay buffer %s: %s\n", path, strerror( errno ) );
+        }
+        return NULL;
+    }
+
+    ReplayBuffer* buffer = SDL_calloc( 1, sizeof( ReplayBuffer ) );
+    if( buffer == NULL || !mapFile( buffer, fd, size ) )
+    {
+        printf( "Could not map replay buffer %s: %s\n", path, strerror( errno ) );
+        SDL_free( buffer );
+        close( fd );
+        return NULL;
+    }
+    close( fd );
+    return buffer;
+}
+
+void
+replayClose( ReplayBuffer* buffer )
+{
+    if( buffer == NULL )
+    {
+        return;
+    }
+    munmap( buffer->header, buffer->header->size );
+    SDL_free( buffer );
+}
+
+/*
+ * Write the changed pages to the file now instead of whenever the kernel gets to it.
+ * A process that crashes loses nothing either way, this is for power loss.
+ */
+void
+replayFlush( ReplayBuffer* buffer )
+{
+    msync( buffer->header, buffer->header->size, MS_SYNC );
+}
+
+/*
+ * Number of slots that have been written at least once.
+ */
+uint64_t
+replaySize( const ReplayBuffer* buffer )
+{
+    const uint64_t head = atomic_load( &buffer->header->head );
+    return head < buffer->header->capacity ? head : buffer->header->capacity;
+}
+
+/**************************************************************************
+** Appending
+**************************************************************************/
+
+// Make lap the owner of block. The first writer of a lap resets the finished count,
+// which also stops samplers from reading the block until it is full again. Returns false
+// when a later lap already owns it, the buffer wrapped around during this append.
+static bool
+claimBlock( ReplayBuffer* buffer, uint64_t block, uint32_t lap )
+{
+    uint64_t state = atomic_load( &buffer->states[ block ] );
+    for( ;; )
+    {
+        const uint32_t owner = (uint32_t) ( state >> 32 );
+        if( owner == lap )
+        {
+            return true;
+        }
+        if( (int32_t) ( owner - lap ) > 0 )
+        {
+            return false;
+        }
+        if( atomic_compare_exchange_weak( &buffer->states[ block ], &state, stateOf( lap, 0 ) ) )
+        {
+            return true;
+        }
+    }
+}
+
+static void
+finishBlock( ReplayBuffer* buffer, uint64_t block, uint32_t lap, uint32_t count )
+{
+    uint64_t state = atomic_load( &buffer->states[ block ] );
+    while( (uint32_t) ( state >> 32 ) == lap &&
+           !atomic_compare_exchange_weak_explicit( &buffer->states[ block ], &state, state + count,
+                                                   memory_order_release, memory_order_relaxed ) )
+    {
+    }
+}
+
+/*
+ * Append count transitions (at most the capacity). New transitions get the highest
+ * priority given so far, so each is sampled at least once with a fair chance. Returns
+ * the index of the first one, index % capacity is its slot.
+ */
+uint64_t
+replayAppend( ReplayBuffer* buffer, const ReplayTransition* transitions, int count )
+{
+    const uint64_t capacity = buffer->header->capacity;
+    const uint64_t start = atomic_fetch_add( &buffer->header->head, (uint64_t) count );
+    const float priority = buffer->priorities != NULL
+                         ? atomic_load_explicit( &buffer->header->max_priority, memory_order_relaxed ) : 0;
+
+    // Work a block at a time, so the state words and the tree are touched once per block.
+    for( int i = 0; i < count; )
+    {
+        const uint64_t index = start + (uint64_t) i;
+        const uint64_t slot = index % capacity;
+        const uint64_t block = slot / REPLAY_BLOCK_SIZE;
+        const uint32_t lap = (uint32_t) ( index / capacity );
+        int run = REPLAY_BLOCK_SIZE - (int) ( slot % REPLAY_BLOCK_SIZE );
+        if( run > count - i )
+        {
+            run = count - i;
+        }
+
+        if( claimBlock( buffer, block, lap ) )
+        {
+            // Order the claim before the writes: a sampler that copies one of these slots
+            // then sees the state word change and throws its copy away.
+            atomic_thread_fence( memory_order_release );
+            memcpy( &buffer->transitions[ slot ], &transitions[ i ], sizeof( ReplayTransition ) * run );
+
+            if( buffer->priorities != NULL )
+            {
+                double delta = 0;
+                for( int r = 0; r < run; r++ )
+                {
+                    delta += priority - atomic_exchange_explicit( &buffer->priorities[ slot + r ], priority,
+                                                                  memory_order_relaxed );
+                }
+                addToTree( buffer, block, delta );
+            }
+
+            finishBlock( buffer, block, lap, (uint32_t) run );
+        }
+        i += run;
+    }
+
+    return start;
+}
+
+/**************************************************************************
+** Sampling
+**************************************************************************/
+
+// Copy the transition in slot if its block is finished and stays untouched while copying.
+static bool
+readSlot( const ReplayBuffer* buffer, uint64_t slot, ReplayTransition* out )
+{
+    const uint64_t block = slot / REPLAY_BLOCK_SIZE;
+    const uint64_t before = atomic_load_explicit( &buffer->states[ block ], memory_order_acquire );
+    if( (uint32_t) before != REPLAY_BLOCK_SIZE )
+    {
+        return false;
+    }
+
+    memcpy( out, &buffer->transitions[ slot ], sizeof( ReplayTransition ) );
+    atomic_thread_fence( memory_order_acquire );
+    return atomic_load_explicit( &buffer->states[ block ], memory_order_relaxed ) == before;
+}
+
+/*
+ * Sample count transitions uniformly, with replacement. rng is the caller's random state
+ * (any value to start). Returns how many were sampled, fewer than count only when
+ * the buffer holds (almost) no finished blocks.
+ */
+int
+replaySampleUniform( const ReplayBuffer* buffer, uint64_t* rng, int count,
+                     ReplayTransition* out, uint64_t* indices )
+{
+    const uint64_t size = replaySize( buffer );
+    int sampled = 0;
+    if( size == 0 )
+    {
+        return 0;
+    }
+
+    for( int tries = 0; sampled < count && tries < count * REPLAY_SAMPLE_TRIES; tries++ )
+    {
+        const uint64_t slot = nextRandom( rng ) % size;
+        if( readSlot( buffer, slot, &out[ sampled ] ) )
+        {
+            if( indices != NULL )
+            {
+                indices[ sampled ] = slot;
+            }
+            sampled++;
+        }
+    }
+    return sampled;
+}
+
+/*
+ * Sample count transitions with a chance proportional to their priority, with
+ * replacement. probabilities gets the chance of each, for importance sampling weights.
+ * Returns how many were sampled, 0 for a buffer without priorities.
+ */
+int
+replaySamplePrioritized( const ReplayBuffer* buffer, uint64_t* rng, int count,
+                         ReplayTransition* out, uint64_t* indices, float* probabilities )
+{
+    const uint64_t leaves = buffer->header->tree_leaves;
+    int sampled = 0;
+    if( buffer->priorities == NULL )
+    {
+        return 0;
+    }
+
+    for( int tries = 0; sampled < count && tries < count * REPLAY_SAMPLE_TRIES; tries++ )
+    {
+        const double total = atomic_load_explicit( &buffer->tree[ 1 ], memory_order_relaxed );
+        if( total <= 0 )
+        {
+            break;
+        }
+
+        // Walk down the tree to the block that holds the target prefix sum.
+        double target = randomUnit( rng ) * total;
+        uint64_t node = 1;
+        while( node < leaves )
+        {
+            const double left = atomic_load_explicit( &buffer->tree[ 2 * node ], memory_order_relaxed );
+            if( target < left )
+            {
+                node = 2 * node;
+            } else
+            {
+                target -= left;
+                node = 2 * node + 1;
+            }
+        }
+        const uint64_t block = node - leaves;
+        if( block >= buffer->blocks )
+        {
+            continue;
+        }
+
+        // Then along the block's priorities. Concurrent updates can leave the target past
+        // the end, the last slot with a priority takes it then.
+        uint64_t slot = block * REPLAY_BLOCK_SIZE;
+        float priority = 0;
+        for( int r = 0; r < REPLAY_BLOCK_SIZE; r++ )
+        {
+            const float p = atomic_load_explicit( &buffer->priorities[ block * REPLAY_BLOCK_SIZE + r ],
+                                                  memory_order_relaxed );
+            if( p > 0 )
+            {
+                slot = block * REPLAY_BLOCK_SIZE + r;
+                priority = p;
+                if( target < p )
+                {
+                    break;
+                }
+                target -= p;
+            }
+        }
+
+        if( priority > 0 && readSlot( buffer, slot, &out[ sampled ] ) )
+        {
+            if( indices != NULL )
+            {
+                indices[ sampled ] = slot;
+            }
+            if( probabilities != NULL )
+            {
+                probabilities[ sampled ] = (float) ( priority / total );
+            }
+            sampled++;
+        }
+    }
+    return sampled;
+}
+
+/*
+ * Set the priorities of the transitions in slots indices, e.g. to their new TD errors
+ * (already raised to the prioritization exponent). Priorities must be positive.
+ */
+void
+replayUpdatePriorities( ReplayBuffer* buffer, const uint64_t* indices, const float* priorities, int count )
+{
+    if( buffer->priorities == NULL )
+    {
+        return;
+    }
+
+    for( int i = 0; i < count; i++ )
+    {
+        const uint64_t slot = indices[ i ] % buffer->header->capacity;
+        const float old = atomic_exchange_explicit( &buffer->priorities[ slot ], priorities[ i ], memory_order_relaxed );
+        addToTree( buffer, slot / REPLAY_BLOCK_SIZE, (double) priorities[ i ] - old );
+        raiseMaxPriority( buffer, priorities[ i ] );
+    }
+}
+
+/**************************************************************************
+** Board packing
+**************************************************************************/
+
+/*
+ * Pack BOARD_HEIGHT rows (bit x of row y is cell (x, y), as obsEncode writes them) back
+ * to back into a transition's board.
+ */
+void
+replayPackRows( const uint16_t* rows, uint8_t* board )
+{
+    uint32_t bits = 0;
+    int count = 0;
+    int out = 0;
+
+    for( int y = 0; y < BOARD_HEIGHT; y++ )
+    {
+        bits |= (uint32_t) ( rows[ y ] & ( ( 1u << BOARD_WIDTH ) - 1 ) ) << count;
+        count += BOARD_WIDTH;
+        while( count >= 8 )
+        {
+            board[ out++ ] = (uint8_t) bits;
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+    if( count > 0 )
+    {
+        board[ out ] = (uint8_t) bits;
+    }
+}
+
+void
+replayUnpackRows( const uint8_t* board, uint16_t* rows )
+{
+    uint32_t bits = 0;
+    int count = 0;
+    int in = 0;
+
+    for( int y = 0; y < BOARD_HEIGHT; y++ )
+    {
+        while( count < BOARD_WIDTH )
+        {
+            bits |= (uint32_t) board[ in++ ] << count;
+            count += 8;
+        }
+        rows[ y ] = (uint16_t) ( bits & ( ( 1u << BOARD_WIDTH ) - 1 ) );
+        bits >>= BOARD_WIDTH;
+        count -= BOARD_WIDTH;
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+/**************************************************************************
+** Experience replay buffer. A fixed number of transitions in a file that
+** is mapped into memory, so it holds far more than fits in RAM (the kernel
+** pages it in and out) and is still there after a restart.
+**
+** Any number of threads append at once without locks: an append reserves
+** its slots with one atomic add on head and the oldest transitions are
+** overwritten once the buffer is full. Slots are grouped in blocks of
+** REPLAY_BLOCK_SIZE, and each block has a state word with the lap it was
+** written in and how many of its slots are finished. Samplers only return
+** transitions from finished blocks, and check the state word again after
+** copying, so a block that is overwritten meanwhile is skipped.
+**
+** File layout: a ReplayHeader, then at the offsets in the header the block
+** states (uint64_t: lap << 32 | finished slots), the transitions and, for
+** prioritized buffers, a float priority per transition and a sum tree of
+** doubles over the blocks (node 1 is the root, block b is leaf
+** tree_leaves + b).
+**************************************************************************/
+
+/**************************************************************************
+** Config
+**************************************************************************/
+#define REPLAY_MAGIC            0x4C505254u     /**< "TRPL" */
+#define REPLAY_VERSION          1
+#define REPLAY_BLOCK_SIZE       256             /**< Slots per block, capacity is rounded up to it */
+#define REPLAY_BOARD_BYTES      ( ( BOARD_WIDTH * BOARD_HEIGHT + 7 ) / 8 )
+
+/**************************************************************************
+** Structs
+**************************************************************************/
+
+/**
+ * One transition: the state a game was in, the action taken and what it gave.
+ */
+typedef struct ReplayTransition
+{
+    uint8_t         board[ REPLAY_BOARD_BYTES ];    /**< Rows packed back to back, bit y * BOARD_WIDTH + x is cell (x, y) */
+    uint8_t         piece;              /**< Active shape * 4 + rotation */
+    int8_t          x;                  /**< Pivot point of the active shape */
+    int8_t          y;
+    uint8_t         action;             /**< EnvAction */
+    uint8_t         done;               /**< EnvDone after the action */
+    int16_t         reward;             /**< Score gained by the action */
+} ReplayTransition;
+
+_Static_assert( sizeof( ReplayTransition ) == 32, "Transitions are 32 bytes, a cache line holds two" );
+
+typedef struct ReplayHeader
+{
+    uint32_t        magic;
+    uint32_t        version;
+    uint32_t        transition_size;
+    uint32_t        block_size;
+    uint32_t        board_width;
+    uint32_t        board_height;
+    uint64_t        capacity;           /**< Transitions, a multiple of block_size */
+    uint64_t        tree_leaves;        /**< Power of 2 >= the block count, 0 without priorities */
+    uint64_t        size;               /**< Bytes in the whole file */
+    uint64_t        states_offset;
+    uint64_t        transitions_offset;
+    uint64_t        priorities_offset;
+    uint64_t        tree_offset;
+
+    _Alignas( 64 ) _Atomic uint64_t head;           /**< Transitions ever appended */
+    _Alignas( 64 ) _Atomic float    max_priority;   /**< Priority new transitions start with */
+} ReplayHeader;
+
+typedef struct ReplayBuffer
+{
+    ReplayHeader*       header;
+    _Atomic uint64_t*   states;
+    ReplayTransition*   transitions;
+    _Atomic float*      priorities;     /**< NULL without priorities */
+    _Atomic double*     tree;
+    uint64_t            blocks;
+} ReplayBuffer;
+
+/**************************************************************************
+** Buffer
+**************************************************************************/
+ReplayBuffer*   replayOpen( const char* path, uint64_t capacity, bool prioritized );
+void            replayClose( ReplayBuffer* buffer );
+void            replayFlush( ReplayBuffer* buffer );
+uint64_t        replaySize( const ReplayBuffer* buffer );
+
+/**************************************************************************
+** Thread safe, any number of threads may append and sample at once.
+**************************************************************************/
+uint64_t        replayAppend( ReplayBuffer* buffer, const ReplayTransition* transitions, int count );
+int             replaySampleUniform( const ReplayBuffer* buffer, uint64_t* rng, int count,
+                                     ReplayTransition* out, uint64_t* indices );
+int             replaySamplePrioritized( const ReplayBuffer* buffer, uint64_t* rng, int count,
+                                         ReplayTransition* out, uint64_t* indices, float* probabilities );
+void            replayUpdatePriorities( ReplayBuffer* buffer, const uint64_t* indices, const float* priorities, int count );
+
+/**************************************************************************
+** Board packing
+**************************************************************************/
+void            replayPackRows( const uint16_t* rows, uint8_t* board );
+void            replayUnpackRows( const uint8_t* board, uint16_t* rows );
+
+#endif //REPLAY_H
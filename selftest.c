@@ -0,0 +1,1003 @@
+//
+// Checks of the parts of the game that have several implementations or are shared
+// between threads, run by ctest. Every SIMD kernel the CPU supports is compared with
+// the scalar reference on random input, results must be bit-identical.
+// "tetris_selftest --bench" times SDL's fill kernels instead.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <SDL.h>
+#include "board_eval.h"
+#include "env_shm.h"
+#include "nn_eval.h"
+#include "obs_encoder.h"
+#ifdef TETRIS_SELFTEST_REPLAY
+#include <unistd.h>
+#include "replay.h"
+#endif
+
+/**************************************************************************
+** Config
+**************************************************************************/
+#define RANDOM_BOARDS           4096    /**< Boards per kernel comparison */
+#define RANDOM_OBSERVATIONS     1024    /**< Observations per kernel comparison */
+#define MAX_TAIL                ( 4 * EVAL_BATCH_AVX2 + 3 )     /**< Batch sizes up to this are all tried */
+#define COLUMN_BITS             ( ( 1u << BOARD_HEIGHT ) - 1 )  /**< Cells of one PackedBoard column */
+
+#define NETWORK_PATH            "tetris_selftest.tnn"
+#define NETWORK_LAYERS          3
+#define STRESS_PRODUCERS        4
+#define STRESS_PER_PRODUCER     200000  /**< Transitions every producer appends */
+#define STRESS_CAPACITY         ( 4 * REPLAY_BLOCK_SIZE )       /**< Small, so appends wrap around all the time */
+#define TILE_WIDTH              640
+#define TILE_HEIGHT             480
+#define TILE_THREADS            4       /**< SDL_RENDER_SW_THREADS of the tiled renderer */
+#define TILE_FRAMES             8
+#define TILE_COMMANDS           300     /**< Random draw calls per frame */
+#define FILL_SURFACES           64      /**< Random surfaces per fill kernel, every other one large */
+#define FILL_RECTS              16      /**< Random rects filled on each */
+#define FILL_BENCH_MS           500     /**< Time each benchmark runs for */
+
+static const char* const KERNEL_NAMES[] = { "scalar", "sse2", "avx2" };
+static const char* const FILL_KERNELS[] = { "scalar", "sse", "avx2", "avx512" };    /**< SDL_HINT_FILLRECT_KERNEL */
+
+static uint32_t RngState = 0x9E3779B9u;
+
+static uint32_t
+nextRandom()
+{
+    RngState ^= RngState << 13;
+    RngState ^= RngState >> 17;
+    RngState ^= RngState << 5;
+    return RngState;
+}
+
+// Print the outcome of a check and count it when it failed.
+static void
+report( int* failures, bool passed, const char* check, const char* kernel )
+{
+    printf( "%-4s %s (%s)\n", passed ? "ok" : "FAIL", check, kernel );
+    *failures += !passed;
+}
+
+/**************************************************************************
+** Board evaluation (board_eval.h)
+**************************************************************************/
+
+// Mostly boards like the game makes, stacks with a few holes, and some plain noise to
+// reach feature values play never does.
+static void
+randomBoard( PackedBoard* board )
+{
+    const bool noise = nextRandom() % 4 == 0;
+    for( int x = 0; x < BOARD_WIDTH; x++ )
+    {
+        const uint32_t bits = nextRandom();
+        if( noise )
+        {
+            board->cols[ x ] = bits & COLUMN_BITS;
+            continue;
+        }
+
+        // Row 0 is the top, a stack of height h fills the lowest h rows.
+        const int height = (int) ( nextRandom() % ( BOARD_HEIGHT + 1 ) );
+        const uint32_t stack = height == 0 ? 0 : ( COLUMN_BITS >> ( BOARD_HEIGHT - height ) ) << ( BOARD_HEIGHT - height );
+        board->cols[ x ] = stack & ~( bits & ( bits >> 7 ) & ( bits >> 14 ) );
+    }
+}
+
+static void
+randomWeights( EvalWeights* weights )
+{
+    float* values[] = { &weights->height, &weights->holes, &weights->bumpiness, &weights->wells, &weights->row_transitions };
+    for( int i = 0; i < (int) SDL_arraysize( values ); i++ )
+    {
+        *values[ i ] = -(float) ( nextRandom() % 100000 ) / 10000.0f;
+    }
+}
+
+// Every batch size up to MAX_TAIL, so each kernel's leftover path runs, then one large
+// batch that starts off its alignment.
+static bool
+compareEvalKernel( const PackedBoard* boards, const EvalWeights* weights, float* expected, float* scores )
+{
+    for( int count = 0; count <= MAX_TAIL; count++ )
+    {
+        evalBoardsScalar( boards, count, weights, expected );
+        evalBoards( boards, count, weights, scores );
+        if( memcmp( expected, scores, sizeof( float ) * count ) != 0 )
+        {
+            return false;
+        }
+    }
+
+    evalBoardsScalar( boards + 1, RANDOM_BOARDS - 1, weights, expected );
+    evalBoards( boards + 1, RANDOM_BOARDS - 1, weights, scores );
+    return memcmp( expected, scores, sizeof( float ) * ( RANDOM_BOARDS - 1 ) ) == 0;
+}
+
+static void
+testEvalKernels( int* failures )
+{
+    PackedBoard* boards = SDL_malloc( sizeof( PackedBoard ) * RANDOM_BOARDS );
+    float* expected = SDL_malloc( sizeof( float ) * RANDOM_BOARDS );
+    float* scores = SDL_malloc( sizeof( float ) * RANDOM_BOARDS );
+    for( int i = 0; i < RANDOM_BOARDS; i++ )
+    {
+        randomBoard( &boards[ i ] );
+    }
+    SDL_zero( boards[ 0 ] );
+    SDL_memset( &boards[ 1 ], 0xFF, sizeof( PackedBoard ) );
+    for( int x = 0; x < BOARD_WIDTH; x++ )
+    {
+        boards[ 1 ].cols[ x ] &= COLUMN_BITS;
+    }
+
+    for( int k = 0; k < (int) SDL_arraysize( KERNEL_NAMES ); k++ )
+    {
+        if( !evalBoardsSetKernel( KERNEL_NAMES[ k ] ) )
+        {
+            printf( "skip evalBoards matches evalBoardsScalar (%s, not supported)\n", KERNEL_NAMES[ k ] );
+            continue;
+        }
+
+        bool passed = true;
+        for( int round = 0; round < 8 && passed; round++ )
+        {
+            EvalWeights weights;
+            randomWeights( &weights );
+            passed = compareEvalKernel( boards, &weights, expected, scores );
+        }
+        report( failures, passed, "evalBoards matches evalBoardsScalar", KERNEL_NAMES[ k ] );
+    }
+    evalBoardsSetKernel( NULL );
+
+    SDL_free( boards );
+    SDL_free( expected );
+    SDL_free( scores );
+}
+
+/**************************************************************************
+** Observation encoding (obs_encoder.h)
+**************************************************************************/
+
+// Every output of count games in one allocation, so buffers can be compared with memcmp.
+typedef struct ObsTensors
+{
+    uint8_t*    memory;
+    size_t      size;
+    ObsBuffers  buffers;
+} ObsTensors;
+
+static void
+allocObsTensors( ObsTensors* tensors, int count )
+{
+    const size_t board_bits = sizeof( uint16_t ) * OBS_BOARD_BITS_SIZE * count;
+    const size_t board = (size_t) OBS_BOARD_SIZE * count;
+    const size_t piece = (size_t) OBS_PIECE_SIZE * count;
+    const size_t next = (size_t) OBS_NEXT_SIZE * count;
+    const size_t position = (size_t) OBS_POSITION_SIZE * count;
+    tensors->size = board_bits + board + piece + next + position + (size_t) OBS_HEIGHTS_SIZE * count;
+    tensors->memory = SDL_malloc( tensors->size );
+
+    uint8_t* at = tensors->memory;
+    tensors->buffers.board_bits = (uint16_t*) at;
+    tensors->buffers.board = at += board_bits;
+    tensors->buffers.piece = at += board;
+    tensors->buffers.next_pieces = at += piece;
+    tensors->buffers.position = (int8_t*) ( at += next );
+    tensors->buffers.heights = at + position;
+}
+
+static void
+randomObservation( EnvObservation* observation )
+{
+    PackedBoard board;
+    randomBoard( &board );
+    SDL_memcpy( observation->board, board.cols, sizeof( observation->board ) );
+    observation->shape = (int32_t) ( nextRandom() % OBS_SHAPE_COUNT );
+    observation->rot = (int32_t) ( nextRandom() % OBS_ROT_COUNT );
+    observation->x = (int32_t) ( nextRandom() % BOARD_WIDTH );
+    observation->y = (int32_t) ( nextRandom() % ( BOARD_HEIGHT + 1 ) ) - 1;
+    for( int i = 0; i < PIECE_QUEUE_SIZE; i++ )
+    {
+        observation->next_shapes[ i ] = (int32_t) ( nextRandom() % OBS_SHAPE_COUNT );
+        observation->next_rots[ i ] = (int32_t) ( nextRandom() % OBS_ROT_COUNT );
+    }
+    observation->score = (int32_t) nextRandom();
+    observation->steps = (int32_t) nextRandom();
+}
+
+// Encodes with both paths into buffers filled with different bytes, so an output one
+// path leaves unwritten shows up as well. Board outputs that are not wanted are NULL.
+static bool
+compareObsEncode( const EnvObservation* observations, int count, bool board_bits, bool board,
+                  ObsTensors* expected, ObsTensors* encoded )
+{
+    SDL_memset( expected->memory, 0x00, expected->size );
+    SDL_memset( encoded->memory, 0xCD, encoded->size );
+
+    ObsBuffers reference = expected->buffers, buffers = encoded->buffers;
+    if( !board_bits )
+    {
+        reference.board_bits = buffers.board_bits = NULL;
+        SDL_memset( expected->buffers.board_bits, 0xCD, sizeof( uint16_t ) * OBS_BOARD_BITS_SIZE * count );
+    }
+    if( !board )
+    {
+        reference.board = buffers.board = NULL;
+        SDL_memset( expected->buffers.board, 0xCD, (size_t) OBS_BOARD_SIZE * count );
+    }
+
+    obsEncodeScalar( observations, count, &reference );
+    obsEncode( observations, count, &buffers );
+    return memcmp( expected->memory, encoded->memory, expected->size ) == 0;
+}
+
+static void
+testObsKernels( int* failures )
+{
+    EnvObservation* observations = SDL_malloc( sizeof( EnvObservation ) * RANDOM_OBSERVATIONS );
+    for( int i = 0; i < RANDOM_OBSERVATIONS; i++ )
+    {
+        randomObservation( &observations[ i ] );
+    }
+
+    // The kernels write the board rows and cells in one pass, so each is also tried on
+    // its own: both, rows only, cells only.
+    const bool board_outputs[ 3 ][ 2 ] = { { true, true }, { true, false }, { false, true } };
+
+    for( int k = 0; k < (int) SDL_arraysize( KERNEL_NAMES ); k++ )
+    {
+        if( !obsEncodeSetKernel( KERNEL_NAMES[ k ] ) )
+        {
+            printf( "skip obsEncode matches obsEncodeScalar (%s, not supported)\n", KERNEL_NAMES[ k ] );
+            continue;
+        }
+
+        bool passed = true;
+        for( int o = 0; o < (int) SDL_arraysize( board_outputs ) && passed; o++ )
+        {
+            for( int count = 0; count <= MAX_TAIL && passed; count++ )
+            {
+                ObsTensors expected, encoded;
+                allocObsTensors( &expected, count );
+                allocObsTensors( &encoded, count );
+                passed = compareObsEncode( observations, count, board_outputs[ o ][ 0 ], board_outputs[ o ][ 1 ],
+                                           &expected, &encoded );
+                SDL_free( expected.memory );
+                SDL_free( encoded.memory );
+            }
+
+            ObsTensors expected, encoded;
+            allocObsTensors( &expected, RANDOM_OBSERVATIONS - 1 );
+            allocObsTensors( &encoded, RANDOM_OBSERVATIONS - 1 );
+            passed = passed && compareObsEncode( observations + 1, RANDOM_OBSERVATIONS - 1, board_outputs[ o ][ 0 ],
+                                                 board_outputs[ o ][ 1 ], &expected, &encoded );
+            SDL_free( expected.memory );
+            SDL_free( encoded.memory );
+        }
+        report( failures, passed, "obsEncode matches obsEncodeScalar", KERNEL_NAMES[ k ] );
+    }
+    obsEncodeSetKernel( NULL );
+
+    SDL_free( observations );
+}
+
+/**************************************************************************
+** Network evaluator (nn_eval.h)
+**************************************************************************/
+
+typedef struct TestLayer
+{
+    uint32_t    type;
+    uint32_t    inputs;
+    uint32_t    outputs;
+    uint32_t    activation;
+    float       scale;
+    float       weights[ BOARD_WIDTH * BOARD_HEIGHT * 32 ];     /**< int8 layers hold whole numbers */
+    float       bias[ 32 ];
+} TestLayer;
+
+// An int8 layer of 32 units, one of 20 so the AVX2 kernels have a tail, then the output.
+static void
+randomNetwork( TestLayer* layers )
+{
+    const uint32_t sizes[ NETWORK_LAYERS + 1 ] = { BOARD_WIDTH * BOARD_HEIGHT, 32, 20, 1 };
+    for( int l = 0; l < NETWORK_LAYERS; l++ )
+    {
+        TestLayer* layer = &layers[ l ];
+        layer->type = l == 0 ? NN_LAYER_I8 : NN_LAYER_F32;
+        layer->inputs = sizes[ l ];
+        layer->outputs = sizes[ l + 1 ];
+        layer->activation = l < NETWORK_LAYERS - 1 ? NN_ACTIVATION_RELU : NN_ACTIVATION_NONE;
+        layer->scale = layer->type == NN_LAYER_I8 ? 1.0f / 64.0f : 1.0f;
+        for( uint32_t i = 0; i < layer->inputs * layer->outputs; i++ )
+        {
+            layer->weights[ i ] = layer->type == NN_LAYER_I8
+                                ? (float) ( (int) ( nextRandom() % 255 ) - 127 )
+                                : (float) ( (int) ( nextRandom() % 2001 ) - 1000 ) / 1000.0f;
+        }
+        for( uint32_t o = 0; o < layer->outputs; o++ )
+        {
+            layer->bias[ o ] = (float) ( (int) ( nextRandom() % 2001 ) - 1000 ) / 1000.0f;
+        }
+    }
+}
+
+// Write layers in the format of nn_eval.h. The fields are written in host byte order,
+// which is the file's little endian on every CPU the game is built for.
+static bool
+writeNetwork( const char* path, const TestLayer* layers )
+{
+    FILE* file = fopen( path, "wb" );
+    if( file == NULL )
+    {
+        return false;
+    }
+
+    const uint32_t layer_count = NETWORK_LAYERS;
+    fwrite( "TNN1", 1, 4, file );
+    fwrite( &layer_count, sizeof( layer_count ), 1, file );
+    for( int l = 0; l < NETWORK_LAYERS; l++ )
+    {
+        const TestLayer* layer = &layers[ l ];
+        const uint32_t count = layer->inputs * layer->outputs;
+        fwrite( &layer->type, sizeof( uint32_t ), 4, file );
+        fwrite( &layer->scale, sizeof( float ), 1, file );
+        for( uint32_t i = 0; i < count; i++ )
+        {
+            if( layer->type == NN_LAYER_I8 )
+            {
+                const int8_t weight = (int8_t) layer->weights[ i ];
+                fwrite( &weight, 1, 1, file );
+            } else
+            {
+                fwrite( &layer->weights[ i ], sizeof( float ), 1, file );
+            }
+        }
+        const uint32_t zero = 0;
+        if( layer->type == NN_LAYER_I8 && count % 4 != 0 )
+        {
+            fwrite( &zero, 1, 4 - count % 4, file );
+        }
+        fwrite( layer->bias, sizeof( float ), layer->outputs, file );
+    }
+    return fclose( file ) == 0;
+}
+
+// A plain dense forward pass, one input at a time, to check nnLoad reads the layers the
+// way the format describes them.
+static float
+forwardNetwork( const TestLayer* layers, const PackedBoard* board )
+{
+    float values[ 2 ][ BOARD_WIDTH * BOARD_HEIGHT ];
+    for( int x = 0; x < BOARD_WIDTH; x++ )
+    {
+        for( int y = 0; y < BOARD_HEIGHT; y++ )
+        {
+            values[ 0 ][ x * BOARD_HEIGHT + y ] = (float) ( ( board->cols[ x ] >> y ) & 1 );
+        }
+    }
+
+    for( int l = 0; l < NETWORK_LAYERS; l++ )
+    {
+        const TestLayer* layer = &layers[ l ];
+        const float* in = values[ l % 2 ];
+        float* out = values[ ( l + 1 ) % 2 ];
+        for( uint32_t o = 0; o < layer->outputs; o++ )
+        {
+            float sum = 0;
+            for( uint32_t i = 0; i < layer->inputs; i++ )
+            {
+                sum += in[ i ] * layer->weights[ i * layer->outputs + o ] * layer->scale;
+            }
+            sum += layer->bias[ o ];
+            out[ o ] = layer->activation == NN_ACTIVATION_RELU && sum < 0 ? 0 : sum;
+        }
+    }
+    return values[ NETWORK_LAYERS % 2 ][ 0 ];
+}
+
+// The same network must give the same scores in any batch size, with AVX2 or without,
+// and match the plain forward pass up to rounding. A layer with an unknown activation
+// must not load.
+static void
+testNetwork( int* failures )
+{
+    const char* kernel = SDL_HasAVX2() ? "avx2" : "scalar";
+    TestLayer* layers = SDL_malloc( sizeof( TestLayer ) * NETWORK_LAYERS );
+    PackedBoard* boards = SDL_malloc( sizeof( PackedBoard ) * RANDOM_BOARDS );
+    float* expected = SDL_malloc( sizeof( float ) * RANDOM_BOARDS );
+    float* scores = SDL_malloc( sizeof( float ) * RANDOM_BOARDS );
+    for( int i = 0; i < RANDOM_BOARDS; i++ )
+    {
+        randomBoard( &boards[ i ] );
+    }
+    randomNetwork( layers );
+
+    NnModel* model = writeNetwork( NETWORK_PATH, layers ) ? nnLoad( NETWORK_PATH ) : NULL;
+    if( model == NULL )
+    {
+        report( failures, false, "nnLoad reads a written weights file", kernel );
+    } else
+    {
+        bool passed = true;
+        for( int count = 0; count <= 3 * NN_BATCH + 1 && passed; count++ )
+        {
+            nnEvalBoardsScalar( model, boards, count, expected );
+            nnEvalBoards( model, boards, count, scores );
+            passed = memcmp( expected, scores, sizeof( float ) * count ) == 0;
+        }
+        nnEvalBoardsScalar( model, boards + 1, RANDOM_BOARDS - 1, expected );
+        nnEvalBoards( model, boards + 1, RANDOM_BOARDS - 1, scores );
+        passed = passed && memcmp( expected, scores, sizeof( float ) * ( RANDOM_BOARDS - 1 ) ) == 0;
+        report( failures, passed, "nnEvalBoards matches nnEvalBoardsScalar", kernel );
+
+        passed = true;
+        for( int i = 0; i < 256 && passed; i++ )
+        {
+            const float reference = forwardNetwork( layers, &boards[ i + 1 ] );
+            passed = fabsf( scores[ i ] - reference ) <= 1e-3f * ( 1.0f + fabsf( reference ) );
+        }
+        report( failures, passed, "nnEvalBoards matches a plain forward pass", kernel );
+        nnFree( model );
+    }
+
+    layers[ 1 ].activation = 7;
+    model = writeNetwork( NETWORK_PATH, layers ) ? nnLoad( NETWORK_PATH ) : NULL;
+    report( failures, model == NULL, "nnLoad rejects an unknown activation", "expect a message above" );
+    nnFree( model );
+    remove( NETWORK_PATH );
+
+    SDL_free( layers );
+    SDL_free( boards );
+    SDL_free( expected );
+    SDL_free( scores );
+}
+
+/**************************************************************************
+** Tiled software rendering (SDL_HINT_RENDER_SW_THREADS)
+**************************************************************************/
+
+static SDL_Rect
+randomRect( int width, int height )
+{
+    SDL_Rect rect;
+    rect.x = (int) ( nextRandom() % ( width + 64 ) ) - 32;
+    rect.y = (int) ( nextRandom() % ( height + 64 ) ) - 32;
+    rect.w = (int) ( nextRandom() % ( nextRandom() % 4 == 0 ? width : 64 ) );
+    rect.h = (int) ( nextRandom() % ( nextRandom() % 4 == 0 ? height : 64 ) );
+    return rect;
+}
+
+// Draw a frame of random clears, fills and points in every blend mode, under random
+// clip rects and viewports. Lines are in the mix because they do not run tiled and so
+// split the batches. The same seed draws the same frame.
+static void
+drawRandomFrame( SDL_Renderer* renderer, uint32_t seed )
+{
+    static const SDL_BlendMode BLEND_MODES[] =
+    {
+        SDL_BLENDMODE_NONE, SDL_BLENDMODE_BLEND, SDL_BLENDMODE_ADD, SDL_BLENDMODE_MOD, SDL_BLENDMODE_MUL
+    };
+
+    RngState = seed;
+    for( int i = 0; i < TILE_COMMANDS; i++ )
+    {
+        SDL_SetRenderDrawColor( renderer, (Uint8) nextRandom(), (Uint8) nextRandom(), (Uint8) nextRandom(), (Uint8) nextRandom() );
+        SDL_SetRenderDrawBlendMode( renderer, BLEND_MODES[ nextRandom() % SDL_arraysize( BLEND_MODES ) ] );
+
+        SDL_Rect rects[ 8 ];
+        SDL_Point points[ 64 ];
+        const int count = 1 + (int) ( nextRandom() % 8 );
+        switch( nextRandom() % 16 )
+        {
+            case 0:
+                SDL_RenderClear( renderer );
+                break;
+            case 1:
+                rects[ 0 ] = randomRect( TILE_WIDTH, TILE_HEIGHT );
+                SDL_RenderSetClipRect( renderer, nextRandom() % 3 == 0 ? NULL : &rects[ 0 ] );
+                break;
+            case 2:
+                rects[ 0 ] = randomRect( TILE_WIDTH, TILE_HEIGHT );
+                SDL_RenderSetViewport( renderer, nextRandom() % 3 == 0 ? NULL : &rects[ 0 ] );
+                break;
+            case 3:
+                SDL_RenderDrawLine( renderer, (int) ( nextRandom() % TILE_WIDTH ), (int) ( nextRandom() % TILE_HEIGHT ),
+                                    (int) ( nextRandom() % TILE_WIDTH ), (int) ( nextRandom() % TILE_HEIGHT ) );
+                break;
+            case 4:
+                SDL_RenderFillRect( renderer, NULL );
+                break;
+            case 5:
+            case 6:
+            case 7:
+                for( int p = 0; p < 8 * count; p++ )
+                {
+                    points[ p ].x = (int) ( nextRandom() % ( TILE_WIDTH + 16 ) ) - 8;
+                    points[ p ].y = (int) ( nextRandom() % ( TILE_HEIGHT + 16 ) ) - 8;
+                }
+                SDL_RenderDrawPoints( renderer, points, 8 * count );
+                break;
+            default:
+                for( int r = 0; r < count; r++ )
+                {
+                    rects[ r ] = randomRect( TILE_WIDTH, TILE_HEIGHT );
+                }
+                SDL_RenderFillRects( renderer, rects, count );
+                break;
+        }
+    }
+
+    // SDL_RenderReadPixels reads the viewport.
+    SDL_RenderSetViewport( renderer, NULL );
+    SDL_RenderSetClipRect( renderer, NULL );
+}
+
+// Renderer on an offscreen window, with the given SDL_RENDER_SW_THREADS.
+static SDL_Renderer*
+createTileRenderer( int threads, SDL_Window** window )
+{
+    char value[ 16 ];
+    SDL_snprintf( value, sizeof( value ), "%d", threads );
+    SDL_SetHint( SDL_HINT_RENDER_SW_THREADS, value );
+    *window = SDL_CreateWindow( "selftest", 0, 0, TILE_WIDTH, TILE_HEIGHT, SDL_WINDOW_HIDDEN );
+    SDL_Renderer* renderer = *window != NULL ? SDL_CreateRenderer( *window, -1, SDL_RENDERER_SOFTWARE ) : NULL;
+    SDL_ResetHint( SDL_HINT_RENDER_SW_THREADS );
+    return renderer;
+}
+
+// Tiled rendering must give the same pixels as rendering on one thread. The window
+// framebuffers are double buffered, so the target's pixels move on every present like
+// they do while the game records.
+static void
+testTileRenderer( int* failures )
+{
+    if( SDL_VideoInit( "offscreen" ) < 0 )
+    {
+        printf( "skip tiled software rendering (no offscreen video driver: %s)\n", SDL_GetError() );
+        return;
+    }
+    SDL_SetHint( SDL_HINT_RENDER_BATCHING, "1" );
+    SDL_SetHint( SDL_HINT_VIDEO_OFFSCREEN_DOUBLE_BUFFER, "1" );
+
+    SDL_Window* windows[ 2 ];
+    SDL_Renderer* serial = createTileRenderer( 1, &windows[ 0 ] );
+    SDL_Renderer* tiled = createTileRenderer( TILE_THREADS, &windows[ 1 ] );
+    Uint32* expected = SDL_malloc( sizeof( Uint32 ) * TILE_WIDTH * TILE_HEIGHT );
+    Uint32* pixels = SDL_malloc( sizeof( Uint32 ) * TILE_WIDTH * TILE_HEIGHT );
+
+    if( serial == NULL || tiled == NULL || expected == NULL || pixels == NULL )
+    {
+        report( failures, false, "tiled software rendering matches serial", SDL_GetError() );
+    } else
+    {
+        bool passed = true;
+        for( int frame = 0; frame < TILE_FRAMES && passed; frame++ )
+        {
+            const uint32_t seed = 0x51ED270Bu * ( frame + 1 );
+            const int pitch = TILE_WIDTH * (int) sizeof( Uint32 );
+            drawRandomFrame( serial, seed );
+            drawRandomFrame( tiled, seed );
+            passed = SDL_RenderReadPixels( serial, NULL, SDL_PIXELFORMAT_ARGB8888, expected, pitch ) == 0 &&
+                     SDL_RenderReadPixels( tiled, NULL, SDL_PIXELFORMAT_ARGB8888, pixels, pitch ) == 0 &&
+                     memcmp( expected, pixels, sizeof( Uint32 ) * TILE_WIDTH * TILE_HEIGHT ) == 0;
+            SDL_RenderPresent( serial );
+            SDL_RenderPresent( tiled );
+        }
+        report( failures, passed, "tiled software rendering matches serial", "SDL_RENDER_SW_THREADS=4" );
+    }
+
+    SDL_free( expected );
+    SDL_free( pixels );
+    for( int i = 0; i < 2; i++ )
+    {
+        if( windows[ i ] != NULL )
+        {
+            SDL_DestroyRenderer( SDL_GetRenderer( windows[ i ] ) );
+            SDL_DestroyWindow( windows[ i ] );
+        }
+    }
+    SDL_ResetHint( SDL_HINT_RENDER_BATCHING );
+    SDL_ResetHint( SDL_HINT_VIDEO_OFFSCREEN_DOUBLE_BUFFER );
+    SDL_VideoQuit();
+}
+
+/**************************************************************************
+** 32-bit fills (SDL_HINT_FILLRECT_KERNEL)
+**************************************************************************/
+
+// Kernels the CPU lacks fall back to the default one, there is no point testing that.
+static bool
+fillKernelSupported( int kernel )
+{
+    switch( kernel )
+    {
+        case 1:     return SDL_HasSSE();
+        case 2:     return SDL_HasAVX2();
+        case 3:     return SDL_HasAVX512F();
+        default:    return true;
+    }
+}
+
+// What SDL_FillRects must do: fill the part of rect inside clip, pitch is in pixels.
+static void
+referenceFill( Uint32* pixels, int pitch, const SDL_Rect* clip, const SDL_Rect* rect, Uint32 color )
+{
+    SDL_Rect clipped;
+    if( !SDL_IntersectRect( rect, clip, &clipped ) )
+    {
+        return;
+    }
+    for( int y = clipped.y; y < clipped.y + clipped.h; y++ )
+    {
+        for( int x = clipped.x; x < clipped.x + clipped.w; x++ )
+        {
+            pixels[ y * pitch + x ] = color;
+        }
+    }
+}
+
+// Fill random rects on a random surface with the selected kernel and with referenceFill,
+// on the same background. Large surfaces get fills over the kernels' streaming threshold
+// of 256 KiB. Rows are padded and start misaligned at random, the bytes around the
+// surface must stay untouched.
+static bool
+compareFills( bool large )
+{
+    const int width = large ? 512 + (int) ( nextRandom() % 513 ) : 1 + (int) ( nextRandom() % 200 );
+    const int height = large ? 256 + (int) ( nextRandom() % 257 ) : 1 + (int) ( nextRandom() % 200 );
+    const int pitch = width + ( nextRandom() % 2 == 0 ? 0 : 1 + (int) ( nextRandom() % 17 ) );
+    const int offset = (int) ( nextRandom() % 16 );
+    const size_t count = (size_t) offset + (size_t) pitch * height + 16;
+
+    Uint32* pixels = SDL_malloc( sizeof( Uint32 ) * count );
+    Uint32* expected = SDL_malloc( sizeof( Uint32 ) * count );
+    SDL_Surface* surface = pixels != NULL ? SDL_CreateRGBSurfaceWithFormatFrom( pixels + offset, width, height, 32,
+                                                                               pitch * (int) sizeof( Uint32 ),
+                                                                               SDL_PIXELFORMAT_ARGB8888 ) : NULL;
+    bool passed = surface != NULL && expected != NULL;
+    if( passed )
+    {
+        for( size_t i = 0; i < count; i++ )
+        {
+            pixels[ i ] = expected[ i ] = nextRandom();
+        }
+
+        SDL_Rect clip = { 0, 0, width, height };
+        if( nextRandom() % 2 == 0 )
+        {
+            clip = randomRect( width, height );
+            SDL_SetClipRect( surface, &clip );
+            SDL_GetClipRect( surface, &clip );
+        }
+
+        for( int call = 0; call < 4 && passed; call++ )
+        {
+            SDL_Rect rects[ FILL_RECTS ];
+            const int rect_count = 1 + (int) ( nextRandom() % FILL_RECTS );
+            const Uint32 color = nextRandom();
+            for( int r = 0; r < rect_count; r++ )
+            {
+                // A quarter cover the whole surface, so the rows are contiguous when unpadded.
+                const SDL_Rect whole = { 0, 0, width, height };
+                rects[ r ] = nextRandom() % 4 == 0 ? whole : randomRect( width, height );
+                referenceFill( expected + offset, pitch, &clip, &rects[ r ], color );
+            }
+            passed = SDL_FillRects( surface, rects, rect_count, color ) == 0;
+        }
+        passed = passed && memcmp( pixels, expected, sizeof( Uint32 ) * count ) == 0;
+    }
+
+    SDL_FreeSurface( surface );
+    SDL_free( pixels );
+    SDL_free( expected );
+    return passed;
+}
+
+// Every fill kernel the CPU supports must write exactly the pixels referenceFill does.
+static void
+testFillKernels( int* failures )
+{
+    for( int kernel = 0; kernel < (int) SDL_arraysize( FILL_KERNELS ); kernel++ )
+    {
+        if( !fillKernelSupported( kernel ) )
+        {
+            continue;
+        }
+        SDL_SetHint( SDL_HINT_FILLRECT_KERNEL, FILL_KERNELS[ kernel ] );
+        bool passed = true;
+        for( int i = 0; i < FILL_SURFACES && passed; i++ )
+        {
+            passed = compareFills( i % 2 == 1 );
+        }
+        report( failures, passed, "SDL_FillRects matches a reference fill", FILL_KERNELS[ kernel ] );
+    }
+    SDL_ResetHint( SDL_HINT_FILLRECT_KERNEL );
+}
+
+// Milliseconds per SDL_FillRects call of rects on surface, run for FILL_BENCH_MS.
+static double
+benchFill( SDL_Surface* surface, const SDL_Rect* rects, int count )
+{
+    const Uint64 start = SDL_GetPerformanceCounter();
+    const Uint64 end = start + SDL_GetPerformanceFrequency() * FILL_BENCH_MS / 1000;
+    Uint64 now;
+    int calls = 0;
+    do
+    {
+        SDL_FillRects( surface, rects, count, 0xFF000000u | (Uint32) calls );
+        calls++;
+        now = SDL_GetPerformanceCounter();
+    } while( now < end );
+    return (double) ( now - start ) * 1000.0 / (double) SDL_GetPerformanceFrequency() / calls;
+}
+
+// tetris_selftest --bench: time the fills the game's software rendering does with every
+// kernel the CPU supports. The cell grid is 20x20 cells one pixel apart on the window.
+static int
+benchFillKernels()
+{
+    SDL_Surface* window = SDL_CreateRGBSurfaceWithFormat( 0, 600, 900, 32, SDL_PIXELFORMAT_ARGB8888 );
+    SDL_Surface* screen = SDL_CreateRGBSurfaceWithFormat( 0, 1920, 1080, 32, SDL_PIXELFORMAT_ARGB8888 );
+    SDL_Rect cells[ 30 * 45 ];
+    if( window == NULL || screen == NULL )
+    {
+        printf( "Could not create the surfaces. SDL_Error: %s\n", SDL_GetError() );
+        return 1;
+    }
+    for( int i = 0; i < 30 * 45; i++ )
+    {
+        cells[ i ] = (SDL_Rect) { ( i % 30 ) * 20, ( i / 30 ) * 20, 19, 19 };
+    }
+    const SDL_Rect window_rect = { 0, 0, 600, 900 };
+    const SDL_Rect screen_rect = { 0, 0, 1920, 1080 };
+
+    printf( "%-8s %12s %12s %12s  (ms per call)\n", "kernel", "cell grid", "600x900", "1920x1080" );
+    for( int kernel = 0; kernel < (int) SDL_arraysize( FILL_KERNELS ); kernel++ )
+    {
+        if( !fillKernelSupported( kernel ) )
+        {
+            continue;
+        }
+        SDL_SetHint( SDL_HINT_FILLRECT_KERNEL, FILL_KERNELS[ kernel ] );
+        printf( "%-8s %12.4f %12.4f %12.4f\n",
+                FILL_KERNELS[ kernel ],
+                benchFill( window, cells, 30 * 45 ),
+                benchFill( window, &window_rect, 1 ),
+                benchFill( screen, &screen_rect, 1 ) );
+    }
+    SDL_ResetHint( SDL_HINT_FILLRECT_KERNEL );
+
+    SDL_FreeSurface( window );
+    SDL_FreeSurface( screen );
+    return 0;
+}
+
+#ifdef TETRIS_SELFTEST_REPLAY
+/**************************************************************************
+** Replay buffer (replay.h)
+**************************************************************************/
+
+typedef struct ReplayStress
+{
+    ReplayBuffer*   buffer;
+    SDL_atomic_t    producing;          /**< Producers still appending */
+    SDL_atomic_t    torn;               /**< Samples that did not verify */
+} ReplayStress;
+
+typedef struct ReplayWorker
+{
+    ReplayStress*   stress;
+    int             index;
+    bool            prioritized;        /**< Samplers only */
+} ReplayWorker;
+
+// Every byte of a transition follows from the tag in its first four board bytes, so a
+// sample mixed from two appends, or read while it was written, does not verify.
+static void
+makeTransition( uint32_t tag, ReplayTransition* transition )
+{
+    uint32_t hash = tag * 2654435761u;
+    uint8_t* bytes = (uint8_t*) transition;
+    memcpy( bytes, &tag, sizeof( tag ) );
+    for( size_t i = sizeof( tag ); i < sizeof( ReplayTransition ); i++ )
+    {
+        hash = hash * 1664525u + 1013904223u;
+        bytes[ i ] = (uint8_t) ( hash >> 24 );
+    }
+}
+
+static bool
+verifyTransition( const ReplayTransition* transition )
+{
+    uint32_t tag;
+    ReplayTransition expected;
+    memcpy( &tag, transition, sizeof( tag ) );
+    makeTransition( tag, &expected );
+    return memcmp( transition, &expected, sizeof( ReplayTransition ) ) == 0;
+}
+
+// Appends runs of 1 to 300 transitions, so runs start and end anywhere in a block and
+// often span two.
+static int
+replayProducer( void* data )
+{
+    const ReplayWorker* worker = data;
+    ReplayTransition run[ 300 ];
+    uint32_t rng = 2654435761u * (uint32_t) ( worker->index + 1 );
+    int appended = 0;
+    while( appended < STRESS_PER_PRODUCER )
+    {
+        rng = rng * 1664525u + 1013904223u;
+        const int count = SDL_min( 1 + (int) ( ( rng >> 8 ) % SDL_arraysize( run ) ), STRESS_PER_PRODUCER - appended );
+        for( int i = 0; i < count; i++ )
+        {
+            makeTransition( (uint32_t) worker->index << 24 | (uint32_t) ( appended + i ), &run[ i ] );
+        }
+        replayAppend( worker->stress->buffer, run, count );
+        appended += count;
+    }
+    SDL_AtomicAdd( &worker->stress->producing, -1 );
+    return 0;
+}
+
+// Samples until the producers are done. The prioritized sampler gives every sample a new
+// priority, like a learner does with its TD errors.
+static int
+replaySampler( void* data )
+{
+    const ReplayWorker* worker = data;
+    ReplayStress* stress = worker->stress;
+    ReplayTransition samples[ 64 ];
+    uint64_t indices[ 64 ];
+    float probabilities[ 64 ];
+    float priorities[ 64 ];
+    uint64_t rng = (uint64_t) worker->index + 1;
+    while( SDL_AtomicGet( &stress->producing ) > 0 )
+    {
+        const int count = worker->prioritized
+                        ? replaySamplePrioritized( stress->buffer, &rng, 64, samples, indices, probabilities )
+                        : replaySampleUniform( stress->buffer, &rng, 64, samples, indices );
+        for( int i = 0; i < count; i++ )
+        {
+            if( !verifyTransition( &samples[ i ] ) ||
+                ( worker->prioritized && !( probabilities[ i ] > 0 && probabilities[ i ] <= 1 ) ) )
+            {
+                SDL_AtomicIncRef( &stress->torn );
+            }
+            priorities[ i ] = 0.1f + (float) ( indices[ i ] % 1000 ) / 500.0f;
+        }
+        if( worker->prioritized )
+        {
+            replayUpdatePriorities( stress->buffer, indices, priorities, count );
+        }
+    }
+    return 0;
+}
+
+// Every leaf of the sum tree must match the priorities of its block, and every node the
+// sum of its children. The tree is updated with a delta per change, so it only matches
+// to rounding.
+static bool
+checkSumTree( const ReplayBuffer* buffer )
+{
+    const uint64_t leaves = buffer->header->tree_leaves;
+    for( uint64_t node = 1; node < 2 * leaves; node++ )
+    {
+        double expected = 0;
+        if( node >= leaves )
+        {
+            const uint64_t block = node - leaves;
+            for( int r = 0; block < buffer->blocks && r < REPLAY_BLOCK_SIZE; r++ )
+            {
+                expected += buffer->priorities[ block * REPLAY_BLOCK_SIZE + r ];
+            }
+        } else
+        {
+            expected = buffer->tree[ 2 * node ] + buffer->tree[ 2 * node + 1 ];
+        }
+        if( fabs( buffer->tree[ node ] - expected ) > 1e-6 * ( 1.0 + expected ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Producers append while a uniform and a prioritized sampler read the same small buffer.
+// No sample may be torn, every append must be counted and the sum tree must still add up
+// to the priorities once the threads are done.
+static void
+testReplayStress( int* failures )
+{
+    char path[ 64 ];
+    SDL_snprintf( path, sizeof( path ), "/tmp/tetris_selftest_%d.replay", (int) getpid() );
+    unlink( path );
+
+    ReplayStress stress;
+    SDL_zero( stress );
+    stress.buffer = replayOpen( path, STRESS_CAPACITY, true );
+    if( stress.buffer == NULL )
+    {
+        report( failures, false, "replay buffer stress", "could not create the buffer" );
+        return;
+    }
+    SDL_AtomicSet( &stress.producing, STRESS_PRODUCERS );
+
+    ReplayWorker workers[ STRESS_PRODUCERS + 2 ];
+    SDL_Thread* threads[ STRESS_PRODUCERS + 2 ];
+    for( int t = 0; t < STRESS_PRODUCERS + 2; t++ )
+    {
+        workers[ t ].stress = &stress;
+        workers[ t ].index = t;
+        workers[ t ].prioritized = t == STRESS_PRODUCERS + 1;
+        threads[ t ] = SDL_CreateThread( t < STRESS_PRODUCERS ? replayProducer : replaySampler, "replay", &workers[ t ] );
+        if( threads[ t ] == NULL )
+        {
+            // Run it here instead, producers come first so a sampler run here ends.
+            ( t < STRESS_PRODUCERS ? replayProducer : replaySampler )( &workers[ t ] );
+        }
+    }
+    for( int t = 0; t < STRESS_PRODUCERS + 2; t++ )
+    {
+        SDL_WaitThread( threads[ t ], NULL );
+    }
+
+    // Once quiet every block is finished, except for the one the last append ended in.
+    uint64_t rng = 3;
+    ReplayTransition samples[ 256 ];
+    const int sampled = replaySampleUniform( stress.buffer, &rng, 256, samples, NULL );
+    for( int i = 0; i < sampled; i++ )
+    {
+        if( !verifyTransition( &samples[ i ] ) )
+        {
+            SDL_AtomicIncRef( &stress.torn );
+        }
+    }
+
+    const bool passed = SDL_AtomicGet( &stress.torn ) == 0 &&
+                        sampled == 256 &&
+                        atomic_load( &stress.buffer->header->head ) == (uint64_t) STRESS_PRODUCERS * STRESS_PER_PRODUCER &&
+                        checkSumTree( stress.buffer );
+    if( SDL_AtomicGet( &stress.torn ) > 0 )
+    {
+        printf( "     %d torn sample(s)\n", SDL_AtomicGet( &stress.torn ) );
+    }
+    report( failures, passed, "replay buffer stress", "4 producers, 2 samplers" );
+
+    replayClose( stress.buffer );
+    unlink( path );
+}
+#endif
+
+/**************************************************************************
+** Main
+**************************************************************************/
+
+int
+main( int argc, char* argv[] )
+{
+    if( argc > 1 && strcmp( argv[ 1 ], "--bench" ) == 0 )
+    {
+        return benchFillKernels();
+    }
+
+    int failures = 0;
+
+    testEvalKernels( &failures );
+    testObsKernels( &failures );
+    testNetwork( &failures );
+    testTileRenderer( &failures );
+    testFillKernels( &failures );
+#ifdef TETRIS_SELFTEST_REPLAY
+    testReplayStress( &failures );
+#endif
+
+    printf( "%d check(s) failed\n", failures );
+    return failures > 0 ? 1 : 0;
+}
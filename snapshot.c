@@ -0,0 +1,80 @@
+#include "snapshot.h"
+
+/*
+ * Copy what the renderer needs out of game_state.
+ */
+void
+snapshotFromGame( const GameState* game_state, GameSnapshot* snapshot )
+{
+    for( int i = 0; i < BOARD_WIDTH; i++ )
+    {
+        for( int j = 0; j < BOARD_HEIGHT; j++ )
+        {
+            snapshot->cells[ i ][ j ] = matrixGet( game_state->board, i, j ) != 0;
+        }
+    }
+
+    snapshot->active_shape = game_state->active_shape;
+    snapshot->active_shape_rot = game_state->active_shape_rot;
+    snapshot->active_shape_x = game_state->active_shape_x;
+    snapshot->active_shape_y = game_state->active_shape_y;
+    for( int i = 0; i < PIECE_QUEUE_SIZE; i++ )
+    {
+        peekShape( game_state, i, &snapshot->next_shapes[ i ], &snapshot->next_rots[ i ] );
+    }
+    snapshot->score = game_state->score;
+}
+
+/*
+ * Start with every slot holding game_state, so the reader has something to draw before
+ * the first publish.
+ */
+void
+snapshotInit( SnapshotBuffer* buffer, const GameState* game_state )
+{
+    snapshotFromGame( game_state, &buffer->slots[ 0 ] );
+    buffer->slots[ 1 ] = buffer->slots[ 0 ];
+    buffer->slots[ 2 ] = buffer->slots[ 0 ];
+    buffer->back = 0;
+    SDL_AtomicSet( &buffer->shared, 1 );
+    buffer->front = 2;
+}
+
+/*
+ * Writer: the slot to fill. It is not read by anyone until snapshotPublish.
+ */
+GameSnapshot*
+snapshotBack( SnapshotBuffer* buffer )
+{
+    return &buffer->slots[ buffer->back ];
+}
+
+/*
+ * Writer: make the back slot the newest snapshot and take the middle one as the new
+ * back slot. A snapshot the reader never picked up is simply overwritten next time.
+ */
+void
+snapshotPublish( SnapshotBuffer* buffer )
+{
+    // SDL_AtomicSet is only an acquire barrier with GCC, the writes to the slot must
+    // not move past it.
+    SDL_MemoryBarrierRelease();
+    buffer->back = SDL_AtomicSet( &buffer->shared, buffer->back | SNAPSHOT_FRESH ) & ~SNAPSHOT_FRESH;
+}
+
+/*
+ * Reader: the newest published snapshot, or the one returned last time when nothing
+ * was published since. Valid until the next call.
+ */
+const GameSnapshot*
+snapshotAcquire( SnapshotBuffer* buffer )
+{
+    if( SDL_AtomicGet( &buffer->shared ) & SNAPSHOT_FRESH )
+    {
+        // Reads of the old front slot must be done before the writer can get it back.
+        SDL_MemoryBarrierRelease();
+        buffer->front = SDL_AtomicSet( &buffer->shared, buffer->front ) & ~SNAPSHOT_FRESH;
+        SDL_MemoryBarrierAcquire();
+    }
+    return &buffer->slots[ buffer->front ];
+}
@@ -0,0 +1,58 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+#include <SDL.h>
+#include "game.h"
+
+/**************************************************************************
+** Game state snapshots, handed from the logic thread to the main thread
+** through a triple buffer. The writer always has a slot of its own to
+** fill, the reader always has the slot it is drawing, and the third slot
+** holds the newest finished snapshot. Publishing and picking up a
+** snapshot each swap one index atomically, so neither side ever waits for
+** the other: the writer never blocks on a slow frame and the reader
+** simply draws the newest snapshot again when nothing changed.
+**************************************************************************/
+
+#define SNAPSHOT_FRESH          4       /**< Set in the shared index until the reader takes it */
+
+/**
+ * Everything renderTick draws, copied out of a GameState.
+ */
+typedef struct GameSnapshot
+{
+    uint8_t         cells[ BOARD_WIDTH ][ BOARD_HEIGHT ];   /**< 1 for frozen cells */
+    TETRIS_SHAPE    active_shape;
+    TETRIS_ROT      active_shape_rot;
+    int             active_shape_x;
+    int             active_shape_y;
+    TETRIS_SHAPE    next_shapes[ PIECE_QUEUE_SIZE ];        /**< Next one first */
+    TETRIS_ROT      next_rots[ PIECE_QUEUE_SIZE ];
+    int             score;
+} GameSnapshot;
+
+typedef struct SnapshotBuffer
+{
+    GameSnapshot    slots[ 3 ];
+    _Alignas( 64 ) SDL_atomic_t shared;     /**< Slot in the middle, | SNAPSHOT_FRESH when unread */
+    _Alignas( 64 ) int back;                /**< Slot the writer fills, only the writer touches it */
+    _Alignas( 64 ) int front;               /**< Slot the reader draws, only the reader touches it */
+} SnapshotBuffer;
+
+void
+snapshotFromGame( const GameState* game_state, GameSnapshot* snapshot );
+
+void
+snapshotInit( SnapshotBuffer* buffer, const GameState* game_state );
+
+GameSnapshot*
+snapshotBack( SnapshotBuffer* buffer );
+
+void
+snapshotPublish( SnapshotBuffer* buffer );
+
+const GameSnapshot*
+snapshotAcquire( SnapshotBuffer* buffer );
+
+#endif //SNAPSHOT_H
@@ -0,0 +1,461 @@
+//
+// Spectator view. Plays up to MAX_GAMES games with the bot on worker threads and shows
+// all of them live in one window, laid out in a grid that fills it.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+#include "board_texture.h"
+#include "bot.h"
+#include "game.h"
+#include "snapshot.h"
+
+/**************************************************************************
+** Config
+**************************************************************************/
+#define WINDOW_TITLE            "Tetris spectator"
+#define DEFAULT_GAMES           64
+#define MAX_GAMES               256
+#define DEFAULT_WIDTH           1280
+#define DEFAULT_HEIGHT          720
+#define DEFAULT_TICK_MS         50      /**< Gravity tick of the spectated games */
+#define DEFAULT_SEED            1u
+#define FRAME_MS                ( 1000.0 / 60 )
+#define BOARD_GAP_CELLS         1       /**< Cells between neighbouring boards */
+#define MIN_PADDED_CELL_PX      6       /**< Smaller cells are drawn without padding */
+
+/**************************************************************************
+** Structs
+**************************************************************************/
+
+typedef struct SpectatorConfig
+{
+    int             games;
+    int             threads;            /**< Worker threads, each plays a range of games */
+    int             tick_ms;
+    int             width;              /**< Window size */
+    int             height;
+    bool            software;           /**< Force the software renderer */
+    double          bench_seconds;      /**< Draw as fast as possible for this long and report */
+} SpectatorConfig;
+
+typedef struct SpectatedGame
+{
+    GameState       game;
+    uint32_t        seed;
+    bool            placed;             /**< The bot already steered the active shape */
+    SnapshotBuffer  snapshots;          /**< From the worker playing it to the render loop */
+} SpectatedGame;
+
+typedef struct Worker
+{
+    SpectatedGame*  games;
+    int             first;
+    int             count;
+    int             tick_ms;
+    SDL_Thread*     thread;
+} Worker;
+
+/**
+ * Where the boards go: columns x rows boards of cell_size pixels per cell, all drawn from
+ * one texture.
+ */
+typedef struct Layout
+{
+    int             columns;
+    int             rows;
+    int             cell_size;
+    int             cell_padding;
+    int             x;                  /**< Top left corner of the grid in the window */
+    int             y;
+} Layout;
+
+/**************************************************************************
+** Global variables
+**************************************************************************/
+static SDL_atomic_t WorkersQuit;
+
+static const SDL_Color COLOR_DARK   = { 0x29, 0x29, 0x29, 0xFF };
+static const SDL_Color COLOR_BLACK  = { 0x00, 0x00, 0x00, 0xFF };
+static const SDL_Color COLOR_FROZEN = { 246,  250,  112,  0xFF };
+
+static const SDL_Color SHAPE_COLORS[ 7 ] =
+{
+    [ TETRIS_SHAPE_SQUARE ] = { 246,    250,    112,    0xFF },
+    [ TETRIS_SHAPE_T ]      = { 255,    0,      96,     0xFF },
+    [ TETRIS_SHAPE_LONG ]   = { 0,      223,    162,    0xFF },
+    [ TETRIS_SHAPE_S ]      = { 0,      121,    255,    0xFF },
+    [ TETRIS_SHAPE_Z ]      = { 246,    250,    112,    0xFF },
+    [ TETRIS_SHAPE_J ]      = { 255,    0,      96,     0xFF },
+    [ TETRIS_SHAPE_L ]      = { 0,      223,    162,    0xFF },
+};
+
+/**************************************************************************
+** Games
+**************************************************************************/
+
+// One gravity tick. A freshly spawned shape is first turned and moved where the bot
+// wants it, then it falls like a player's shape would.
+static void
+stepGame( SpectatedGame* spectated )
+{
+    GameState* game = &spectated->game;
+
+    if( !spectated->placed )
+    {
+        BotMove move;
+        if( botFindMove( game, &BOT_DEFAULT_WEIGHTS, &move ) )
+        {
+            for( int i = 0; i < move.rotations; i++ )
+            {
+                rotateShape( game );
+            }
+            const int dx = move.x < game->active_shape_x ? -1 : 1;
+            while( game->active_shape_x != move.x && moveShape( game, dx, 0 ) == 0 )
+            {
+            }
+        }
+        spectated->placed = true;
+    }
+
+    const int y = game->active_shape_y;
+    logicTick( game );
+    if( game->active_shape_y < y )
+    {
+        spectated->placed = false;
+    }
+
+    if( game->game_over )
+    {
+        freeGameState( game );
+        spectated->seed += MAX_GAMES;
+        initGameState( game, spectated->seed );
+        spectated->placed = false;
+    }
+}
+
+static int
+workerThread( void* data )
+{
+    Worker* worker = data;
+    Uint64 next_tick = SDL_GetTicks64();
+
+    while( !SDL_AtomicGet( &WorkersQuit ) )
+    {
+        for( int i = worker->first; i < worker->first + worker->count; i++ )
+        {
+            SpectatedGame* spectated = &worker->games[ i ];
+            stepGame( spectated );
+            snapshotFromGame( &spectated->game, snapshotBack( &spectated->snapshots ) );
+            snapshotPublish( &spectated->snapshots );
+        }
+
+        next_tick += worker->tick_ms;
+        const Uint64 now = SDL_GetTicks64();
+        if( next_tick > now )
+        {
+            SDL_Delay( (Uint32) ( next_tick - now ) );
+        } else
+        {
+            next_tick = now;
+        }
+    }
+
+    return 0;
+}
+
+/**************************************************************************
+** Layout
+**************************************************************************/
+
+/*
+ * Pick the number of columns that gives the largest cells for games boards in a window
+ * of width x height. Cells shrink down to a single pixel, and lose their padding once
+ * they get too small for it.
+ */
+static Layout
+layoutBoards( int games, int width, int height )
+{
+    const int board_width = BOARD_WIDTH + BOARD_GAP_CELLS;
+    const int board_height = BOARD_HEIGHT + BOARD_GAP_CELLS;
+    Layout best = { games, 1, 0, 0, 0, 0 };
+
+    for( int columns = 1; columns <= games; columns++ )
+    {
+        const int rows = ( games + columns - 1 ) / columns;
+        const int cell_width = width / ( columns * board_width );
+        const int cell_height = height / ( rows * board_height );
+        const int cell_size = cell_width < cell_height ? cell_width : cell_height;
+        if( cell_size > best.cell_size )
+        {
+            best.columns = columns;
+            best.rows = rows;
+            best.cell_size = cell_size;
+        }
+    }
+    if( best.cell_size < 1 )
+    {
+        best.cell_size = 1;
+    }
+
+    // Padding comes out of the cell, the grid keeps its size.
+    best.cell_padding = best.cell_size >= MIN_PADDED_CELL_PX ? 1 : 0;
+    best.x = ( width - best.columns * board_width * best.cell_size ) / 2;
+    best.y = ( height - best.rows * board_height * best.cell_size ) / 2;
+    return best;
+}
+
+/**************************************************************************
+** Rendering
+**************************************************************************/
+
+// Every board is a block of texels in one texture, separated by gap cells in the
+// background color, so all boards together are two draw calls.
+static BoardTexture*
+createBoards( SDL_Renderer* renderer, const Layout* layout )
+{
+    const int width = layout->columns * ( BOARD_WIDTH + BOARD_GAP_CELLS );
+    const int height = layout->rows * ( BOARD_HEIGHT + BOARD_GAP_CELLS );
+    BoardTexture* boards = boardTextureCreate( renderer, width, height, layout->x, layout->y,
+                                               layout->cell_size - layout->cell_padding, layout->cell_padding,
+                                               COLOR_DARK );
+    if( boards == NULL )
+    {
+        return NULL;
+    }
+
+    for( int j = 0; j < height; j++ )
+    {
+        for( int i = 0; i < width; i++ )
+        {
+            boardTextureSetCell( boards, i, j, COLOR_DARK );
+        }
+    }
+    return boards;
+}
+
+static void
+drawGame( BoardTexture* boards, const Layout* layout, int index, const GameSnapshot* snapshot )
+{
+    const int left = ( index % layout->columns ) * ( BOARD_WIDTH + BOARD_GAP_CELLS );
+    const int top = ( index / layout->columns ) * ( BOARD_HEIGHT + BOARD_GAP_CELLS );
+
+    for( int j = 0; j < BOARD_HEIGHT; j++ )
+    {
+        for( int i = 0; i < BOARD_WIDTH; i++ )
+        {
+            boardTextureSetCell( boards, left + i, top + j, snapshot->cells[ i ][ j ] ? COLOR_FROZEN : COLOR_BLACK );
+        }
+    }
+
+    int cells[ 4 ][ 2 ];
+    getShapeCells( snapshot->active_shape,
+                   snapshot->active_shape_x,
+                   snapshot->active_shape_y,
+                   snapshot->active_shape_rot,
+                   cells );
+    for( int coord = 0; coord < 4; coord++ )
+    {
+        const int x = cells[ coord ][ 0 ];
+        const int y = cells[ coord ][ 1 ];
+        if( x >= 0 && x < BOARD_WIDTH && y >= 0 && y < BOARD_HEIGHT )
+        {
+            boardTextureSetCell( boards, left + x, top + y, SHAPE_COLORS[ snapshot->active_shape ] );
+        }
+    }
+}
+
+// Draw frames until the window is closed (or the benchmark ends).
+static void
+renderLoop( const SpectatorConfig* config, SDL_Renderer* renderer, SpectatedGame* games )
+{
+    const Layout layout = layoutBoards( config->games, config->width, config->height );
+    BoardTexture* boards = createBoards( renderer, &layout );
+    if( boards == NULL )
+    {
+        printf( "Could not create the board texture. SDL_Error: %s\n", SDL_GetError() );
+        return;
+    }
+    printf( "%d games in %d x %d boards of %d px cells\n",
+            config->games, layout.columns, layout.rows, layout.cell_size );
+
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    const Uint64 start = SDL_GetPerformanceCounter();
+    Uint64 busy = 0;
+    int frames = 0;
+    bool running = true;
+
+    while( running )
+    {
+        SDL_Event event;
+        while( SDL_PollEvent( &event ) != 0 )
+        {
+            if( event.type == SDL_QUIT ||
+                ( event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE ) )
+            {
+                running = false;
+            }
+        }
+
+        const Uint64 frame_start = SDL_GetPerformanceCounter();
+        SDL_SetRenderDrawColor( renderer, COLOR_DARK.r, COLOR_DARK.g, COLOR_DARK.b, COLOR_DARK.a );
+        SDL_RenderClear( renderer );
+        for( int g = 0; g < config->games; g++ )
+        {
+            drawGame( boards, &layout, g, snapshotAcquire( &games[ g ].snapshots ) );
+        }
+        boardTextureDraw( boards, renderer );
+        SDL_RenderPresent( renderer );
+        frames++;
+
+        const Uint64 now = SDL_GetPerformanceCounter();
+        busy += now - frame_start;
+        const double elapsed_ms = (double) ( now - start ) * 1000 / frequency;
+        if( config->bench_seconds > 0 )
+        {
+            running = running && elapsed_ms < config->bench_seconds * 1000;
+        } else if( frames * FRAME_MS > elapsed_ms )
+        {
+            SDL_Delay( (Uint32) ( frames * FRAME_MS - elapsed_ms ) );
+        }
+    }
+
+    if( config->bench_seconds > 0 )
+    {
+        const double seconds = (double) ( SDL_GetPerformanceCounter() - start ) / frequency;
+        printf( "%d frames in %.2f s: %.1f fps, %.2f ms per frame\n",
+                frames, seconds, frames / seconds, (double) busy * 1000 / frequency / frames );
+    }
+    boardTextureDestroy( boards );
+}
+
+/**************************************************************************
+** Main
+**************************************************************************/
+
+static void
+printUsage( const char* program )
+{
+    printf( "Usage: %s [--games N] [--threads N] [--tick MS] [--size WIDTH HEIGHT] [--software] [--bench SECONDS]\n",
+            program );
+}
+
+int
+main( int argc, char* argv[] )
+{
+    SpectatorConfig config;
+    config.games = DEFAULT_GAMES;
+    config.threads = SDL_GetCPUCount();
+    config.tick_ms = DEFAULT_TICK_MS;
+    config.width = DEFAULT_WIDTH;
+    config.height = DEFAULT_HEIGHT;
+    config.software = false;
+    config.bench_seconds = 0;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        const bool has_value = i + 1 < argc;
+        if( strcmp( argv[ i ], "--games" ) == 0 && has_value )
+        {
+            config.games = atoi( argv[ ++i ] );
+        } else if( strcmp( argv[ i ], "--threads" ) == 0 && has_value )
+        {
+            config.threads = atoi( argv[ ++i ] );
+        } else if( strcmp( argv[ i ], "--tick" ) == 0 && has_value )
+        {
+            config.tick_ms = atoi( argv[ ++i ] );
+        } else if( strcmp( argv[ i ], "--size" ) == 0 && i + 2 < argc )
+        {
+            config.width = atoi( argv[ ++i ] );
+            config.height = atoi( argv[ ++i ] );
+        } else if( strcmp( argv[ i ], "--software" ) == 0 )
+        {
+            config.software = true;
+        } else if( strcmp( argv[ i ], "--bench" ) == 0 && has_value )
+        {
+            config.bench_seconds = atof( argv[ ++i ] );
+        } else
+        {
+            printUsage( argv[ 0 ] );
+            return RESULT_ERROR;
+        }
+    }
+    if( config.games < 1 || config.games > MAX_GAMES || config.threads < 1 || config.tick_ms < 1 ||
+        config.width < 1 || config.height < 1 )
+    {
+        printUsage( argv[ 0 ] );
+        return RESULT_ERROR;
+    }
+    if( config.threads > config.games )
+    {
+        config.threads = config.games;
+    }
+
+    if( SDL_Init( SDL_INIT_VIDEO ) < 0 )
+    {
+        printf( "Could not initialize SDL. SDL_Error: %s\n", SDL_GetError() );
+        return RESULT_ERROR;
+    }
+    SDL_Window* window = SDL_CreateWindow( WINDOW_TITLE, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                           config.width, config.height, SDL_WINDOW_SHOWN );
+    SDL_Renderer* renderer = window != NULL
+                           ? SDL_CreateRenderer( window, -1, config.software ? SDL_RENDERER_SOFTWARE : 0 )
+                           : NULL;
+    SpectatedGame* games = calloc( config.games, sizeof( SpectatedGame ) );
+    Worker* workers = calloc( config.threads, sizeof( Worker ) );
+    if( renderer == NULL || games == NULL || workers == NULL )
+    {
+        printf( "Could not open the window. SDL_Error: %s\n", SDL_GetError() );
+        free( games );
+        free( workers );
+        SDL_Quit();
+        return RESULT_ERROR;
+    }
+
+    RESULT result = RESULT_SUCCESS;
+    botInit();
+    for( int g = 0; g < config.games; g++ )
+    {
+        games[ g ].seed = DEFAULT_SEED + (uint32_t) g;
+        initGameState( &games[ g ].game, games[ g ].seed );
+        snapshotInit( &games[ g ].snapshots, &games[ g ].game );
+    }
+    for( int w = 0; w < config.threads; w++ )
+    {
+        workers[ w ].games = games;
+        workers[ w ].first = config.games * w / config.threads;
+        workers[ w ].count = config.games * ( w + 1 ) / config.threads - workers[ w ].first;
+        workers[ w ].tick_ms = config.tick_ms;
+        workers[ w ].thread = SDL_CreateThread( workerThread, "spectated", &workers[ w ] );
+        if( workers[ w ].thread == NULL )
+        {
+            // The games of a missing worker would stay frozen, so do not show any.
+            printf( "Could not start worker %d. SDL_Error: %s\n", w, SDL_GetError() );
+            result = RESULT_ERROR;
+            break;
+        }
+    }
+
+    if( result == RESULT_SUCCESS )
+    {
+        renderLoop( &config, renderer, games );
+    }
+
+    SDL_AtomicSet( &WorkersQuit, 1 );
+    for( int w = 0; w < config.threads; w++ )
+    {
+        SDL_WaitThread( workers[ w ].thread, NULL );
+    }
+    for( int g = 0; g < config.games; g++ )
+    {
+        freeGameState( &games[ g ].game );
+    }
+    free( workers );
+    free( games );
+    SDL_DestroyRenderer( renderer );
+    SDL_DestroyWindow( window );
+    SDL_Quit();
+    return result;
+}
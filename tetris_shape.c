@@ -5,6 +5,66 @@
 #include "tetris_shape.h"
 #include "matrix.h"
 
+// The coordinate macros are written around the origin i, j. Expanding them with both at
+// 0 gives the offset of every cell from the pivot point, per shape and rotation, as a
+// flat list of x, y pairs.
+#define i 0
+#define j 0
+static const int SHAPE_CELL_OFFSETS[ 7 ][ 4 ][ 8 ] = {
+    [ TETRIS_SHAPE_SQUARE ] = {
+        { COORDS_SHAPE_SQUARE_ROT_0 },
+        { COORDS_SHAPE_SQUARE_ROT_0 },
+        { COORDS_SHAPE_SQUARE_ROT_0 },
+        { COORDS_SHAPE_SQUARE_ROT_0 } },
+    [ TETRIS_SHAPE_LONG ] = {
+        { COORDS_SHAPE_LONG_ROT_0 },
+        { COORDS_SHAPE_LONG_ROT_90 },
+        { COORDS_SHAPE_LONG_ROT_0 },
+        { COORDS_SHAPE_LONG_ROT_90 } },
+    [ TETRIS_SHAPE_T ] = {
+        { COORDS_SHAPE_T_ROT_0 },
+        { COORDS_SHAPE_T_ROT_90 },
+        { COORDS_SHAPE_T_ROT_180 },
+        { COORDS_SHAPE_T_ROT_270 } },
+    [ TETRIS_SHAPE_Z ] = {
+        { COORDS_SHAPE_Z_ROT_0 },
+        { COORDS_SHAPE_Z_ROT_90 },
+        { COORDS_SHAPE_Z_ROT_180 },
+        { COORDS_SHAPE_Z_ROT_270 } },
+    [ TETRIS_SHAPE_S ] = {
+        { COORDS_SHAPE_S_ROT_0 },
+        { COORDS_SHAPE_S_ROT_90 },
+        { COORDS_SHAPE_S_ROT_180 },
+        { COORDS_SHAPE_S_ROT_270 } },
+    [ TETRIS_SHAPE_L ] = {
+        { COORDS_SHAPE_L_ROT_0 },
+        { COORDS_SHAPE_L_ROT_90 },
+        { COORDS_SHAPE_L_ROT_180 },
+        { COORDS_SHAPE_L_ROT_270 } },
+    [ TETRIS_SHAPE_J ] = {
+        { COORDS_SHAPE_J_ROT_0 },
+        { COORDS_SHAPE_J_ROT_90 },
+        { COORDS_SHAPE_J_ROT_180 },
+        { COORDS_SHAPE_J_ROT_270 } },
+};
+#undef i
+#undef j
+
+/*
+ * Write the board coordinates of a tetris shape with origin at i, j at a given rotation
+ * to cells, one x, y pair per cell. Does not allocate, so the game rules can call it on
+ * every move.
+ */
+void
+getShapeCells( TETRIS_SHAPE tetris_shape, int i, int j, TETRIS_ROT tetris_rot, int cells[ 4 ][ 2 ] )
+{
+    for( int cell = 0; cell < 4; cell++ )
+    {
+        cells[ cell ][ 0 ] = i + SHAPE_CELL_OFFSETS[ tetris_shape ][ tetris_rot ][ 2 * cell ];
+        cells[ cell ][ 1 ] = j + SHAPE_CELL_OFFSETS[ tetris_shape ][ tetris_rot ][ 2 * cell + 1 ];
+    }
+}
+
 /*
  * Get the board coordinates of a tetris shape with origin at i, j at a given rotation.
  */
@@ -12,117 +72,6 @@ inline Matrix*
 getLocalShapeCells( TETRIS_SHAPE tetris_shape, int i, int j, TETRIS_ROT tetris_rot )
 {
     Matrix* m = matrixMake( 4, 2 );
-
-    if( tetris_shape == TETRIS_SHAPE_L && tetris_rot == TETRIS_ROT_0 )
-    {
-        matrixSets( m, COORDS_SHAPE_L_ROT_0 );
-    }
-
-    if( tetris_shape == TETRIS_SHAPE_L && tetris_rot == TETRIS_ROT_90 )
-    {
-        matrixSets( m, COORDS_SHAPE_L_ROT_90 );
-    }
-
-    if( tetris_shape == TETRIS_SHAPE_L && tetris_rot == TETRIS_ROT_180 )
-    {
-        matrixSets( m, COORDS_SHAPE_L_ROT_180 );
-    }
-
-    if( tetris_shape == TETRIS_SHAPE_L && tetris_rot == TETRIS_ROT_270 )
-    {
-        matrixSets( m, COORDS_SHAPE_L_ROT_270 );
-    }
-
-
-    if( tetris_shape == TETRIS_SHAPE_J && tetris_rot == TETRIS_ROT_0 )
-    {
-        matrixSets( m, COORDS_SHAPE_J_ROT_0);
-    }
-    if( tetris_shape == TETRIS_SHAPE_J && tetris_rot == TETRIS_ROT_90 )
-    {
-        matrixSets( m, COORDS_SHAPE_J_ROT_90);
-    }
-    if( tetris_shape == TETRIS_SHAPE_J && tetris_rot == TETRIS_ROT_180 )
-    {
-        matrixSets( m, COORDS_SHAPE_J_ROT_180);
-    }
-    if( tetris_shape == TETRIS_SHAPE_J && tetris_rot == TETRIS_ROT_270 )
-    {
-        matrixSets( m, COORDS_SHAPE_J_ROT_270);
-    }
-
-    if( tetris_shape == TETRIS_SHAPE_SQUARE )
-    {
-        matrixSets( m, COORDS_SHAPE_SQUARE_ROT_0 );
-    }
-
-    if( tetris_shape == TETRIS_SHAPE_S && tetris_rot == TETRIS_ROT_0  )
-    {
-        matrixSets( m, COORDS_SHAPE_S_ROT_0 );
-    }
-    if( tetris_shape == TETRIS_SHAPE_S && tetris_rot == TETRIS_ROT_90  )
-    {
-        matrixSets( m, COORDS_SHAPE_S_ROT_90 );
-    }
-    if( tetris_shape == TETRIS_SHAPE_S && tetris_rot == TETRIS_ROT_180  )
-    {
-        matrixSets( m, COORDS_SHAPE_S_ROT_180 );
-    }
-    if( tetris_shape == TETRIS_SHAPE_S && tetris_rot == TETRIS_ROT_270  )
-    {
-        matrixSets( m, COORDS_SHAPE_S_ROT_270 );
-    }
-
-    if( tetris_shape == TETRIS_SHAPE_Z && tetris_rot == TETRIS_ROT_0   )
-    {
-        matrixSets( m, COORDS_SHAPE_Z_ROT_0 );
-    }
-    if( tetris_shape == TETRIS_SHAPE_Z && tetris_rot == TETRIS_ROT_90   )
-    {
-        matrixSets( m, COORDS_SHAPE_Z_ROT_90 );
-    }
-    if( tetris_shape == TETRIS_SHAPE_Z && tetris_rot == TETRIS_ROT_180   )
-    {
-        matrixSets( m, COORDS_SHAPE_Z_ROT_180 );
-    }
-    if( tetris_shape == TETRIS_SHAPE_Z && tetris_rot == TETRIS_ROT_270   )
-    {
-        matrixSets( m, COORDS_SHAPE_Z_ROT_270 );
-    }
-
-    if( tetris_shape == TETRIS_SHAPE_LONG && tetris_rot == TETRIS_ROT_0 )
-    {
-        matrixSets( m, COORDS_SHAPE_LONG_ROT_0 );
-    }
-    if( tetris_shape == TETRIS_SHAPE_LONG && tetris_rot == TETRIS_ROT_90 )
-    {
-        matrixSets( m, COORDS_SHAPE_LONG_ROT_90 );
-    }
-    if( tetris_shape == TETRIS_SHAPE_LONG && tetris_rot == TETRIS_ROT_180 )
-    {
-        matrixSets( m, COORDS_SHAPE_LONG_ROT_0 );
-    }
-    if( tetris_shape == TETRIS_SHAPE_LONG && tetris_rot == TETRIS_ROT_270 )
-    {
-        matrixSets( m, COORDS_SHAPE_LONG_ROT_90 );
-    }
-
-    if( tetris_shape == TETRIS_SHAPE_T && tetris_rot == TETRIS_ROT_0 )
-    {
-        matrixSets( m, COORDS_SHAPE_T_ROT_0 );
-    }
-    if( tetris_shape == TETRIS_SHAPE_T && tetris_rot == TETRIS_ROT_90 )
-    {
-        matrixSets( m, COORDS_SHAPE_T_ROT_90 );
-    }
-    if( tetris_shape == TETRIS_SHAPE_T && tetris_rot == TETRIS_ROT_180 )
-    {
-        matrixSets( m, COORDS_SHAPE_T_ROT_180 );
-    }
-    if( tetris_shape == TETRIS_SHAPE_T && tetris_rot == TETRIS_ROT_270 )
-    {
-        matrixSets( m, COORDS_SHAPE_T_ROT_270 );
-    }
-
+    getShapeCells( tetris_shape, i, j, tetris_rot, (int (*)[ 2 ]) m->content );
     return m;
-}
\ No newline at end of file
+}
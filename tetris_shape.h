@@ -31,6 +31,7 @@ typedef int TETRIS_ROT;
 ** Method prototype
 **************************************************************************/
 Matrix* getLocalShapeCells( TETRIS_SHAPE tetris_shape, int i, int j, TETRIS_ROT tetris_rot );
+void    getShapeCells( TETRIS_SHAPE tetris_shape, int i, int j, TETRIS_ROT tetris_rot, int cells[ 4 ][ 2 ] );
 
 /**************************************************************************
 ** Tetris shape coordinates
@@ -0,0 +1,217 @@
+#include "trace.h"
+
+#include <stdio.h>
+#include <SDL.h>
+
+/**************************************************************************
+** Config
+**************************************************************************/
+#define TRACE_RING_SIZE         8192    /**< Events per thread, must be a power of 2 */
+#define TRACE_FLUSH_MS          50      /**< How often the writer thread drains the rings */
+
+/**************************************************************************
+** Structs
+**************************************************************************/
+
+typedef struct TraceEvent
+{
+    const char*     name;               /**< Must be a string literal (or outlive the trace) */
+    Uint64          counter;            /**< SDL_GetPerformanceCounter at the event */
+    char            phase;              /**< 'B' or 'E' */
+} TraceEvent;
+
+/**
+ * Single-producer/single-consumer ring. The owning thread only writes head, the writer
+ * thread only writes tail. Rings are created on a thread's first event and live until
+ * the process exits, so they can be reused by the next trace.
+ */
+typedef struct TraceRing
+{
+    TraceEvent          events[ TRACE_RING_SIZE ];
+    SDL_atomic_t        head;
+    SDL_atomic_t        tail;
+    SDL_atomic_t        dropped;        /**< Events lost because the ring was full */
+    SDL_threadID        thread_id;
+    struct TraceRing*   next;
+} TraceRing;
+
+/**************************************************************************
+** Global variables
+**************************************************************************/
+bool TraceEnabled = false;
+
+static _Thread_local TraceRing* LocalRing;
+static void*        Rings;              /**< Linked list of all TraceRings, pushed with a CAS */
+static SDL_Thread*  Writer;
+static SDL_atomic_t WriterQuit;
+static FILE*        TraceFile;
+static Uint64       TraceStartCounter;
+static bool         FirstEvent;
+
+/**************************************************************************
+** Recording
+**************************************************************************/
+
+static TraceRing*
+createRing()
+{
+    TraceRing* ring = SDL_calloc( 1, sizeof( TraceRing ) );
+    if( ring == NULL )
+    {
+        return NULL;
+    }
+    ring->thread_id = SDL_ThreadID();
+
+    void* head;
+    do
+    {
+        head = SDL_AtomicGetPtr( &Rings );
+        ring->next = head;
+    } while( !SDL_AtomicCASPtr( &Rings, head, ring ) );
+
+    return ring;
+}
+
+/*
+ * Record an event on the calling thread's ring. Use TRACE_BEGIN/TRACE_END instead,
+ * they skip the call while tracing is off.
+ */
+void
+traceEvent( const char* name, char phase )
+{
+    TraceRing* ring = LocalRing;
+    if( ring == NULL )
+    {
+        ring = LocalRing = createRing();
+        if( ring == NULL )
+        {
+            return;
+        }
+    }
+
+    const int head = SDL_AtomicGet( &ring->head );
+    if( head - SDL_AtomicGet( &ring->tail ) >= TRACE_RING_SIZE )
+    {
+        SDL_AtomicAdd( &ring->dropped, 1 );
+        return;
+    }
+
+    TraceEvent* event = &ring->events[ head & ( TRACE_RING_SIZE - 1 ) ];
+    event->name = name;
+    event->counter = SDL_GetPerformanceCounter();
+    event->phase = phase;
+
+    // Publish the event only after it is fully written.
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet( &ring->head, head + 1 );
+}
+
+/**************************************************************************
+** Writing
+**************************************************************************/
+
+static void
+drainRings()
+{
+    const double us_per_count = 1000000.0 / (double) SDL_GetPerformanceFrequency();
+
+    for( TraceRing* ring = SDL_AtomicGetPtr( &Rings ); ring != NULL; ring = ring->next )
+    {
+        const int head = SDL_AtomicGet( &ring->head );
+        int tail = SDL_AtomicGet( &ring->tail );
+        SDL_MemoryBarrierAcquire();
+
+        for( ; tail != head; tail++ )
+        {
+            const TraceEvent* event = &ring->events[ tail & ( TRACE_RING_SIZE - 1 ) ];
+            fprintf( TraceFile, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%lu}",
+                     FirstEvent ? "\n" : ",\n",
+                     event->name,
+                     event->phase,
+                     (double) ( event->counter - TraceStartCounter ) * us_per_count,
+                     ring->thread_id );
+            FirstEvent = false;
+        }
+
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet( &ring->tail, tail );
+    }
+}
+
+static int
+writerThread( void* data )
+{
+    (void) data;
+    while( !SDL_AtomicGet( &WriterQuit ) )
+    {
+        SDL_Delay( TRACE_FLUSH_MS );
+        drainRings();
+    }
+    return 0;
+}
+
+/*
+ * Start writing a trace to path. Returns false when the file cannot be created.
+ */
+bool
+traceStart( const char* path )
+{
+    if( TraceEnabled )
+    {
+        return true;
+    }
+
+    TraceFile = fopen( path, "w" );
+    if( TraceFile == NULL )
+    {
+        printf( "Could not open trace file %s\n", path );
+        return false;
+    }
+    fprintf( TraceFile, "[" );
+    FirstEvent = true;
+    TraceStartCounter = SDL_GetPerformanceCounter();
+
+    // Drop whatever an earlier trace left behind.
+    for( TraceRing* ring = SDL_AtomicGetPtr( &Rings ); ring != NULL; ring = ring->next )
+    {
+        SDL_AtomicSet( &ring->tail, SDL_AtomicGet( &ring->head ) );
+        SDL_AtomicSet( &ring->dropped, 0 );
+    }
+
+    SDL_AtomicSet( &WriterQuit, 0 );
+    Writer = SDL_CreateThread( writerThread, "trace", NULL );
+    TraceEnabled = true;
+    return true;
+}
+
+/*
+ * Stop tracing, write the remaining events and close the file. Events recorded by
+ * other threads while this runs may be cut off.
+ */
+void
+traceStop()
+{
+    if( !TraceEnabled )
+    {
+        return;
+    }
+    TraceEnabled = false;
+
+    SDL_AtomicSet( &WriterQuit, 1 );
+    SDL_WaitThread( Writer, NULL );
+    drainRings();
+
+    int dropped = 0;
+    for( TraceRing* ring = SDL_AtomicGetPtr( &Rings ); ring != NULL; ring = ring->next )
+    {
+        dropped += SDL_AtomicGet( &ring->dropped );
+    }
+    if( dropped > 0 )
+    {
+        printf( "Trace dropped %d events, the writer could not keep up\n", dropped );
+    }
+
+    fprintf( TraceFile, "\n]\n" );
+    fclose( TraceFile );
+    TraceFile = NULL;
+}
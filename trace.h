@@ -0,0 +1,29 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+
+/**************************************************************************
+** Chrome/Perfetto trace export. Begin/end events go into a lock-free ring
+** per thread and a background thread writes them out as trace JSON, which
+** loads in chrome://tracing and ui.perfetto.dev.
+**
+** While tracing is off a TRACE_BEGIN/TRACE_END costs one branch on
+** TraceEnabled.
+**************************************************************************/
+
+extern bool TraceEnabled;
+
+#define TRACE_BEGIN( name )     do { if( TraceEnabled ) traceEvent( name, 'B' ); } while( 0 )
+#define TRACE_END( name )       do { if( TraceEnabled ) traceEvent( name, 'E' ); } while( 0 )
+
+bool
+traceStart( const char* path );
+
+void
+traceStop();
+
+void
+traceEvent( const char* name, char phase );
+
+#endif //TRACE_H
@@ -0,0 +1,435 @@
+//
+// Genetic tuner for the bot weights. Plays full games without a window on a fixed
+// set of seeds, so every candidate is scored on exactly the same shape sequences.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+#include "bot.h"
+#include "game.h"
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/**************************************************************************
+** Config
+**************************************************************************/
+#define DEFAULT_POPULATION      32
+#define DEFAULT_GENERATIONS     50
+#define DEFAULT_SEEDS           8
+#define DEFAULT_MAX_PIECES      5000
+#define DEFAULT_CHECKPOINT      "tuner_checkpoint.txt"
+#define ELITE_COUNT             2
+#define TOURNAMENT_SIZE         3
+#define MUTATION_RATE           0.3f
+#define MUTATION_SIGMA          0.2f
+#define SEED_BASE               1000u
+
+/**************************************************************************
+** Structs
+**************************************************************************/
+
+typedef struct TunerConfig
+{
+    int             population;         /**< Candidates per generation */
+    int             generations;        /**< Generation to stop after */
+    int             seeds;              /**< Games per candidate, one per fixed seed */
+    int             max_pieces;         /**< Games are cut off after this many pieces */
+    int             threads;            /**< Worker threads playing games */
+    const char*     checkpoint;         /**< File the population is saved to after each generation */
+} TunerConfig;
+
+typedef struct Candidate
+{
+    float           weights[ BOT_WEIGHT_COUNT ];
+    double          fitness;            /**< Mean score over all seeds */
+} Candidate;
+
+typedef struct Evaluation
+{
+    const TunerConfig*  config;
+    Candidate*          candidates;
+    int*                scores;         /**< Score per game, population * seeds entries */
+    SDL_atomic_t        next_game;      /**< Next game a worker should pick up */
+} Evaluation;
+
+static uint32_t RngState = 0x2545F491u;
+
+/**************************************************************************
+** Helpers
+**************************************************************************/
+
+static float
+randomUniform()
+{
+    RngState ^= RngState << 13;
+    RngState ^= RngState >> 17;
+    RngState ^= RngState << 5;
+    return (float) ( RngState >> 8 ) / (float) ( 1u << 24 );
+}
+
+static float
+randomGaussian()
+{
+    const float u = randomUniform() + 1e-7f;
+    const float v = randomUniform();
+    return sqrtf( -2.0f * logf( u ) ) * cosf( 6.2831853f * v );
+}
+
+// Weights only matter relative to each other, so candidates are kept at unit length.
+static void
+normalize( float* weights )
+{
+    float length = 0;
+    for( int i = 0; i < BOT_WEIGHT_COUNT; i++ )
+    {
+        length += weights[ i ] * weights[ i ];
+    }
+    length = sqrtf( length );
+    if( length <= 0 )
+    {
+        return;
+    }
+    for( int i = 0; i < BOT_WEIGHT_COUNT; i++ )
+    {
+        weights[ i ] /= length;
+    }
+}
+
+static int
+compareFitness( const void* a, const void* b )
+{
+    const double fa = ( (const Candidate*) a )->fitness;
+    const double fb = ( (const Candidate*) b )->fitness;
+    return ( fa < fb ) - ( fa > fb );
+}
+
+/**************************************************************************
+** Evaluation
+**************************************************************************/
+
+// Play one game with the bot and return its score.
+static int
+playGame( const Candidate* candidate, uint32_t seed, int max_pieces )
+{
+    GameState   game_state;
+    BotWeights  weights;
+    BotMove     move;
+
+    botWeightsFromArray( candidate->weights, &weights );
+    initGameState( &game_state, seed );
+
+    for( int piece = 0; piece < max_pieces && !game_state.game_over; piece++ )
+    {
+        if( !botFindMove( &game_state, &weights, &move ) )
+        {
+            break;
+        }
+        botApplyMove( &game_state, &move );
+    }
+
+    const int score = game_state.score;
+    freeGameState( &game_state );
+    return score;
+}
+
+static int
+evaluationWorker( void* data )
+{
+    Evaluation* evaluation = data;
+    const TunerConfig* config = evaluation->config;
+    const int total = config->population * config->seeds;
+
+    for( ;; )
+    {
+        const int game = SDL_AtomicAdd( &evaluation->next_game, 1 );
+        if( game >= total )
+        {
+            break;
+        }
+
+        const Candidate* candidate = &evaluation->candidates[ game / config->seeds ];
+        evaluation->scores[ game ] = playGame( candidate, SEED_BASE + game % config->seeds, config->max_pieces );
+    }
+
+    return 0;
+}
+
+// Score every candidate in parallel. Games are handed out one by one, so slow
+// (good) candidates do not leave threads idle.
+static void
+evaluatePopulation( const TunerConfig* config, Candidate* candidates )
+{
+    Evaluation evaluation;
+    SDL_Thread** threads = malloc( sizeof( SDL_Thread* ) * config->threads );
+
+    evaluation.config = config;
+    evaluation.candidates = candidates;
+    evaluation.scores = malloc( sizeof( int ) * config->population * config->seeds );
+    SDL_AtomicSet( &evaluation.next_game, 0 );
+
+    int started = 0;
+    for( int i = 0; i < config->threads; i++ )
+    {
+        threads[ i ] = SDL_CreateThread( evaluationWorker, "tuner", &evaluation );
+        started += threads[ i ] != NULL;
+    }
+    if( started < config->threads )
+    {
+        // Games are handed out from a shared counter, so whatever the missing threads
+        // would have played is picked up here and every score still gets written.
+        printf( "Could only start %d of %d threads. SDL_Error: %s\n", started, config->threads, SDL_GetError() );
+        evaluationWorker( &evaluation );
+    }
+    for( int i = 0; i < config->threads; i++ )
+    {
+        SDL_WaitThread( threads[ i ], NULL );
+    }
+
+    for( int c = 0; c < config->population; c++ )
+    {
+        double total = 0;
+        for( int s = 0; s < config->seeds; s++ )
+        {
+            total += evaluation.scores[ c * config->seeds + s ];
+        }
+        candidates[ c ].fitness = total / config->seeds;
+    }
+
+    free( evaluation.scores );
+    free( threads );
+}
+
+/**************************************************************************
+** Genetic operators
+**************************************************************************/
+
+static const Candidate*
+tournament( const Candidate* candidates, int population )
+{
+    const Candidate* best = &candidates[ (int) ( randomUniform() * population ) ];
+    for( int i = 1; i < TOURNAMENT_SIZE; i++ )
+    {
+        const Candidate* other = &candidates[ (int) ( randomUniform() * population ) ];
+        if( other->fitness > best->fitness )
+        {
+            best = other;
+        }
+    }
+    return best;
+}
+
+// Build the next generation from a population sorted by fitness. The best candidates
+// survive unchanged, the rest are fitness-weighted blends of two parents plus mutation.
+static void
+breed( const Candidate* parents, Candidate* children, int population )
+{
+    for( int c = 0; c < population; c++ )
+    {
+        if( c < ELITE_COUNT )
+        {
+            children[ c ] = parents[ c ];
+            continue;
+        }
+
+        const Candidate* a = tournament( parents, population );
+        const Candidate* b = tournament( parents, population );
+        const double sum = a->fitness + b->fitness;
+        const float mix = sum > 0 ? (float) ( a->fitness / sum ) : 0.5f;
+
+        for( int i = 0; i < BOT_WEIGHT_COUNT; i++ )
+        {
+            children[ c ].weights[ i ] = mix * a->weights[ i ] + ( 1 - mix ) * b->weights[ i ];
+            if( randomUniform() < MUTATION_RATE )
+            {
+                children[ c ].weights[ i ] += randomGaussian() * MUTATION_SIGMA;
+            }
+        }
+        normalize( children[ c ].weights );
+        children[ c ].fitness = 0;
+    }
+}
+
+/**************************************************************************
+** Checkpoints
+**************************************************************************/
+
+// Write to a temporary file first, so a crash while saving never loses the previous checkpoint.
+static bool
+saveCheckpoint( const TunerConfig* config, const Candidate* candidates, int generation )
+{
+    char tmp_path[ 1024 ];
+    snprintf( tmp_path, sizeof( tmp_path ), "%s.tmp", config->checkpoint );
+
+    FILE* file = fopen( tmp_path, "w" );
+    if( file == NULL )
+    {
+        printf( "Could not write checkpoint %s\n", tmp_path );
+        return false;
+    }
+
+    fprintf( file, "generation %d\npopulation %d\nrng %u\n", generation, config->population, RngState );
+    for( int c = 0; c < config->population; c++ )
+    {
+        for( int i = 0; i < BOT_WEIGHT_COUNT; i++ )
+        {
+            fprintf( file, "%.9g ", candidates[ c ].weights[ i ] );
+        }
+        fprintf( file, "%.9g\n", candidates[ c ].fitness );
+    }
+    fclose( file );
+
+    // Replace the old checkpoint in one step, there is never a moment without one.
+#ifdef _WIN32
+    return MoveFileExA( tmp_path, config->checkpoint, MOVEFILE_REPLACE_EXISTING ) != 0;
+#else
+    return rename( tmp_path, config->checkpoint ) == 0;
+#endif
+}
+
+// Returns the generation to continue from, or -1 when there is no usable checkpoint.
+static int
+loadCheckpoint( const TunerConfig* config, Candidate* candidates )
+{
+    int generation;
+    int population;
+    FILE* file = fopen( config->checkpoint, "r" );
+    if( file == NULL )
+    {
+        return -1;
+    }
+
+    if( fscanf( file, "generation %d population %d rng %u", &generation, &population, &RngState ) != 3 ||
+        population != config->population )
+    {
+        printf( "Ignoring checkpoint %s (different population size)\n", config->checkpoint );
+        fclose( file );
+        return -1;
+    }
+
+    for( int c = 0; c < population; c++ )
+    {
+        for( int i = 0; i < BOT_WEIGHT_COUNT; i++ )
+        {
+            if( fscanf( file, "%f", &candidates[ c ].weights[ i ] ) != 1 )
+            {
+                fclose( file );
+                return -1;
+            }
+        }
+        if( fscanf( file, "%lf", &candidates[ c ].fitness ) != 1 )
+        {
+            fclose( file );
+            return -1;
+        }
+    }
+
+    fclose( file );
+    return generation;
+}
+
+/**************************************************************************
+** Main
+**************************************************************************/
+
+static void
+printUsage( const char* name )
+{
+    printf( "Usage: %s [-p population] [-g generations] [-s seeds] [-m max_pieces] [-t threads] [-c checkpoint]\n",
+            name );
+}
+
+int
+main( int argc, char** argv )
+{
+    TunerConfig config = {
+        DEFAULT_POPULATION,
+        DEFAULT_GENERATIONS,
+        DEFAULT_SEEDS,
+        DEFAULT_MAX_PIECES,
+        SDL_GetCPUCount(),
+        DEFAULT_CHECKPOINT
+    };
+
+    for( int i = 1; i < argc; i++ )
+    {
+        if( i + 1 >= argc )                     { printUsage( argv[ 0 ] ); return RESULT_ERROR; }
+        else if( strcmp( argv[ i ], "-p" ) == 0 )   config.population = atoi( argv[ ++i ] );
+        else if( strcmp( argv[ i ], "-g" ) == 0 )   config.generations = atoi( argv[ ++i ] );
+        else if( strcmp( argv[ i ], "-s" ) == 0 )   config.seeds = atoi( argv[ ++i ] );
+        else if( strcmp( argv[ i ], "-m" ) == 0 )   config.max_pieces = atoi( argv[ ++i ] );
+        else if( strcmp( argv[ i ], "-t" ) == 0 )   config.threads = atoi( argv[ ++i ] );
+        else if( strcmp( argv[ i ], "-c" ) == 0 )   config.checkpoint = argv[ ++i ];
+        else                                    { printUsage( argv[ 0 ] ); return RESULT_ERROR; }
+    }
+
+    if( config.population <= ELITE_COUNT || config.seeds < 1 || config.threads < 1 )
+    {
+        printUsage( argv[ 0 ] );
+        return RESULT_ERROR;
+    }
+
+    botInit();
+
+    Candidate* population = malloc( sizeof( Candidate ) * config.population );
+    Candidate* next = malloc( sizeof( Candidate ) * config.population );
+
+    int generation = loadCheckpoint( &config, population );
+    if( generation >= 0 )
+    {
+        printf( "Resuming from %s at generation %d\n", config.checkpoint, generation );
+        breed( population, next, config.population );
+        SDL_memcpy( population, next, sizeof( Candidate ) * config.population );
+    } else
+    {
+        generation = 0;
+        for( int c = 0; c < config.population; c++ )
+        {
+            for( int i = 0; i < BOT_WEIGHT_COUNT; i++ )
+            {
+                population[ c ].weights[ i ] = randomUniform() * 2 - 1;
+            }
+            normalize( population[ c ].weights );
+        }
+    }
+
+    printf( "Tuning with %d threads, population %d, %d seeds, eval kernel %s\n",
+            config.threads, config.population, config.seeds, evalBoardsKernelName() );
+
+    for( ; generation < config.generations; generation++ )
+    {
+        const Uint64 start = SDL_GetPerformanceCounter();
+        evaluatePopulation( &config, population );
+        const double seconds = (double) ( SDL_GetPerformanceCounter() - start ) / SDL_GetPerformanceFrequency();
+
+        qsort( population, config.population, sizeof( Candidate ), compareFitness );
+
+        const double games_per_sec = config.population * config.seeds / seconds;
+        printf( "Generation %d: best %.1f, median %.1f, %.1f games/s (%.2f games/s per core)\n",
+                generation,
+                population[ 0 ].fitness,
+                population[ config.population / 2 ].fitness,
+                games_per_sec,
+                games_per_sec / config.threads );
+        printf( "  weights:" );
+        for( int i = 0; i < BOT_WEIGHT_COUNT; i++ )
+        {
+            printf( " %.4f", population[ 0 ].weights[ i ] );
+        }
+        printf( "\n" );
+
+        saveCheckpoint( &config, population, generation + 1 );
+
+        breed( population, next, config.population );
+        Candidate* swap = population;
+        population = next;
+        next = swap;
+    }
+
+    free( population );
+    free( next );
+    return RESULT_SUCCESS;
+}